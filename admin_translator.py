@@ -1,5 +1,8 @@
+import re
 import serial
+import struct
 import time
+from datetime import datetime, timezone
 from deep_translator import GoogleTranslator
 
 # --- CONFIGURATION ---
@@ -7,6 +10,67 @@ from deep_translator import GoogleTranslator
 SERIAL_PORT = 'COM13' 
 BAUD_RATE = 9600
 
+# --- BINARY LOG FRAMES (ADMIN_LOG_BINARY_FRAMES = 1 on the Admin) ---
+# [0x7E][node << 4 | origin][epoch u32 LE][len][text x len][xor of origin..text]
+FRAME_START = 0x7E
+ORIGINS = {0: "SYSTEM", 1: "SPY", 2: "ADMIN", 3: "ERROR"}
+NODE_TAG = re.compile(r"\[N(\d+)\] ")
+
+def read_frame(ser):
+    """Reads the rest of a binary frame after its start byte.
+    Returns (origin, node, timestamp, text) or None if it was corrupt."""
+    header = ser.read(6)
+    if len(header) < 6:
+        return None
+    tag, epoch, length = struct.unpack("<BIB", header)
+    origin, node = tag & 0x0F, tag >> 4
+    body = ser.read(length + 1)
+    if len(body) < length + 1:
+        return None
+
+    checksum = 0
+    for b in header + body[:-1]:
+        checksum ^= b
+    if checksum != body[-1]:
+        return None
+
+    # The RTC keeps local wall time, so format as UTC to get it back unchanged
+    stamp = datetime.fromtimestamp(epoch, timezone.utc).strftime("%Y-%m-%d %H:%M:%S")
+    text = body[:-1].decode('ascii', errors='ignore')
+    return ORIGINS.get(origin, "SYSTEM"), node, stamp, text
+
+def read_record(ser, pending):
+    """Returns (origin, node, line, message) for the next log record, text or
+    binary; node is the spy's radio node ID, or 0 if the record has none.
+    pending is a bytearray holding a partial text line between calls."""
+    while ser.in_waiting > 0:
+        byte = ser.read(1)[0]
+
+        if byte == FRAME_START and not pending:
+            frame = read_frame(ser)
+            if frame is None:
+                print("[LOG] Dropped corrupt binary frame")
+                continue
+            origin, node, stamp, text = frame
+            node_tag = f"[N{node}] " if node else ""
+            return origin, node, f"[{stamp}] {node_tag}[{origin}] > {text}", text
+
+        if byte in (0x0A, 0x0D):
+            if pending:
+                line = pending.decode('utf-8', errors='ignore').strip()
+                pending.clear()
+                # Text form: "[timestamp] [N3] [ORIGIN] > message" (node optional)
+                match = NODE_TAG.search(line)
+                node = int(match.group(1)) if match else 0
+                for origin in ORIGINS.values():
+                    tag = f"[{origin}] >"
+                    if tag in line:
+                        return origin, node, line, line.split(tag, 1)[1].strip()
+                return None, 0, line, None
+        else:
+            pending.append(byte)
+    return None
+
 def start_translator():
     # Initialize Translators
     translator_hi = GoogleTranslator(source='auto', target='hi') # Hindi
@@ -21,34 +85,38 @@ def start_translator():
         print("(Press Ctrl+C to Exit)")
         print("-" * 50)
 
+        pending = bytearray()
         while True:
-            # 1. Read line from Arduino
-            if ser.in_waiting > 0:
-                line = ser.readline().decode('utf-8', errors='ignore').strip()
-                
-                # 2. Filter for actual messages
-                if "[SPY] >" in line:
-                    parts = line.split(">")
-                    if len(parts) > 1:
-                        english_msg = parts[1].strip()
+            # 1. Read a record (text line or binary frame) from Arduino
+            record = read_record(ser, pending)
+            if record is None:
+                time.sleep(0.01)
+                continue
+            origin, node, line, message = record
+
+            # 2. Filter for actual messages
+            if origin == "SPY":
+                if message:
+                    english_msg = message
+                    
+                    # 3. Translate
+                    try:
+                        hindi_msg = translator_hi.translate(english_msg)
+                        marathi_msg = translator_mr.translate(english_msg)
+                        
+                        # 4. Display Result
+                        sender = f" (SPY {node})" if node else ""
+                        print(f"\nINCOMING MSG{sender}: {english_msg}")
+                        print(f"HINDI:   {hindi_msg}")
+                        print(f"MARATHI: {marathi_msg}")
+                        print("-" * 50)
                         
-                        # 3. Translate
-                        try:
-                            hindi_msg = translator_hi.translate(english_msg)
-                            marathi_msg = translator_mr.translate(english_msg)
-                            
-                            # 4. Display Result
-                            print(f"\nINCOMING MSG: {english_msg}")
-                            print(f"HINDI:   {hindi_msg}")
-                            print(f"MARATHI: {marathi_msg}")
-                            print("-" * 50)
-                            
-                        except Exception as e:
-                            print(f"Translation Error: {e}")
-                
-                # Optional: Print other logs
-                elif "[ADMIN]" in line or "[SYSTEM]" in line:
-                    print(f"[LOG] {line}")
+                    except Exception as e:
+                        print(f"Translation Error: {e}")
+            
+            # Optional: Print other logs
+            elif origin in ("ADMIN", "SYSTEM", "ERROR"):
+                print(f"[LOG] {line}")
 
     except serial.SerialException:
         print(f"ERROR: Could not open port {SERIAL_PORT}. Is the Arduino connected?")
@@ -1,43 +1,99 @@
 #include "BluetoothInterface.h"
 
-BluetoothInterface::BluetoothInterface(uint8_t rxPin, uint8_t txPin)
-    : btSerial(rxPin, txPin), messageReady(false) {}
+BluetoothInterface::BluetoothInterface(SerialBackend& serialBackend)
+    : backend(serialBackend) {}
 
 void BluetoothInterface::begin(long baudRate) {
-    btSerial.begin(baudRate);
+    backend.begin(baudRate);
     delay(500);
 }
 
-void BluetoothInterface::sendMessage(const String& message) {
-    btSerial.println(message);
+void BluetoothInterface::sendMessage(const char* message) {
+    backend.println(message);
 }
 
-void BluetoothInterface::checkForIncoming() {
-    while (btSerial.available() > 0) {
-        char c = btSerial.read();
-
-        if (c == '\n' || c == '\r') {
-            if (incomingBuffer.length() > 0) {
-                messageReady = true;
-            }
-        } else {
-            incomingBuffer += c;
+void BluetoothInterface::sendMessage(const __FlashStringHelper* message) {
+    backend.println(message);
+}
+
+void BluetoothInterface::sendBytes(const uint8_t* data, size_t length) {
+    backend.write(data, length);
+}
+
+// --- Line Parser (fed one byte at a time) ---
+// Bytes go straight into the pool, behind the complete lines
+void BluetoothInterface::parseByte(char c) {
+    if (c == '\n' || c == '\r') {
+        if (incomingDropped) droppedLines++;
+        else if (incomingLength > 0) queueLine();
+        incomingLength = 0;
+        incomingTruncated = false;
+        incomingDropped = false;
+    } else if (incomingDropped) {
+        // Already lost; the rest of it goes too
+    } else if (incomingLength == BT_MAX_LINE) {
+        if (!incomingTruncated) {
+            incomingTruncated = true; // Count each over-long line once
+            truncatedLines++;
         }
+    } else if (queuedBytes + incomingLength + 2 > BT_LINE_POOL_SIZE) {
+        incomingDropped = true; // No room for it and its terminator: keep the older lines
+    } else {
+        linePool[queuedBytes + incomingLength++] = c;
+    }
+}
+
+void BluetoothInterface::queueLine() {
+    linePool[queuedBytes + incomingLength] = '\0';
+    queuedBytes += incomingLength + 1;
+    queuedLines++;
+}
+
+// Drops the line getMessage() lent out; the rest moves up
+void BluetoothInterface::releaseLine() {
+    if (lentBytes == 0) return;
+    queuedBytes -= lentBytes;
+    memmove(linePool, linePool + lentBytes, queuedBytes + incomingLength);
+    lentBytes = 0;
+}
+
+void BluetoothInterface::checkForIncoming() {
+    // A buffering port may hold more than the backend's ring: refill it
+    // until the port is empty
+    uint8_t byte;
+    for (;;) {
+        backend.poll();
+        if (!backend.read(byte)) return;
+        do parseByte((char)byte); while (backend.read(byte));
     }
 }
 
 bool BluetoothInterface::hasMessage() {
-    return messageReady;
+    return queuedLines > 0;
 }
 
-String BluetoothInterface::getMessage() {
-    messageReady = false;
-    String msg = incomingBuffer;
-    incomingBuffer = "";
-    return msg;
+const char* BluetoothInterface::getMessage() {
+    releaseLine();
+    if (queuedLines == 0) return "";
+
+    lentBytes = strlen(linePool) + 1;
+    queuedLines--;
+    return linePool;
 }
 
 void BluetoothInterface::clearBuffer() {
-    incomingBuffer = "";
-    messageReady = false;
+    uint8_t byte;
+    while (backend.read(byte)) {}
+    queuedBytes = 0;
+    queuedLines = 0;
+    lentBytes = 0;
+    incomingLength = 0;
+    incomingTruncated = false;
+    incomingDropped = false;
+}
+
+void BluetoothInterface::resetStats() {
+    backend.resetOverruns();
+    droppedLines = 0;
+    truncatedLines = 0;
 }
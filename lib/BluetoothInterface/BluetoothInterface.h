@@ -2,23 +2,59 @@
 #define BLUETOOTH_INTERFACE_H
 
 #include <Arduino.h>
-#include <SoftwareSerial.h>
+#include "SerialBackend.h"
+
+const uint8_t BT_MAX_LINE = 64;       // Longer incoming lines are truncated
+const uint8_t BT_LINE_POOL_SIZE = 96; // Lines waiting for getMessage(), and the one coming in
+static_assert(BT_MAX_LINE + 1 < BT_LINE_POOL_SIZE, "the pool must hold the longest line");
 
 class BluetoothInterface {
 private:
-    SoftwareSerial btSerial;
-    String incomingBuffer;
-    bool messageReady;
+    SerialBackend& backend;
+
+    // Complete lines, '\0'-terminated back to back from the front, then the
+    // line being received. getMessage() lends out the first one in place;
+    // the next call drops it and moves the rest up.
+    char linePool[BT_LINE_POOL_SIZE];
+    uint8_t queuedBytes = 0;        // Complete lines, terminators included
+    uint8_t queuedLines = 0;
+    uint8_t lentBytes = 0;          // The line handed out (0: none)
+    uint8_t incomingLength = 0;     // The line being received, behind them
+    bool incomingTruncated = false;
+    bool incomingDropped = false;   // No room for it: skipped up to its end
+
+    uint16_t droppedLines = 0;   // Lost because linePool was full
+    uint16_t truncatedLines = 0; // Cut to BT_MAX_LINE
+
+    void parseByte(char c);
+    void queueLine();
+    void releaseLine();
 
 public:
-    BluetoothInterface(uint8_t rxPin, uint8_t txPin);
+    explicit BluetoothInterface(SerialBackend& serialBackend);
 
     void begin(long baudRate = 9600);
-    void sendMessage(const String& message);
+    void sendMessage(const char* message);
+    void sendMessage(const __FlashStringHelper* message);
+    // Raw bytes, no line ending (binary log frames)
+    void sendBytes(const uint8_t* data, size_t length);
+    // For formatted replies (print()/println() straight to the link)
+    Print& getStream() { return backend; }
+
+    // Parses whatever the backend has received so far. Never blocks.
     void checkForIncoming();
     bool hasMessage();
-    String getMessage();
+    // Returns the oldest queued line (valid until the next getMessage())
+    const char* getMessage();
     void clearBuffer();
+
+    // --- Receive statistics ---
+    uint16_t getByteOverruns() const { return backend.getOverruns(); }
+    uint16_t getDroppedLines() const { return droppedLines; }
+    uint16_t getTruncatedLines() const { return truncatedLines; }
+    uint8_t getQueuedLines() const { return queuedLines; }
+    // Zeroes the overrun, dropped and truncated counts
+    void resetStats();
 };
 
 #endif
@@ -0,0 +1,29 @@
+#include "SerialBackend.h"
+
+#if defined(UBRR1H)
+namespace {
+Usart1Backend* usart1Owner = nullptr; // Backend the RX ISR feeds
+}
+
+ISR(USART1_RX_vect) {
+    uint8_t byte = UDR1; // Reading UDR1 clears the interrupt
+    if (usart1Owner) usart1Owner->receive(byte);
+}
+
+void Usart1Backend::begin(long baudRate) {
+    noInterrupts();
+    usart1Owner = this;
+    // Double-speed mode halves the baud rate error at 9600/115200
+    UCSR1A = _BV(U2X1);
+    UBRR1 = (F_CPU / 4 / baudRate - 1) / 2;
+    UCSR1C = _BV(UCSZ11) | _BV(UCSZ10); // 8N1
+    UCSR1B = _BV(RXEN1) | _BV(TXEN1) | _BV(RXCIE1);
+    interrupts();
+}
+
+size_t Usart1Backend::write(uint8_t byte) {
+    while (!(UCSR1A & _BV(UDRE1))) {}
+    UDR1 = byte;
+    return 1;
+}
+#endif
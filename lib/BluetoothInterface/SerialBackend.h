@@ -0,0 +1,93 @@
+#ifndef SERIAL_BACKEND_H
+#define SERIAL_BACKEND_H
+
+#include <Arduino.h>
+#include "RingBuffer.h"
+
+const uint8_t BT_RX_RING_SIZE = 32; // Received bytes not yet parsed (power of 2)
+
+/**
+ * @brief The byte transport under BluetoothInterface.
+ *
+ * Received bytes land in a fixed SPSC ring: either straight from a UART
+ * receive ISR (producer) or moved there by poll() for ports that buffer on
+ * their own. BluetoothInterface is the only consumer. Transmit goes through
+ * Print, so println() and F() strings work as usual.
+ */
+class SerialBackend : public Print {
+protected:
+    RingBuffer<uint8_t, BT_RX_RING_SIZE> rxRing;
+    volatile uint16_t rxOverruns = 0; // Bytes lost because the ring was full
+
+public:
+    using Print::write;
+
+    virtual void begin(long baudRate) = 0;
+
+    // Moves bytes the port has buffered into the ring. ISR-driven
+    // backends have nothing to do here.
+    virtual void poll() {}
+
+    // --- Producer side (ISR or poll) ---
+    void receive(uint8_t byte) {
+        if (!rxRing.push(byte)) rxOverruns++;
+    }
+
+    // --- Consumer side ---
+    bool read(uint8_t& byte) { return rxRing.pop(byte); }
+
+    uint16_t getOverruns() const {
+        noInterrupts();
+        uint16_t count = rxOverruns;
+        interrupts();
+        return count;
+    }
+    void resetOverruns() {
+        noInterrupts();
+        rxOverruns = 0;
+        interrupts();
+    }
+};
+
+/**
+ * @brief Backend over any Arduino-style stream: SoftwareSerial,
+ * HardwareSerial, or a host-side stub with begin/available/read/write.
+ */
+template <typename SerialT>
+class StreamBackend : public SerialBackend {
+private:
+    SerialT& port;
+
+public:
+    explicit StreamBackend(SerialT& serialPort) : port(serialPort) {}
+
+    void begin(long baudRate) override { port.begin(baudRate); }
+
+    // What doesn't fit the ring waits in the port's own buffer
+    void poll() override {
+        while (!rxRing.isFull() && port.available() > 0) receive((uint8_t)port.read());
+    }
+
+    size_t write(uint8_t byte) override { return port.write(byte); }
+    size_t write(const uint8_t* data, size_t length) override {
+        return port.write(data, length);
+    }
+};
+
+#if defined(UBRR1H)
+/**
+ * @brief USART1 driven directly by its receive ISR (Mega and similar).
+ *
+ * Bytes go into the ring as they arrive, however long loop() is busy.
+ * Owns USART1_RX_vect, so Serial1 must not be used in the same sketch.
+ */
+class Usart1Backend : public SerialBackend {
+public:
+    using SerialBackend::write;
+
+    void begin(long baudRate) override;
+    size_t write(uint8_t byte) override;
+};
+#endif
+
+#endif // SERIAL_BACKEND_H
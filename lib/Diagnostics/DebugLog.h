@@ -0,0 +1,57 @@
+#ifndef DEBUG_LOG_H
+#define DEBUG_LOG_H
+
+#include <Arduino.h>
+
+// --- Leveled debug output on Serial ---
+// Pick the level with a build flag (build_flags = -D DEBUG_LEVEL=2 in
+// platformio.ini). Everything above it compiles to nothing: no code, no flash
+// strings and, more to the point, no serial time - at 9600 baud each
+// character holds loop() up for about a millisecond once the TX buffer fills.
+#define DEBUG_LEVEL_NONE  0
+#define DEBUG_LEVEL_ERROR 1 // Hardware failures, messages that were lost
+#define DEBUG_LEVEL_WARN  2 // Degraded but still working (queue full, retry)
+#define DEBUG_LEVEL_INFO  3 // Messages in and out, decoded characters
+#define DEBUG_LEVEL_TRACE 4 // Every key press, pulse and played element
+
+#ifndef DEBUG_LEVEL
+#define DEBUG_LEVEL DEBUG_LEVEL_INFO
+#endif
+
+// Same arguments as Serial.print()/println(). Arguments of a disabled level
+// are not evaluated.
+#define DEBUG_DISABLED(...) do {} while (0)
+
+#if DEBUG_LEVEL >= DEBUG_LEVEL_ERROR
+#define DEBUG_ERROR(...) Serial.print(__VA_ARGS__)
+#define DEBUG_ERRORLN(...) Serial.println(__VA_ARGS__)
+#else
+#define DEBUG_ERROR DEBUG_DISABLED
+#define DEBUG_ERRORLN DEBUG_DISABLED
+#endif
+
+#if DEBUG_LEVEL >= DEBUG_LEVEL_WARN
+#define DEBUG_WARN(...) Serial.print(__VA_ARGS__)
+#define DEBUG_WARNLN(...) Serial.println(__VA_ARGS__)
+#else
+#define DEBUG_WARN DEBUG_DISABLED
+#define DEBUG_WARNLN DEBUG_DISABLED
+#endif
+
+#if DEBUG_LEVEL >= DEBUG_LEVEL_INFO
+#define DEBUG_INFO(...) Serial.print(__VA_ARGS__)
+#define DEBUG_INFOLN(...) Serial.println(__VA_ARGS__)
+#else
+#define DEBUG_INFO DEBUG_DISABLED
+#define DEBUG_INFOLN DEBUG_DISABLED
+#endif
+
+#if DEBUG_LEVEL >= DEBUG_LEVEL_TRACE
+#define DEBUG_TRACE(...) Serial.print(__VA_ARGS__)
+#define DEBUG_TRACELN(...) Serial.println(__VA_ARGS__)
+#else
+#define DEBUG_TRACE DEBUG_DISABLED
+#define DEBUG_TRACELN DEBUG_DISABLED
+#endif
+
+#endif // DEBUG_LOG_H
@@ -0,0 +1,72 @@
+#include "LatencyProfiler.h"
+
+LatencyHistogram* LatencyHistogram::first = nullptr;
+
+LatencyHistogram::LatencyHistogram(const char* pgmName) : name(pgmName), next(first) {
+    first = this;
+    reset();
+}
+
+uint8_t LatencyHistogram::bucketFor(uint32_t us) {
+    uint8_t bucket = 0;
+    us >>= PROFILE_FIRST_BUCKET_BITS;
+    while (us && bucket < PROFILE_BUCKETS - 1) {
+        us >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+void LatencyHistogram::record(uint32_t us) {
+    if (count == 0 || us < minUs) minUs = us;
+    if (us > maxUs) maxUs = us;
+    count++;
+    uint16_t& bucket = buckets[bucketFor(us)];
+    if (bucket != 0xFFFF) bucket++;
+}
+
+void LatencyHistogram::reset() {
+    count = minUs = maxUs = 0;
+    memset(buckets, 0, sizeof(buckets));
+}
+
+uint32_t LatencyHistogram::percentileUs(uint8_t percent) const {
+    if (count == 0) return 0;
+    // Bucket totals can saturate, so rank against their sum, not count
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < PROFILE_BUCKETS; ++i) total += buckets[i];
+    uint32_t rank = (total * percent + 99) / 100;
+
+    uint32_t seen = 0;
+    for (uint8_t i = 0; i < PROFILE_BUCKETS - 1; ++i) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            uint32_t upper = 1UL << (PROFILE_FIRST_BUCKET_BITS + i);
+            return upper < maxUs ? upper : maxUs;
+        }
+    }
+    return maxUs;
+}
+
+void LatencyHistogram::print(Print& out) const {
+    out.print((const __FlashStringHelper*)name);
+    out.print(F(" n=")); out.print(count);
+    out.print(F(" min=")); out.print(minUs);
+    out.print(F(" max=")); out.print(maxUs);
+    out.print(F(" p50<=")); out.print(percentileUs(50));
+    out.print(F(" p99<=")); out.print(percentileUs(99));
+    out.print(F(" us h="));
+    for (uint8_t i = 0; i < PROFILE_BUCKETS; ++i) {
+        if (i) out.print(',');
+        out.print(buckets[i]);
+    }
+    out.println();
+}
+
+void LatencyHistogram::printAll(Print& out) {
+    for (LatencyHistogram* h = first; h; h = h->next) h->print(out);
+}
+
+void LatencyHistogram::resetAll() {
+    for (LatencyHistogram* h = first; h; h = h->next) h->reset();
+}
@@ -0,0 +1,86 @@
+#ifndef LATENCY_PROFILER_H
+#define LATENCY_PROFILER_H
+
+#include <Arduino.h>
+
+// --- Compile-time switch ---
+// Off by default: every histogram is 40 bytes of SRAM. build_flags =
+// -D PROFILING=1 (the *_diag environments) turns the timers on; with it off
+// the PROFILE_* macros below expand to nothing.
+#ifndef PROFILING
+#define PROFILING 0
+#endif
+
+// --- Histogram layout ---
+// Bucket 0 holds everything under 32 us, bucket k (1-10) holds
+// [2^(k+4), 2^(k+5)) us and the last one everything from 32.768 ms up
+// (blocking sends and playback land there; max still shows the worst case).
+const uint8_t PROFILE_BUCKETS = 12;
+const uint8_t PROFILE_FIRST_BUCKET_BITS = 5; // Bucket 0 is < 2^5 us
+
+/**
+ * @brief Min/max/count and a log2 histogram of one code section's run time.
+ *
+ * 40 bytes of RAM each on AVR. Every histogram registers itself in a static
+ * list on construction, so printAll()/resetAll() see all of them without a
+ * central table. Bucket counts saturate instead of wrapping.
+ */
+class LatencyHistogram {
+private:
+    const char* name; // PROGMEM
+    LatencyHistogram* next;
+    static LatencyHistogram* first;
+
+    uint32_t count = 0;
+    uint32_t minUs = 0;
+    uint32_t maxUs = 0;
+    uint16_t buckets[PROFILE_BUCKETS];
+
+public:
+    explicit LatencyHistogram(const char* pgmName);
+
+    void record(uint32_t us);
+    void reset();
+
+    static uint8_t bucketFor(uint32_t us);
+    // Upper bound of the bucket holding the given percentile (capped at max)
+    uint32_t percentileUs(uint8_t percent) const;
+
+    uint32_t getCount() const { return count; }
+    uint32_t getMinUs() const { return minUs; }
+    uint32_t getMaxUs() const { return maxUs; }
+    uint16_t getBucket(uint8_t bucket) const { return buckets[bucket]; }
+
+    // One line: name n=.. min=.. max=.. p50<=.. p99<=.. us h=bucket,bucket,...
+    void print(Print& out) const;
+
+    static void printAll(Print& out);
+    static void resetAll();
+};
+
+/**
+ * @brief Records the time from construction to the end of the enclosing scope.
+ */
+class ScopedTimer {
+private:
+    LatencyHistogram& histogram;
+    unsigned long startUs;
+
+public:
+    explicit ScopedTimer(LatencyHistogram& target) : histogram(target), startUs(micros()) {}
+    ~ScopedTimer() { histogram.record(micros() - startUs); }
+};
+
+// PROFILE_DEFINE(name, "label") at file scope; PROFILE_SCOPE(name) at the top
+// of the block to be timed.
+#if PROFILING
+#define PROFILE_DEFINE(var, label) \
+    const char var##Label[] PROGMEM = label; \
+    LatencyHistogram var(var##Label)
+#define PROFILE_SCOPE(var) ScopedTimer var##Timer(var)
+#else
+#define PROFILE_DEFINE(var, label)
+#define PROFILE_SCOPE(var) do {} while (0)
+#endif
+
+#endif // LATENCY_PROFILER_H
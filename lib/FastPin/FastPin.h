@@ -0,0 +1,63 @@
+#ifndef FAST_PIN_H
+#define FAST_PIN_H
+
+#include <Arduino.h>
+
+// --- DIRECT PORT ACCESS ---
+// On the Uno's ATmega328P every pin number maps to a fixed port and bit:
+//   0-7 -> PORTD 0-7, 8-13 -> PORTB 0-5, 14-19 (A0-A5) -> PORTC 0-5
+// With the pin a template argument, write() compiles to a single sbi/cbi
+// and read() to a sbic/sbis: no lookup tables, no pin checks, and the
+// port update is atomic (an ISR can't interleave with it). Other boards
+// and the host build go through the Arduino calls.
+#if defined(__AVR_ATmega328P__) || defined(__AVR_ATmega168__)
+#define FAST_PIN_DIRECT 1
+#else
+#define FAST_PIN_DIRECT 0
+#endif
+
+// Pin number for a feature that isn't fitted (e.g. SPY_BUZZER_PIN)
+const int NO_PIN = -1;
+
+/**
+ * @brief A digital pin fixed at compile time.
+ *
+ * Unlike digitalWrite(), write() doesn't switch off a PWM timer on the pin:
+ * don't analogWrite() a pin that is driven through here. FastPin<NO_PIN>
+ * stands for a missing feature: every call is an empty inline function and
+ * read() reports the idle level (HIGH, as from a pull-up), so code that uses
+ * it compiles out.
+ */
+template <int Pin>
+struct FastPin {
+    static_assert(Pin >= 0 && Pin < NUM_DIGITAL_PINS, "FastPin: no such pin");
+    static const bool present = true;
+
+#if FAST_PIN_DIRECT
+    static const uint8_t mask = 1 << (Pin < 8 ? Pin : Pin < 14 ? Pin - 8 : Pin - 14);
+    static volatile uint8_t& port() { return Pin < 8 ? PORTD : Pin < 14 ? PORTB : PORTC; }
+    static volatile uint8_t& ddr() { return Pin < 8 ? DDRD : Pin < 14 ? DDRB : DDRC; }
+    static volatile uint8_t& in() { return Pin < 8 ? PIND : Pin < 14 ? PINB : PINC; }
+
+    static void output() { ddr() |= mask; }
+    static void inputPullup() { ddr() &= ~mask; port() |= mask; }
+    static void write(bool high) { if (high) port() |= mask; else port() &= ~mask; }
+    static uint8_t read() { return (in() & mask) ? HIGH : LOW; }
+#else
+    static void output() { pinMode(Pin, OUTPUT); }
+    static void inputPullup() { pinMode(Pin, INPUT_PULLUP); }
+    static void write(bool high) { digitalWrite(Pin, high ? HIGH : LOW); }
+    static uint8_t read() { return digitalRead(Pin); }
+#endif
+};
+
+template <>
+struct FastPin<NO_PIN> {
+    static const bool present = false;
+    static void output() {}
+    static void inputPullup() {}
+    static void write(bool) {}
+    static uint8_t read() { return HIGH; }
+};
+
+#endif // FAST_PIN_H
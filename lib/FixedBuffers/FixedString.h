@@ -0,0 +1,86 @@
+#ifndef FIXED_STRING_H
+#define FIXED_STRING_H
+
+#include <Arduino.h>
+
+/**
+ * @brief A String replacement that never touches the heap.
+ *
+ * Holds up to N characters plus a terminator inline. Appends that don't fit
+ * are truncated (and report false) instead of growing the buffer, so a long
+ * message can never fragment the 2 KB of SRAM on an Uno.
+ */
+template <uint8_t N>
+class FixedString {
+private:
+    char buf[N + 1];
+    uint8_t len;
+
+public:
+    FixedString() : len(0) { buf[0] = '\0'; }
+    explicit FixedString(const char* text) : len(0) { buf[0] = '\0'; append(text); }
+
+    static uint8_t capacity() { return N; }
+    uint8_t length() const { return len; }
+    bool isEmpty() const { return len == 0; }
+    bool isFull() const { return len == N; }
+    const char* c_str() const { return buf; }
+    char operator[](uint8_t i) const { return buf[i]; }
+    char back() const { return len ? buf[len - 1] : '\0'; }
+
+    void clear() { len = 0; buf[0] = '\0'; }
+
+    bool append(char c) {
+        if (len >= N) return false;
+        buf[len++] = c;
+        buf[len] = '\0';
+        return true;
+    }
+
+    bool append(const char* text) {
+        while (*text) {
+            if (!append(*text++)) return false;
+        }
+        return true;
+    }
+
+    // Appends a string literal wrapped in F() straight from flash
+    bool append(const __FlashStringHelper* text) {
+        PGM_P p = reinterpret_cast<PGM_P>(text);
+        char c;
+        while ((c = pgm_read_byte(p++)) != '\0') {
+            if (!append(c)) return false;
+        }
+        return true;
+    }
+
+    bool appendNumber(unsigned long value) {
+        char digits[11];
+        uint8_t n = 0;
+        do { digits[n++] = '0' + value % 10; value /= 10; } while (value);
+        while (n) {
+            if (!append(digits[--n])) return false;
+        }
+        return true;
+    }
+
+    bool assign(const char* text) { clear(); return append(text); }
+    bool assign(const __FlashStringHelper* text) { clear(); return append(text); }
+
+    bool equals(const char* text) const { return strcmp(buf, text) == 0; }
+    bool startsWith(const char* text) const { return strncmp(buf, text, strlen(text)) == 0; }
+
+    // Keeps only the first newLength characters
+    void truncate(uint8_t newLength) {
+        if (newLength < len) { len = newLength; buf[len] = '\0'; }
+    }
+
+    // Drops the first count characters, shifting the rest down
+    void removeFront(uint8_t count) {
+        if (count >= len) { clear(); return; }
+        memmove(buf, buf + count, len - count + 1);
+        len -= count;
+    }
+};
+
+#endif // FIXED_STRING_H
@@ -0,0 +1,69 @@
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <stdint.h>
+
+// Stops the compiler from moving the slot write past the index update.
+// (AVR has no reordering in hardware; this is purely a compiler fence.)
+#define RING_BUFFER_BARRIER() __asm__ __volatile__("" ::: "memory")
+
+/**
+ * @brief Fixed-capacity FIFO, safe for one producer and one consumer.
+ *
+ * The producer only ever writes head and the consumer only ever writes tail,
+ * both single bytes, so one side may run in an ISR without disabling
+ * interrupts. Indices run freely and wrap at 256, which is why N must be a
+ * power of two no larger than 128.
+ */
+template <typename T, uint8_t N>
+class RingBuffer {
+    static_assert(N > 0 && (N & (N - 1)) == 0 && N <= 128,
+                  "RingBuffer size must be a power of two <= 128");
+
+private:
+    T items[N];
+    volatile uint8_t head = 0; // Next slot to write (producer)
+    volatile uint8_t tail = 0; // Next slot to read (consumer)
+
+public:
+    static uint8_t capacity() { return N; }
+    uint8_t size() const { return (uint8_t)(head - tail); }
+    bool isEmpty() const { return head == tail; }
+    bool isFull() const { return size() >= N; }
+
+    // --- Producer side ---
+    bool push(const T& item) {
+        uint8_t h = head;
+        if ((uint8_t)(h - tail) >= N) return false;
+        items[h & (N - 1)] = item;
+        RING_BUFFER_BARRIER();
+        head = h + 1;
+        return true;
+    }
+
+    // --- Consumer side ---
+    bool pop(T& out) {
+        uint8_t t = tail;
+        if (t == head) return false;
+        out = items[t & (N - 1)];
+        RING_BUFFER_BARRIER();
+        tail = t + 1;
+        return true;
+    }
+
+    // Oldest item without removing it; only valid while !isEmpty()
+    T& front() { return items[tail & (N - 1)]; }
+
+    // The i-th oldest item, without removing anything; only valid for i < size()
+    const T& peek(uint8_t i) const { return items[(uint8_t)(tail + i) & (N - 1)]; }
+
+    // Removes the oldest item (after front())
+    void drop() {
+        if (tail != head) tail = tail + 1;
+    }
+
+    // Consumer-side reset: discards everything queued
+    void clear() { tail = head; }
+};
+
+#endif // RING_BUFFER_H
@@ -0,0 +1,77 @@
+#include "KeyInput.h"
+
+void KeyInput::begin(uint8_t level, bool edgeInterrupt) {
+    enabled = true;
+    interruptDriven = edgeInterrupt;
+    pinLevel = rawLevel = level;
+    pressed = rawLevel == LOW;
+}
+
+// --- Debouncing (loop side) ---
+void KeyInput::take(unsigned long us, uint8_t level) {
+    if (settling && us - lastEdgeUs >= KEY_DEBOUNCE_US) endBurst();
+    if (!settling) {
+        settling = true;
+        burstStartUs = us;
+    }
+    lastEdgeUs = us;
+    rawLevel = level;
+}
+
+void KeyInput::endBurst() {
+    settling = false;
+    bool nowPressed = rawLevel == LOW;
+    if (nowPressed == pressed) { glitches++; return; }
+    pressed = nowPressed;
+    next.us = burstStartUs;
+    next.pressed = pressed;
+    ready = true;
+}
+
+bool KeyInput::peek(KeyEvent& event) {
+    if (ready) { event = next; return true; }
+    if (!enabled) return false;
+
+    // The front end sampled the pin first: edges stamped after this can't
+    // change what is decided here
+    unsigned long nowUs = micros();
+    if (!interruptDriven && pinLevel != rawLevel) take(nowUs, pinLevel);
+
+    Edge edge;
+    while (!ready && edges.pop(edge)) take(edge.us, edge.level);
+
+    if (!ready && overrun && edges.isEmpty()) {
+        // Edges were lost: carry on from the level the pin has now
+        overrun = false;
+        overruns++;
+        if (pinLevel != rawLevel) take(nowUs, pinLevel);
+    }
+
+    // The ISR may have stamped an edge after nowUs while we drained
+    if (!ready && settling && (long)(nowUs - lastEdgeUs) >= (long)KEY_DEBOUNCE_US) endBurst();
+    if (!ready) return false;
+    event = next;
+    return true;
+}
+
+bool KeyInput::read(KeyEvent& event) {
+    if (!peek(event)) return false;
+    ready = false;
+    return true;
+}
+
+#if !defined(__AVR__)
+void RuntimeKeyPin::begin(KeyInput& input) {
+    if (pin == NO_PIN) return;
+    key = &input;
+    pinMode(pin, INPUT_PULLUP);
+    int line = digitalPinToInterrupt(pin);
+    input.begin(digitalRead(pin), line != NOT_AN_INTERRUPT);
+    if (line != NOT_AN_INTERRUPT) attachInterruptArg(line, onEdge, this, CHANGE);
+}
+
+void RuntimeKeyPin::onEdge(void* self) {
+    RuntimeKeyPin* front = static_cast<RuntimeKeyPin*>(self);
+    front->key->capture(digitalRead(front->pin));
+}
+#endif
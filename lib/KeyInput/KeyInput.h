@@ -0,0 +1,150 @@
+#ifndef KEY_INPUT_H
+#define KEY_INPUT_H
+
+#include <Arduino.h>
+#include "RingBuffer.h"
+#include "FastPin.h"
+
+// --- EDGE CAPTURE ---
+const uint8_t KEY_EDGE_QUEUE = 8;           // Raw edges held between reads (power of 2): two bouncy transitions
+const unsigned long KEY_DEBOUNCE_US = 5000; // A contact is settled after this long without an edge
+
+// A debounced transition, stamped with the time of its first raw edge
+struct KeyEvent {
+    unsigned long us;
+    bool pressed;
+};
+
+/**
+ * @brief One active-low key contact, timed by its pin interrupt.
+ *
+ * On an external interrupt pin the ISR stamps every edge with micros() and
+ * drops it into a small ring, so mark and gap durations are as exact as the
+ * contact itself, however long loop() takes between reads. read() debounces
+ * that stream: a burst of edges is one transition once KEY_DEBOUNCE_US pass
+ * without another, timed from its first edge. A burst that ends where it
+ * started (a glitch) is dropped. Pins without an interrupt are sampled on
+ * every read() instead.
+ *
+ * The pin itself is handled by a front end: KeyPin<Pin> (fixed at compile
+ * time) or, on the host, RuntimeKeyPin. It calls begin() and capture(), and
+ * sample()s the pin before each round of peek()/read().
+ */
+class KeyInput {
+private:
+    struct Edge {
+        unsigned long us;
+        uint8_t level;
+    };
+
+    bool enabled = false;
+    bool interruptDriven = false;
+    RingBuffer<Edge, KEY_EDGE_QUEUE> edges; // Filled by the ISR
+    volatile bool overrun = false;          // The ISR found the ring full
+    uint8_t pinLevel = HIGH;                // As last sample()d
+
+    uint8_t rawLevel = HIGH;        // Level after the last edge taken
+    bool pressed = false;           // Debounced state
+    bool settling = false;          // A burst is still bouncing
+    unsigned long burstStartUs = 0;
+    unsigned long lastEdgeUs = 0;
+
+    bool ready = false;             // next holds an event not yet read
+    KeyEvent next;
+
+    unsigned int glitches = 0;
+    unsigned int overruns = 0;
+
+    void take(unsigned long us, uint8_t level);
+    void endBurst();
+
+public:
+    // --- Front end side ---
+    // The pin's level now, and whether its interrupt will capture() edges.
+    // A key that never begins stays disabled: it never reports anything.
+    void begin(uint8_t level, bool edgeInterrupt);
+    // From the pin's ISR, with the level the pin has now
+    void capture(uint8_t level) {
+        Edge edge = { micros(), level };
+        if (!edges.push(edge)) overrun = true;
+    }
+    // The pin's level, read just before peek()/read(): polled pins are
+    // timed by it, and it resyncs an interrupt pin after an overrun
+    void sample(uint8_t level) { pinLevel = level; }
+
+    // Oldest debounced transition not read yet, without removing it
+    bool peek(KeyEvent& event);
+    bool read(KeyEvent& event);
+
+    // After peek()/read() came back empty: nothing can still turn up with a
+    // timestamp before this (the start of a burst that is still bouncing).
+    unsigned long settledUntil(unsigned long nowUs) const { return settling ? burstStartUs : nowUs; }
+
+    bool isPressed() const { return pressed; }
+    bool isEnabled() const { return enabled; }
+
+    // Bursts dropped as glitches; times the ring filled up and we resynced
+    unsigned int getGlitches() const { return glitches; }
+    unsigned int getOverruns() const { return overruns; }
+    void resetStats() { glitches = overruns = 0; }
+};
+
+/**
+ * @brief Key on a pin fixed at compile time. On the AVR each pin gets its
+ * own ISR that reads the port directly (nothing is looked up per edge);
+ * KeyPin<NO_PIN> leaves the key disabled and costs nothing.
+ */
+template <int Pin>
+class KeyPin {
+private:
+#if defined(__AVR__)
+    static KeyInput* key;
+    static void onEdge() { key->capture(FastPin<Pin>::read()); }
+#else
+    // Host builds run several boards: the HAL hands each ISR its own key
+    static void onEdge(void* key) { static_cast<KeyInput*>(key)->capture(FastPin<Pin>::read()); }
+#endif
+
+public:
+    static void begin(KeyInput& input) {
+        FastPin<Pin>::inputPullup();
+        int line = digitalPinToInterrupt(Pin);
+        input.begin(FastPin<Pin>::read(), line != NOT_AN_INTERRUPT);
+        if (line == NOT_AN_INTERRUPT) return; // Polled
+#if defined(__AVR__)
+        key = &input;
+        attachInterrupt(line, onEdge, CHANGE);
+#else
+        attachInterruptArg(line, onEdge, &input, CHANGE);
+#endif
+    }
+    static uint8_t read() { return FastPin<Pin>::read(); }
+};
+
+#if defined(__AVR__)
+template <int Pin> KeyInput* KeyPin<Pin>::key = nullptr;
+#endif
+
+template <>
+class KeyPin<NO_PIN> {
+public:
+    static void begin(KeyInput&) {}
+    static uint8_t read() { return HIGH; }
+};
+
+#if !defined(__AVR__)
+// Host: a key on a pin chosen at run time (-1: none)
+class RuntimeKeyPin {
+private:
+    int pin;
+    KeyInput* key = nullptr;
+    static void onEdge(void* self);
+
+public:
+    explicit RuntimeKeyPin(int pin) : pin(pin) {}
+    void begin(KeyInput& input);
+    uint8_t read() const { return pin == NO_PIN ? HIGH : digitalRead(pin); }
+};
+#endif
+
+#endif // KEY_INPUT_H
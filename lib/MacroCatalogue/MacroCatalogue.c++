@@ -0,0 +1,43 @@
+#include "MacroCatalogue.h"
+#include "MacroCatalogueData.h"
+
+static_assert(MACRO_LONGEST_EXPANSION <= MacroCatalogue::MAX_EXPANSION,
+              "macros.txt has an expansion longer than MAX_EXPANSION");
+
+namespace {
+
+// 16-bit FNV-style hash. Must match macro_hash() in scripts/gen_macros.py.
+uint16_t macroHash(const char* key, uint8_t seed) {
+    uint16_t h = 0x811C + seed * 0x9E37u;
+    while (*key) h = (h ^ (uint8_t)*key++) * 0x0193u;
+    return h ^ (h >> 8);
+}
+
+} // namespace
+
+PGM_P MacroCatalogue::find(const char* key) {
+    // Longer than any key: can't match, skip the hashing
+    if (strnlen(key, MACRO_LONGEST_KEY + 1) > MACRO_LONGEST_KEY) return nullptr;
+
+    uint8_t seed = pgm_read_byte(&MACRO_SEEDS[macroHash(key, 0) % MACRO_BUCKETS]);
+    uint16_t offset = pgm_read_word(&MACRO_SLOT_OFFSETS[macroHash(key, seed) % MACRO_SLOTS]);
+    if (offset == MACRO_EMPTY_SLOT) return nullptr;
+
+    PGM_P entry = MACRO_POOL + offset;
+    if (strcmp_P(key, entry) != 0) return nullptr;
+    return entry + strlen_P(entry) + 1;
+}
+
+uint16_t MacroCatalogue::size() {
+    return MACRO_COUNT;
+}
+
+uint16_t MacroCatalogue::slots() {
+    return MACRO_SLOTS;
+}
+
+PGM_P MacroCatalogue::keyAt(uint16_t slot) {
+    if (slot >= MACRO_SLOTS) return nullptr;
+    uint16_t offset = pgm_read_word(&MACRO_SLOT_OFFSETS[slot]);
+    return offset == MACRO_EMPTY_SLOT ? nullptr : MACRO_POOL + offset;
+}
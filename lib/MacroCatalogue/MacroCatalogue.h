@@ -0,0 +1,36 @@
+#ifndef MACRO_CATALOGUE_H
+#define MACRO_CATALOGUE_H
+
+#include <Arduino.h>
+#include "FixedString.h"
+
+// --- BREVITY CODES ---
+// Key -> expansion table, generated from macros.txt by scripts/gen_macros.py
+// (see MacroCatalogueData.h). Keys are found through a perfect hash: two
+// 16-bit hashes of the key and a single strcmp_P, however big the catalogue.
+// Keys and expansions stay in flash.
+class MacroCatalogue {
+public:
+    static const uint8_t MAX_EXPANSION = 64; // Checked by the generator
+
+    // The expansion of key, in flash, or nullptr if key isn't a brevity code
+    static PGM_P find(const char* key);
+
+    // Copies the expansion of key straight from flash into out.
+    // Returns false (out untouched) if key isn't a brevity code.
+    template <uint8_t N>
+    static bool expand(const char* key, FixedString<N>& out) {
+        PGM_P expansion = find(key);
+        if (!expansion) return false;
+        return out.assign(reinterpret_cast<const __FlashStringHelper*>(expansion));
+    }
+
+    // Walking the table (listings, tests): slots() entries, each one a key in
+    // flash or nullptr for an unused slot. The expansion follows the key's
+    // terminator.
+    static uint16_t size();
+    static uint16_t slots();
+    static PGM_P keyAt(uint16_t slot);
+};
+
+#endif // MACRO_CATALOGUE_H
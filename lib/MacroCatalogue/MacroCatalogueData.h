@@ -0,0 +1,37 @@
+// Generated by scripts/gen_macros.py from macros.txt. Do not edit: change
+// macros.txt and rebuild (PlatformIO reruns the script) or run the script.
+//
+// 5 entries in 5 slots, 2 buckets. Flash: pool 102 B,
+// slot table 10 B, seeds 2 B = 114 B (22.8 B per entry,
+// 2.4 B of it index). SRAM: none.
+#ifndef MACRO_CATALOGUE_DATA_H
+#define MACRO_CATALOGUE_DATA_H
+
+#include <Arduino.h>
+
+const uint16_t MACRO_COUNT = 5;
+const uint16_t MACRO_SLOTS = 5;
+const uint16_t MACRO_BUCKETS = 2;
+const uint16_t MACRO_EMPTY_SLOT = 0xFFFF;
+const uint8_t MACRO_LONGEST_KEY = 3;
+const uint8_t MACRO_LONGEST_EXPANSION = 20;
+
+// Bucket (first hash) -> seed of the second hash
+const uint8_t MACRO_SEEDS[MACRO_BUCKETS] PROGMEM = {
+    5, 3
+};
+
+// Slot (second hash) -> offset of the entry in MACRO_POOL
+const uint16_t MACRO_SLOT_OFFSETS[MACRO_SLOTS] PROGMEM = {
+    0, 24, 46, 62, 81
+};
+
+// "KEY\0EXPANSION\0" per entry, in slot order (offsets in the comments)
+const char MACRO_POOL[] PROGMEM =
+    /*    0 */ "S2\0" "SECTOR 2 COMPROMISED\0"
+    /*   24 */ "RTB\0" "RETURNING TO BASE\0"
+    /*   46 */ "73\0" "BEST REGARDS\0"
+    /*   62 */ "S1\0" "SECTOR 1 SECURE\0"
+    /*   81 */ "B9\0" "BATTERY CRITICAL\0";
+
+#endif // MACRO_CATALOGUE_DATA_H
@@ -1,4 +1,5 @@
 #include "MessageLogger.h"
+#include "DebugLog.h"
 
 MessageLogger::MessageLogger(BluetoothInterface& btInstance, RTC_DS3231& rtcInstance)
     : bt(btInstance), rtc(rtcInstance) {
@@ -8,59 +9,194 @@ MessageLogger::MessageLogger(BluetoothInterface& btInstance, RTC_DS3231& rtcInst
 bool MessageLogger::begin() {
     // FIX 1: Wire.begin() is void, so we just call it.
     // We can't check its return value.
-    Wire.begin(); 
+    Wire.begin();
 
     if (!rtc.begin()) {
-        Serial.println(F("Couldn't find RTC module!"));
+        DEBUG_ERRORLN(F("Couldn't find RTC module!"));
         bt.sendMessage(F("LOG_ERROR: RTC NOT FOUND"));
         return false;
     }
 
     if (rtc.lostPower()) {
-        Serial.println(F("RTC lost power, setting time to compile time..."));
-        
+        DEBUG_WARNLN(F("RTC lost power, setting time to compile time..."));
+
         // FIX 2: Removed the F() macro from _DATE_ and _TIME_
         rtc.adjust(DateTime(__DATE__, __TIME__));
-        
+
         // You can also set a specific time:
         // rtc.adjust(DateTime(2025, 1, 21, 10, 0, 0));
     }
 
-    Serial.println(F("RTC and Logger initialized."));
+    syncClock();
+
+    DEBUG_INFOLN(F("RTC and Logger initialized."));
     bt.sendMessage(F("LOG_SYSTEM: Logger online."));
     return true;
 }
 
-void MessageLogger::formatTimestamp(const DateTime& now) {
-    // Formats the timestamp into: "YYYY-MM-DD hh:mm:ss"
-    snprintf(timestamp, sizeof(timestamp), "%04d-%02d-%02d %02d:%02d:%02d",
-             now.year(),
-             now.month(),
-             now.day(),
-             now.hour(),
-             now.minute(),
-             now.second());
+// --- RTC Cache ---
+void MessageLogger::syncClock() {
+    rtcEpoch = rtc.now().unixtime();
+    rtcMillis = millis();
+}
+
+uint32_t MessageLogger::currentEpoch() const {
+    return rtcEpoch + (millis() - rtcMillis) / 1000;
+}
+
+const __FlashStringHelper* MessageLogger::originName(LogOrigin origin) {
+    switch (origin) {
+        case LOG_SPY:   return F("SPY");
+        case LOG_ADMIN: return F("ADMIN");
+        case LOG_ERROR: return F("ERROR");
+        default:        return F("SYSTEM");
+    }
+}
+
+// --- Producer: copy into the rings, nothing else ---
+bool MessageLogger::log(LogOrigin origin, const char* message, uint8_t node) {
+    return queueRecord(origin, message, false, node);
+}
+
+bool MessageLogger::log(LogOrigin origin, const __FlashStringHelper* message, uint8_t node) {
+    return queueRecord(origin, reinterpret_cast<const char*>(message), true, node);
+}
+
+bool MessageLogger::queueRecord(LogOrigin origin, const char* message, bool inFlash, uint8_t node) {
+    size_t fullLength = inFlash ? strlen_P(message) : strlen(message);
+    uint8_t length = LOG_MAX_TEXT_LEN;
+    if (fullLength > LOG_MAX_TEXT_LEN) {
+        truncatedRecords++;
+    } else {
+        length = (uint8_t)fullLength;
+    }
+
+    // Reject whole records rather than queueing half a message
+    if (records.isFull() ||
+        (uint8_t)(LOG_TEXT_POOL_SIZE - textPool.size()) < length) {
+        droppedRecords++;
+        return false;
+    }
+
+    for (uint8_t i = 0; i < length; ++i) {
+        textPool.push(inFlash ? (char)pgm_read_byte(message + i) : message[i]);
+    }
+
+    LogRecord record;
+    record.epoch = currentEpoch();
+    record.origin = origin;
+    record.node = node;
+    record.length = length;
+    records.push(record);
+    return true;
+}
+
+// --- Consumer: a few bytes per call, during idle loop() time ---
+void MessageLogger::update() {
+    if (millis() - rtcMillis >= LOG_RTC_RESYNC_MS) syncClock();
+
+    if (!writing) {
+        if (records.isEmpty()) return;
+        startRecord(records.front());
+    }
+    const LogRecord& record = records.front();
+    writeSerial(record);
+    writeBluetooth(record);
+
+    uint8_t textLength = headLength + record.length + 2;
+    uint8_t btLength = writingFrame ? LOG_FRAME_HEADER + record.length + 1 : textLength;
+    if (serialWritten < textLength || btWritten < btLength) return;
+    for (uint8_t i = 0; i < record.length; ++i) textPool.drop();
+    records.drop();
+    writing = false;
+}
+
+void MessageLogger::startRecord(const LogRecord& record) {
+    // Text form: "[2025-11-04 09:30:00] [N3] [SPY] > SOS" (no [N..] without a node)
+    DateTime time(record.epoch);
+    char timestamp[32];
+    snprintf_P(timestamp, sizeof(timestamp), PSTR("%04d-%02d-%02d %02d:%02d:%02d"),
+             time.year(),
+             time.month(),
+             time.day(),
+             time.hour(),
+             time.minute(),
+             time.second());
+
+    FixedString<LOG_HEADER_LEN> header;
+    header.append('[');
+    header.append(timestamp);
+    header.append(F("] ["));
+    if (record.node) {
+        header.append('N');
+        header.appendNumber(record.node);
+        header.append(F("] ["));
+    }
+    header.append(originName(record.origin));
+    header.append(F("] > "));
+    headLength = header.length();
+    memcpy(head, header.c_str(), headLength);
+
+    // Serial always gets the text form; Bluetooth may get a frame instead
+    writingFrame = binaryFrames;
+    checksum = 0;
+    if (writingFrame) {
+        uint8_t n = 0;
+        frameHead[n++] = LOG_FRAME_START;
+        frameHead[n++] = (record.node << 4) | record.origin;
+        for (uint8_t shift = 0; shift < 32; shift += 8) {
+            frameHead[n++] = (uint8_t)(record.epoch >> shift);
+        }
+        frameHead[n++] = record.length;
+        for (uint8_t i = 1; i < n; ++i) checksum ^= frameHead[i];
+    }
+    serialWritten = 0;
+    btWritten = 0;
+    writing = true;
+}
+
+uint8_t MessageLogger::textByte(const LogRecord& record, uint8_t pos) const {
+    if (pos < headLength) return head[pos];
+    pos -= headLength;
+    if (pos < record.length) return (uint8_t)textPool.peek(pos);
+    return pos == record.length ? '\r' : '\n';
 }
 
-void MessageLogger::log(const String& origin, const String& message) {
-    // 1. Get the current time
-    DateTime now = rtc.now();
-    
-    // 2. Format the timestamp
-    formatTimestamp(now);
-
-    // 3. Create the full log entry
-    // Example: "[2025-11-04 09:30:00] [SPY] > SOS"
-    String logEntry = "[";
-    logEntry += timestamp;
-    logEntry += "] [";
-    logEntry += origin;
-    logEntry += "] > ";
-    logEntry += message;
-
-    // 4. Send over Bluetooth
-    bt.sendMessage(logEntry);
-
-    // 5. (Optional) Print to local Serial as well
-    Serial.println(logEntry);
-}
\ No newline at end of file
+void MessageLogger::writeSerial(const LogRecord& record) {
+    uint8_t remaining = headLength + record.length + 2 - serialWritten;
+    int room = Serial.availableForWrite();
+    uint8_t n = remaining < LOG_WRITE_CHUNK ? remaining : LOG_WRITE_CHUNK;
+    if (room < n) n = room > 0 ? (uint8_t)room : 0;
+    if (n == 0) return;
+
+    uint8_t chunk[LOG_WRITE_CHUNK];
+    for (uint8_t i = 0; i < n; ++i) chunk[i] = textByte(record, serialWritten++);
+    Serial.write(chunk, n);
+}
+
+void MessageLogger::writeBluetooth(const LogRecord& record) {
+    uint8_t chunk[LOG_WRITE_CHUNK];
+    uint8_t n = 0;
+    if (!writingFrame) {
+        uint8_t recordLength = headLength + record.length + 2;
+        while (n < LOG_WRITE_CHUNK && btWritten < recordLength) {
+            chunk[n++] = textByte(record, btWritten++);
+        }
+    } else {
+        uint8_t textEnd = LOG_FRAME_HEADER + record.length;
+        while (n < LOG_WRITE_CHUNK && btWritten <= textEnd) {
+            uint8_t byte;
+            if (btWritten < LOG_FRAME_HEADER) {
+                byte = frameHead[btWritten];
+            } else if (btWritten < textEnd) {
+                byte = (uint8_t)textPool.peek(btWritten - LOG_FRAME_HEADER);
+                checksum ^= byte;
+            } else {
+                byte = checksum;
+            }
+            chunk[n++] = byte;
+            btWritten++;
+        }
+    }
+    if (n) bt.sendBytes(chunk, n);
+}
@@ -5,17 +5,116 @@
 #include "BluetoothInterface.h"
 #include <RTClib.h>
 #include <Wire.h> // RTC modules use I2C
+#include "FixedString.h"
+#include "RingBuffer.h"
+
+const uint8_t LOG_HEADER_LEN = 40;        // "[timestamp] [N3] [ORIGIN] > " before the message
+
+// --- QUEUE CONFIGURATION ---
+// log() only copies into these rings; update() writes them out later.
+// Overflow policy: a record that does not fit (record slot or text bytes)
+// is rejected whole and counted, so queued records are never corrupted.
+const uint8_t LOG_QUEUE_SIZE = 4;         // Records waiting to be written (power of 2)
+const uint8_t LOG_TEXT_POOL_SIZE = 64;    // Shared text bytes for them (power of 2)
+const uint8_t LOG_MAX_TEXT_LEN = 64;      // Longer messages are truncated (a radio message fits)
+static_assert(LOG_MAX_TEXT_LEN <= LOG_TEXT_POOL_SIZE, "the longest record must fit the pool");
+static_assert(LOG_HEADER_LEN + LOG_MAX_TEXT_LEN + 2 <= 255, "a record's length must fit a byte");
+
+// --- SINK PACING ---
+// The Bluetooth module hangs off a 9600-baud SoftwareSerial, which sends a
+// byte in about 1 ms with interrupts off. update() hands it this many bytes
+// per call, so a long record takes a few loop()s instead of blocking one.
+// Serial runs at 9600 baud too: once its 64-byte TX buffer is full, write()
+// waits about 1 ms per byte. It gets at most this many bytes per call as
+// well, and never more than Serial.availableForWrite() says still fit, so
+// other Serial output printed in between can end up inside a record's line.
+const uint8_t LOG_WRITE_CHUNK = 8;
+
+// --- RTC CACHE ---
+// The DS3231 is read once and then extrapolated from millis(); update()
+// re-reads it this often to correct for millis() drift.
+const unsigned long LOG_RTC_RESYNC_MS = 600000UL; // 10 minutes
+
+// --- BINARY FRAMING (Bluetooth sink only) ---
+// [0x7E][node << 4 | origin][epoch LE x4][len][text x len][xor of origin..text]
+const uint8_t LOG_FRAME_START = 0x7E;
+const uint8_t LOG_FRAME_HEADER = 7; // Start to len
+
+enum LogOrigin : uint8_t {
+    LOG_SYSTEM = 0,
+    LOG_SPY = 1,
+    LOG_ADMIN = 2,
+    LOG_ERROR = 3
+};
 
 class MessageLogger {
 private:
+    struct LogRecord {
+        uint32_t epoch;     // Seconds since 1970 (RTC time)
+        LogOrigin origin;
+        uint8_t node;       // Radio node the message came from / went to (0: none)
+        uint8_t length;     // Bytes of text waiting in textPool
+    };
+
     BluetoothInterface& bt; // Reference to the BT module
     RTC_DS3231& rtc;        // Reference to the RTC module
-    char timestamp[25];     // Buffer to hold "YYYY-MM-DD hh:mm:ss"
+
+    RingBuffer<LogRecord, LOG_QUEUE_SIZE> records;
+    RingBuffer<char, LOG_TEXT_POOL_SIZE> textPool;
+    uint16_t droppedRecords = 0;
+    uint16_t truncatedRecords = 0;
+    bool binaryFrames = false;
+
+    // The record at the front of the queue, part way to both sinks: its
+    // header, then its text read in place from textPool, then the trailer
+    // (CR LF, or the frame's checksum). Its text is dropped once both are done.
+    bool writing = false;
+    bool writingFrame = false;  // Bluetooth gets frameHead instead of head
+    uint8_t head[LOG_HEADER_LEN];
+    uint8_t headLength = 0;
+    uint8_t frameHead[LOG_FRAME_HEADER];
+    uint8_t serialWritten = 0;
+    uint8_t btWritten = 0;
+    uint8_t checksum = 0;
+
+    // Cached RTC time: epoch = rtcEpoch + (millis() - rtcMillis) / 1000
+    uint32_t rtcEpoch = 0;
+    unsigned long rtcMillis = 0;
+
+    /**
+     * @brief Re-reads the RTC into the cache (one I2C transaction).
+     */
+    void syncClock();
 
     /**
-     * @brief Formats the current time into the timestamp buffer.
+     * @brief Current time from the cache, no I2C traffic.
      */
-    void formatTimestamp(const DateTime& now);
+    uint32_t currentEpoch() const;
+
+    /**
+     * @brief Formats the front record's header (and frame header, if framing).
+     */
+    void startRecord(const LogRecord& record);
+
+    /**
+     * @brief Byte pos of the record as text: header, text, CR LF.
+     */
+    uint8_t textByte(const LogRecord& record, uint8_t pos) const;
+
+    /**
+     * @brief Sends the next bytes of it to Serial, as far as its buffer has room.
+     */
+    void writeSerial(const LogRecord& record);
+
+    /**
+     * @brief Sends the next LOG_WRITE_CHUNK bytes of it to Bluetooth.
+     */
+    void writeBluetooth(const LogRecord& record);
+
+    static const __FlashStringHelper* originName(LogOrigin origin);
+
+    // log() for text in RAM or, with inFlash, in flash
+    bool queueRecord(LogOrigin origin, const char* message, bool inFlash, uint8_t node);
 
 public:
     /**
@@ -32,11 +131,32 @@ public:
     bool begin();
 
     /**
-     * @brief Logs a message with a timestamp.
-     * @param origin A string like "SPY" or "ADMIN".
-     * @param message The message content to log.
+     * @brief Queues a timestamped message. Never blocks and never touches I2C.
+     * @param origin Who produced the message.
+     * @param message The message content (copied, truncated to LOG_MAX_TEXT_LEN).
+     * @param node Spy node the message came from or went to (0 if none).
+     * @return False if the queue was full and the record was dropped.
+     */
+    bool log(LogOrigin origin, const char* message, uint8_t node = 0);
+    // The same for a fixed text: log(LOG_ERROR, F("..."))
+    bool log(LogOrigin origin, const __FlashStringHelper* message, uint8_t node = 0);
+
+    /**
+     * @brief Writes out the next LOG_WRITE_CHUNK bytes of the queued records
+     * to each sink and resyncs the RTC when due. Call from loop().
      */
-    void log(const String& origin, const String& message);
+    void update();
+
+    /**
+     * @brief Switches the Bluetooth sink between text lines and binary frames,
+     * from the next record on. Serial always gets text.
+     */
+    void setBinaryFrames(bool enabled) { binaryFrames = enabled; }
+
+    uint8_t getPendingRecords() const { return records.size(); }
+    uint16_t getDroppedRecords() const { return droppedRecords; }
+    uint16_t getTruncatedRecords() const { return truncatedRecords; }
+    void resetStats() { droppedRecords = truncatedRecords = 0; }
 };
 
-#endif // MESSAGE_LOGGER_H
\ No newline at end of file
+#endif // MESSAGE_LOGGER_H
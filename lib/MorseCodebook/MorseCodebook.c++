@@ -0,0 +1,82 @@
+#include "MorseCodebook.h"
+
+namespace {
+
+struct MorseSymbol {
+    char character;
+    const char* pattern;
+};
+
+// --- THE ONE MORSE TABLE (shared by TX and RX) ---
+// Edit here only: both lookup tables below are generated from it at compile time.
+constexpr MorseSymbol SYMBOLS[] = {
+    {'A', ".-"},    {'B', "-..."},  {'C', "-.-."},  {'D', "-.."},   {'E', "."},
+    {'F', "..-."},  {'G', "--."},   {'H', "...."},  {'I', ".."},    {'J', ".---"},
+    {'K', "-.-"},   {'L', ".-.."},  {'M', "--"},    {'N', "-."},    {'O', "---"},
+    {'P', ".--."},  {'Q', "--.-"},  {'R', ".-."},   {'S', "..."},   {'T', "-"},
+    {'U', "..-"},   {'V', "...-"},  {'W', ".--"},   {'X', "-..-"},  {'Y', "-.--"},
+    {'Z', "--.."},
+    {'0', "-----"}, {'1', ".----"}, {'2', "..---"}, {'3', "...--"}, {'4', "....-"},
+    {'5', "....."}, {'6', "-...."}, {'7', "--..."}, {'8', "---.."}, {'9', "----."},
+    {' ', ""},      // Word gap: no elements
+    {'!', "..--"}   // Duress code (not a standard letter)
+};
+constexpr uint8_t SYMBOL_COUNT = sizeof(SYMBOLS) / sizeof(SYMBOLS[0]);
+
+constexpr uint8_t codeFor(char c, uint8_t i = 0) {
+    return i >= SYMBOL_COUNT ? MorseCodebook::NONE
+         : SYMBOLS[i].character == c ? (uint8_t)MorseCodebook::pack(SYMBOLS[i].pattern)
+         : codeFor(c, i + 1);
+}
+
+constexpr char charFor(uint8_t code, uint8_t i = 0) {
+    return i >= SYMBOL_COUNT ? '\0'
+         : MorseCodebook::pack(SYMBOLS[i].pattern) == code ? SYMBOLS[i].character
+         : charFor(code, i + 1);
+}
+
+// Expands to 16 consecutive table entries starting at index i.
+#define CODEBOOK_ROW4(F, i) F(i), F(i + 1), F(i + 2), F(i + 3)
+#define CODEBOOK_ROW16(F, i) CODEBOOK_ROW4(F, i), CODEBOOK_ROW4(F, i + 4), \
+                             CODEBOOK_ROW4(F, i + 8), CODEBOOK_ROW4(F, i + 12)
+#define CODEBOOK_DECODE(i) charFor(i)
+#define CODEBOOK_ENCODE(i) codeFor(i)
+
+// Packed code -> character
+const char decodeTable[MorseCodebook::TABLE_SIZE] PROGMEM = {
+    CODEBOOK_ROW16(CODEBOOK_DECODE, 0),  CODEBOOK_ROW16(CODEBOOK_DECODE, 16),
+    CODEBOOK_ROW16(CODEBOOK_DECODE, 32), CODEBOOK_ROW16(CODEBOOK_DECODE, 48)
+};
+
+// ASCII ' ' (32) .. '_' (95) -> packed code
+const uint8_t ENCODE_FIRST = ' ';
+const uint8_t ENCODE_LAST = '_';
+const uint8_t encodeTable[ENCODE_LAST - ENCODE_FIRST + 1] PROGMEM = {
+    CODEBOOK_ROW16(CODEBOOK_ENCODE, 32), CODEBOOK_ROW16(CODEBOOK_ENCODE, 48),
+    CODEBOOK_ROW16(CODEBOOK_ENCODE, 64), CODEBOOK_ROW16(CODEBOOK_ENCODE, 80)
+};
+
+static_assert(charFor(MorseCodebook::pack(".-")) == 'A', "codebook generation broken");
+static_assert(codeFor('!') == MorseCodebook::pack("..--"), "codebook generation broken");
+
+} // namespace
+
+uint8_t MorseCodebook::encode(char c) {
+    if (c >= 'a' && c <= 'z') c -= 'a' - 'A';
+    if (c < (char)ENCODE_FIRST || c > (char)ENCODE_LAST) return NONE;
+    return pgm_read_byte(&encodeTable[c - ENCODE_FIRST]);
+}
+
+char MorseCodebook::decode(uint8_t code) {
+    if (code >= TABLE_SIZE) return '\0';
+    return (char)pgm_read_byte(&decodeTable[code]);
+}
+
+uint8_t MorseCodebook::toPattern(uint8_t code, char* out) {
+    uint8_t len = length(code);
+    for (uint8_t i = 0; i < len; ++i) {
+        out[i] = (code & (1 << (len - 1 - i))) ? '-' : '.';
+    }
+    out[len] = '\0';
+    return len;
+}
@@ -0,0 +1,51 @@
+#ifndef MORSE_CODEBOOK_H
+#define MORSE_CODEBOOK_H
+
+#include <Arduino.h>
+
+// --- PACKED MORSE CODES ---
+// A symbol is packed into one byte as a leading "sentinel" 1 bit followed by
+// one bit per element (dot = 0, dash = 1), first element most significant:
+//   "" -> 0b1   "." -> 0b10   "-" -> 0b11   ".-" (A) -> 0b101
+// The sentinel's position gives the length, the bits below it the pattern, so
+// a receiver can build the code one pulse at a time and index a table with it.
+class MorseCodebook {
+public:
+    static const uint8_t NONE = 0;          // Not a Morse character
+    static const uint8_t EMPTY = 1;         // No elements yet (also encodes ' ')
+    static const uint8_t MAX_ELEMENTS = 7;  // Most elements a byte code can hold
+    static const uint8_t TABLE_SIZE = 64;   // Codes 0..63 (up to 5 elements) decode
+
+    // Packs a pattern like "..--" at compile time. Also used for multi-character
+    // sequences such as the passcode, hence the wider return type.
+    static constexpr unsigned int pack(const char* pattern, unsigned int code = EMPTY) {
+        return *pattern ? pack(pattern + 1, (code << 1) | (*pattern == '-' ? 1 : 0)) : code;
+    }
+
+    // Appends one element. A full code (MAX_ELEMENTS) is left as it is and
+    // false comes back, so the caller can tell an element was dropped.
+    static bool append(uint8_t& code, bool dash) {
+        if (length(code) >= MAX_ELEMENTS) return false;
+        code = (code << 1) | (dash ? 1 : 0);
+        return true;
+    }
+
+    // Number of elements in a code (0 for EMPTY and NONE).
+    static uint8_t length(uint8_t code) {
+        uint8_t len = 0;
+        while (code > 1) { code >>= 1; len++; }
+        return len;
+    }
+
+    // Character -> packed code, or NONE. Case-insensitive.
+    static uint8_t encode(char c);
+
+    // Packed code -> character, or '\0' if the code is not in the table.
+    static char decode(uint8_t code);
+
+    // Writes the ".-" pattern of a code into out (MAX_ELEMENTS + 1 bytes).
+    // Returns the number of elements written.
+    static uint8_t toPattern(uint8_t code, char* out);
+};
+
+#endif // MORSE_CODEBOOK_H
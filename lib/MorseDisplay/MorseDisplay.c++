@@ -3,96 +3,137 @@
 // --- Constructor (CORRECTED INITIALIZER LIST) ---
 MorseDisplay::MorseDisplay(uint8_t lcdAddress, uint8_t lcdCols, uint8_t lcdRows)
     // Initialize member variables using the new names (lcdCols_, lcdRows_)
-    : lcd(lcdAddress, lcdCols, lcdRows), lcdCols_(lcdCols), lcdRows_(lcdRows) {
+    : lcd(lcdAddress, lcdCols, lcdRows),
+      lcdCols_(lcdCols > LCD_MAX_COLS ? LCD_MAX_COLS : lcdCols),
+      lcdRows_(lcdRows > LCD_MAX_ROWS ? LCD_MAX_ROWS : lcdRows) {
     // Constructor initializes the LiquidCrystal_I2C object
+    memset(frame, ' ', sizeof(frame));
+    memset(shown, ' ', sizeof(shown));
 }
 
 // --- Initialization ---
 void MorseDisplay::begin() {
-    lcd.init();
+    lcd.init(); // Leaves the LCD blank, matching 'shown'
     lcd.backlight();
     showStartupMessage();
+    flush(true);
     delay(2000);
     clearAll();
 }
 
-// --- Internal Helper: Clears one line ---
-void MorseDisplay::clearLine(uint8_t line) {
-    lcd.setCursor(0, line);
-    // Use the corrected member variable: lcdCols_
-    for (uint8_t i = 0; i < lcdCols_; ++i) {
-        lcd.print(' ');
-    }
+// --- Internal Helper: Fills one framebuffer row, padding with spaces ---
+void MorseDisplay::writeRow(uint8_t row, const char* text) {
+    if (row >= lcdRows_) return;
+    uint8_t col = 0;
+    while (col < lcdCols_ && *text) frame[row][col++] = *text++;
+    while (col < lcdCols_) frame[row][col++] = ' ';
+}
+
+void MorseDisplay::writeRow(uint8_t row, const __FlashStringHelper* label, const char* value) {
+    if (row >= lcdRows_) return;
+    PGM_P p = reinterpret_cast<PGM_P>(label);
+    uint8_t col = 0;
+    char c;
+    while (col < lcdCols_ && (c = pgm_read_byte(p++)) != '\0') frame[row][col++] = c;
+    while (col < lcdCols_ && value && *value) frame[row][col++] = *value++;
+    while (col < lcdCols_) frame[row][col++] = ' ';
 }
 
-// --- Internal Helper: Shifts Line 0 left if it gets too long ---
-void MorseDisplay::shiftLine0Left() {
-    // Use the corrected member variable: lcdCols_
-    if (line0Buffer.length() > lcdCols_) {
-        // Keep only the latest lcdCols_ characters
-        line0Buffer = line0Buffer.substring(line0Buffer.length() - lcdCols_);
-        
-        // Redraw the entire line from the buffer
-        lcd.setCursor(0, 0);
-        lcd.print(line0Buffer);
+// --- Internal Helper: Draws the visible window of the history on Line 0 ---
+void MorseDisplay::renderHistory() {
+    for (uint8_t col = 0; col < lcdCols_; ++col) {
+        frame[0][col] = (col < historyLength) ? history[(historyStart + col) % lcdCols_] : ' ';
     }
 }
 
+void MorseDisplay::moveCursor(uint8_t col, uint8_t row) {
+    if (row == cursorRow && col == cursorCol) return;
+    lcd.setCursor(col, row);
+    lastFlushLcdBytes++;
+    cursorRow = row;
+    cursorCol = col;
+}
+
 // --- Public Display Functions ---
 
 void MorseDisplay::showStartupMessage() {
-    lcd.clear();
-    lcd.setCursor(0, 0);
-    lcd.print(F("Morse Bridge V1.1"));
-    lcd.setCursor(0, 1);
-    lcd.print(F("Initializing..."));
+    writeRow(0, F("Morse Bridge V1.1"), nullptr);
+    writeRow(1, F("Initializing..."), nullptr);
 }
 
 void MorseDisplay::clearAll() {
-    lcd.clear();
-    line0Buffer = "";
-    line1Buffer = "";
+    historyStart = 0;
+    historyLength = 0;
+    memset(frame, ' ', sizeof(frame));
     setStatus(F("Ready"));
 }
 
-void MorseDisplay::setStatus(const String& status) {
-    line1Buffer = status;
-    clearLine(1);
-    lcd.setCursor(0, 1);
-    lcd.print(line1Buffer);
+void MorseDisplay::setStatus(const char* status) {
+    writeRow(1, status);
 }
 
-void MorseDisplay::updateInputSequence(const String& sequence) {
-    // String concatenation fix applied here
-    line1Buffer = String(F("Input: ")) + sequence; 
-    
-    // Use the corrected member variable: lcdCols_
-    if (line1Buffer.length() > lcdCols_) {
-        line1Buffer = line1Buffer.substring(0, lcdCols_);
-    }
-    
-    clearLine(1);
-    lcd.setCursor(0, 1);
-    lcd.print(line1Buffer);
+void MorseDisplay::setStatus(const __FlashStringHelper* status) {
+    writeRow(1, status, nullptr);
+}
+
+void MorseDisplay::setStatus(const __FlashStringHelper* label, const char* value) {
+    writeRow(1, label, value);
+}
+
+void MorseDisplay::updateInputSequence(const char* sequence) {
+    setStatus(F("Input: "), sequence);
 }
 
 void MorseDisplay::appendDecodedCharacter(char c) {
-    if (c == ' ') {
-        line0Buffer += ' ';
+    c = (c == ' ') ? ' ' : (char)toupper(c);
+    if (historyLength < lcdCols_) {
+        history[historyLength++] = c;
     } else {
-        line0Buffer += toupper(c);
+        // Full: overwrite the oldest character and scroll the view by one
+        history[historyStart] = c;
+        historyStart = (historyStart + 1) % lcdCols_;
     }
+    renderHistory();
+}
 
-    shiftLine0Left(); // Handle overflow
-    
-    // Display only the appended character to reduce flicker
-    // Use the corrected member variable: lcdCols_
-    if (line0Buffer.length() <= lcdCols_) {
-        lcd.setCursor(line0Buffer.length() - 1, 0);
-        lcd.print(line0Buffer.charAt(line0Buffer.length() - 1));
-    } else {
-        // If we shifted, redraw the whole line
-        lcd.setCursor(0, 0);
-        lcd.print(line0Buffer);
+void MorseDisplay::flush(bool force) {
+    unsigned long now = millis();
+    if (!force && !flushPending && now - lastFlushTime < DISPLAY_FLUSH_INTERVAL_MS) return;
+    if (!flushPending) lastFlushTime = now;
+
+    uint8_t budget = force ? 0xFF : DISPLAY_FLUSH_BUDGET;
+    lastFlushLcdBytes = 0;
+    flushPending = false;
+    for (uint8_t row = 0; row < lcdRows_; ++row) {
+        uint8_t col = 0;
+        while (col < lcdCols_) {
+            if (frame[row][col] == shown[row][col]) { col++; continue; }
+
+            // Send the run of changed cells after one cursor move, as far
+            // as the budget goes (a move without a cell after it is wasted)
+            bool move = (row != cursorRow || col != cursorCol);
+            if (lastFlushLcdBytes + move >= budget) { flushPending = true; break; }
+            moveCursor(col, row);
+            while (col < lcdCols_ && frame[row][col] != shown[row][col] &&
+                   lastFlushLcdBytes < budget) {
+                lcd.write((uint8_t)frame[row][col]);
+                shown[row][col] = frame[row][col];
+                lastFlushLcdBytes++;
+                col++;
+            }
+            cursorCol = col; // The LCD auto-increments its address
+        }
+        if (flushPending) break;
     }
-}
\ No newline at end of file
+
+    if (lastFlushLcdBytes) {
+        lcdBytesTotal += lastFlushLcdBytes;
+        flushCount++;
+    }
+}
+
+void MorseDisplay::resetStats() {
+    lcdBytesTotal = 0;
+    lastFlushLcdBytes = 0;
+    flushCount = 0;
+}
@@ -4,6 +4,23 @@
 #include <Arduino.h>
 #include <LiquidCrystal_I2C.h>
 
+// Largest LCD supported (buffers are sized for it, the real size is runtime).
+// Both units have a 16x2 (LCD_COLS/LCD_ROWS in Config.h); every extra cell
+// costs 3 bytes of RAM, so raise these only for a bigger panel.
+const uint8_t LCD_MAX_COLS = 16;
+const uint8_t LCD_MAX_ROWS = 2;
+
+// Writes only touch RAM; flush() pushes the changes out at most this often
+const unsigned long DISPLAY_FLUSH_INTERVAL_MS = 50;
+// ...and sends at most this many LCD bytes (cursor moves included) per call,
+// about 1.1 ms each. The rest goes out on the next calls, without waiting
+// out the interval, so a full 16x2 redraw spreads over ~9 loop()s.
+const uint8_t DISPLAY_FLUSH_BUDGET = 4;
+
+// Each LCD byte goes out as two nibbles, each nibble as three PCF8574 writes
+// (data, EN high, EN low), each write as address + data on the bus.
+const uint8_t LCD_I2C_BYTES_PER_LCD_BYTE = 12;
+
 class MorseDisplay {
 private:
     LiquidCrystal_I2C lcd;
@@ -12,12 +29,30 @@ private:
     const uint8_t lcdCols_;
     const uint8_t lcdRows_;
 
-    // We will use two separate strings to manage the content of the two lines
-    String line0Buffer; // Decoded/Sent Message
-    String line1Buffer; // Current Input/Status
+    // Shadow framebuffer: 'frame' is what we want on screen, 'shown' is what
+    // the LCD currently holds. flush() sends only the cells that differ.
+    char frame[LCD_MAX_ROWS][LCD_MAX_COLS];
+    char shown[LCD_MAX_ROWS][LCD_MAX_COLS];
+    uint8_t cursorRow = 0xFF;  // Where the LCD's address counter points
+    uint8_t cursorCol = 0xFF;  // (0xFF = unknown)
+    unsigned long lastFlushTime = 0;
+    bool flushPending = false; // The last flush() ran out of budget
+
+    // Line 0 message history, scrolled by moving the view start rather than
+    // copying: the newest character overwrites the oldest slot.
+    char history[LCD_MAX_COLS];
+    uint8_t historyStart = 0;
+    uint8_t historyLength = 0;
 
-    void clearLine(uint8_t line);
-    void shiftLine0Left();
+    // Statistics (bytes sent to the LCD controller)
+    unsigned long lcdBytesTotal = 0;
+    uint16_t lastFlushLcdBytes = 0;
+    unsigned long flushCount = 0;
+
+    void writeRow(uint8_t row, const char* text);
+    void writeRow(uint8_t row, const __FlashStringHelper* label, const char* value);
+    void renderHistory();
+    void moveCursor(uint8_t col, uint8_t row);
 
 public:
     // Constructor initializes the LCD object and dimensions
@@ -28,16 +63,38 @@ public:
 
     // Core Display Methods
     void showStartupMessage();
-    void setStatus(const String& status);
+    void setStatus(const char* status);
+    void setStatus(const __FlashStringHelper* status);
+    // Label from flash followed by a value, e.g. setStatus(F("Msg: "), text)
+    void setStatus(const __FlashStringHelper* label, const char* value);
     
     // Updates Line 1 with the current sequence (e.g., ".-.")
-    void updateInputSequence(const String& sequence);
+    void updateInputSequence(const char* sequence);
 
     // Appends a character to the final message (Line 0)
     void appendDecodedCharacter(char c);
 
     // Clears the message history (Line 0) and the input status (Line 1)
     void clearAll();
+
+    /**
+     * @brief Sends changed cells to the LCD, batching runs of adjacent cells
+     * behind a single cursor move. Call every loop(); it rate-limits itself
+     * and stops after DISPLAY_FLUSH_BUDGET bytes, carrying the rest over.
+     * @param force Flush everything now, e.g. right before a blocking delay().
+     */
+    void flush(bool force = false);
+
+    // I2C traffic counters, for checking how much an update costs
+    unsigned long getI2CBytesTotal() const { return lcdBytesTotal * LCD_I2C_BYTES_PER_LCD_BYTE; }
+    uint16_t getLastFlushI2CBytes() const { return lastFlushLcdBytes * LCD_I2C_BYTES_PER_LCD_BYTE; }
+    unsigned long getFlushCount() const { return flushCount; }
+    void resetStats();
+
+#if !defined(__AVR__)
+    // Host: the LCD model, to read back what is on screen
+    const LiquidCrystal_I2C& getLcd() const { return lcd; }
+#endif
 };
 
-#endif // MORSE_DISPLAY_H
\ No newline at end of file
+#endif // MORSE_DISPLAY_H
@@ -1,100 +1,161 @@
 #include "MorseReceiver.h"
 #include "MorseDisplay.h" // FIX: Added full class definition
-#include <ctype.h>
-
-// --- MORSE CODE LOOKUP TABLE (Required for decoding the pulses) ---
-const AudioMorseReceiver::MorseCodeEntry morseCodeTable[] = {
-    // Letters 
-    {'A', ".-"},    {'B', "-..."},  {'C', "-.-."},  {'D', "-.."},   {'E', "."},
-    {'F', "..-."},  {'G', "--."},   {'H', "...."},  {'I', ".."},    {'J', ".---"},
-    {'K', "-.-"},   {'L', ".-.."},  {'M', "--"},    {'N', "-."},    {'O', "---"},
-    {'P', ".--."},  {'Q', "--.-"},  {'R', ".-."},   {'S', "..."},   {'T', "-"},
-    {'U', "..-"},   {'V', "...-"},  {'W', ".--"},   {'X', "-..-"},  {'Y', "-.--"},
-    {'Z', "--.."},
-
-    // Numbers
-    {'0', "-----"}, {'1', ".----"}, {'2', "..---"}, {'3', "...--"}, {'4', "....-"},
-    {'5', "....."}, {'6', "-...."}, {'7', "--..."}, {'8', "---.."}, {'9', "----."},
-
-    // Space
-    {' ', " "}
-};
-const int MORSE_TABLE_SIZE_RX = sizeof(morseCodeTable) / sizeof(morseCodeTable[0]);
+#include "DebugLog.h"
+#include "LatencyProfiler.h"
+
+PROFILE_DEFINE(audioUpdateTime, "audio.update");
+
+// --- Sample Ring (filled by the ADC ISR, drained by update()) ---
+namespace {
+const uint8_t AUDIO_RING_MASK = AUDIO_RING_SIZE - 1;
+volatile uint8_t sampleRing[AUDIO_RING_SIZE];
+volatile uint8_t ringHead = 0; // Written by the ISR
+volatile uint8_t ringTail = 0; // Written by update()
+volatile uint16_t sampleOverruns = 0;
+
+inline void storeSample(uint8_t sample) {
+    uint8_t next = (ringHead + 1) & AUDIO_RING_MASK;
+    if (next == ringTail) { sampleOverruns++; return; }
+    sampleRing[ringHead] = sample;
+    ringHead = next;
+}
+}
+
+#if defined(__AVR__)
+// One conversion per Timer1 compare match B; ADLAR gives 8 bits in ADCH.
+ISR(ADC_vect) {
+    TIFR1 = _BV(OCF1B); // Clear the trigger flag so the next match re-arms it
+    storeSample(ADCH);
+}
+#else
+// Host builds have no ADC interrupt: the front end polls analogRead on the
+// sample clock before each update().
+namespace { unsigned long lastSampleUs = 0; }
+
+bool AudioMorseReceiverCore::isSampleDue() {
+    const unsigned long periodUs = 1000000UL / AUDIO_SAMPLE_RATE_HZ;
+    if (micros() - lastSampleUs < periodUs) return false;
+    lastSampleUs += periodUs;
+    return true;
+}
+
+void AudioMorseReceiverCore::pushSample(uint8_t sample) {
+    storeSample(sample);
+}
+#endif
 
 // --- Constructor (FIXED: Use 'display' member variable name) ---
-AudioMorseReceiver::AudioMorseReceiver(int audioPin) 
-    : audioPin(audioPin), display(nullptr) {}
+AudioMorseReceiverCore::AudioMorseReceiverCore(unsigned int startUnitMs)
+    : display(nullptr), speed(startUnitMs) {}
 
 // --- Initialization (FIXED: Use 'display' member variable) ---
-void AudioMorseReceiver::begin(MorseDisplay* displayPtr) {
+void AudioMorseReceiverCore::begin(MorseDisplay* displayPtr, uint8_t adcChannel) {
     display = displayPtr;
-    pinMode(audioPin, INPUT);
-    Serial.println(F("[RX] Audio Receiver Initialized on pin A0."));
+    detector.configure(AUDIO_SAMPLE_RATE_HZ, TONE_FREQUENCY_HZ);
+    startSampling(adcChannel);
+    DEBUG_INFO(F("[RX] Audio Receiver Initialized on pin A")); DEBUG_INFO(adcChannel); DEBUG_INFOLN('.');
     if (display) {
         display->setStatus(F("RX Mode Ready"));
     }
 }
 
-// --- Audio Detection Logic (Unchanged) ---
-bool AudioMorseReceiver::isSignalDetected() {
-    // Read the current sensor value
-    int value = analogRead(audioPin);
+// --- ADC Setup: timer-triggered free-running conversions ---
+// Note: this takes over Timer1 (no PWM on pins 9/10, no Servo library).
+void AudioMorseReceiverCore::startSampling(uint8_t channel) {
+#if defined(__AVR__)
+    noInterrupts();
+    // Timer1 in CTC mode, /8 prescaler, compare match at the sample rate
+    TCCR1A = 0;
+    TCCR1B = _BV(WGM12) | _BV(CS11);
+    OCR1A = F_CPU / 8 / AUDIO_SAMPLE_RATE_HZ - 1;
+    OCR1B = OCR1A;
+    TCNT1 = 0;
+    TIMSK1 = 0;
+    // AVcc reference, left-adjusted result, auto-trigger on Timer1 compare B
+    ADMUX = _BV(REFS0) | _BV(ADLAR) | (channel & 0x07);
+    ADCSRB = _BV(ADTS2) | _BV(ADTS0);
+    ADCSRA = _BV(ADEN) | _BV(ADATE) | _BV(ADIE) | _BV(ADPS2) | _BV(ADPS1); // /64
+    interrupts();
+#else
+    (void)channel; // The host front end reads the pin itself
+    lastSampleUs = micros();
+#endif
+}
 
-    // Simple Threshold Detection (Adjust DECODE_THRESHOLD based on testing)
-    if (value > DECODE_THRESHOLD) {
-        // Signal detected
-        return true;
-    }
-    
-    // No signal detected
-    return false;
+uint16_t AudioMorseReceiverCore::getSampleOverruns() const {
+    noInterrupts();
+    uint16_t count = sampleOverruns;
+    interrupts();
+    return count;
 }
 
-// --- Finds decoded character from sequence (Unchanged) ---
-const char* AudioMorseReceiver::getDecodedChar(const String& sequence) {
-    for (int i = 0; i < MORSE_TABLE_SIZE_RX; ++i) {
-        if (sequence.equals(morseCodeTable[i].sequence)) {
-            return &morseCodeTable[i].character; // Return pointer to the character
-        }
+// --- Copies the next block out of the ring, if one is ready ---
+// Only its first hop is consumed: the rest starts the block after it.
+bool AudioMorseReceiverCore::readBlock(uint8_t* block) {
+    uint8_t available = (ringHead - ringTail) & AUDIO_RING_MASK;
+    if (available < GOERTZEL_BLOCK_SIZE) return false;
+
+    uint8_t tail = ringTail;
+    for (uint8_t i = 0; i < GOERTZEL_BLOCK_SIZE; ++i) {
+        block[i] = sampleRing[(tail + i) & AUDIO_RING_MASK];
     }
-    return nullptr;
+    ringTail = (tail + GOERTZEL_HOP_SIZE) & AUDIO_RING_MASK;
+    return true;
+}
+
+// --- Shows the pulses received so far on the input line ---
+void AudioMorseReceiverCore::showInputSequence(char suffix) {
+    if (!display) return;
+    char pattern[MorseCodebook::MAX_ELEMENTS + 2];
+    uint8_t len = MorseCodebook::toPattern(receivedCode, pattern);
+    pattern[len] = suffix;
+    pattern[len + 1] = '\0';
+    display->updateInputSequence(pattern);
 }
 
 // --- Decodes the current received sequence (FIXED: Use 'display' member variable) ---
-void AudioMorseReceiver::decodeCurrentSequence() {
-    if (receivedSequence.length() == 0) return;
+void AudioMorseReceiverCore::decodeCurrentSequence() {
+    if (receivedCode == MorseCodebook::EMPTY) return;
 
-    const char* decodedCharPtr = getDecodedChar(receivedSequence);
-    char decodedChar = (decodedCharPtr) ? *decodedCharPtr : '?'; // Use '?' for unknown
-    
-    Serial.print(F("[RX DECODE] Seq: "));
-    Serial.print(receivedSequence);
-    Serial.print(F(" -> Char: "));
-    Serial.println(decodedChar);
+    char decodedChar = MorseCodebook::decode(receivedCode);
+    if (!decodedChar) decodedChar = '?'; // Use '?' for unknown
+
+    char pattern[MorseCodebook::MAX_ELEMENTS + 1];
+    MorseCodebook::toPattern(receivedCode, pattern);
+    DEBUG_INFO(F("[RX DECODE] Seq: "));
+    DEBUG_INFO(pattern);
+    DEBUG_INFO(F(" -> Char: "));
+    DEBUG_INFOLN(decodedChar);
+    decodedCount++;
+    lastDecoded = decodedChar;
 
     if (display) {
-        // FIX: The String concatenation F("Decoded: ") + receivedSequence needs the String() cast if used this way
-        String status = String(F("Decoded: ")) + receivedSequence; 
-        display->setStatus(status);
-        delay(100);
+        display->setStatus(F("Decoded: "), pattern);
         display->appendDecodedCharacter(decodedChar);
     }
     
     // Reset sequence after decoding
-    receivedSequence = "";
+    receivedCode = MorseCodebook::EMPTY;
 }
 
-// --- Main Update Loop (Timing and Classification) (FIXED: Use 'display' member variable) ---
-void AudioMorseReceiver::update() {
-    unsigned long currentTime = millis();
-    
-    // Part 1: Sample the input periodically
-    if (currentTime - lastUpdateTime < ANALOG_READ_INTERVAL_MS) {
-        return;
+// --- Main Update Loop: run the detector over every buffered block ---
+void AudioMorseReceiverCore::update() {
+    PROFILE_SCOPE(audioUpdateTime);
+    uint8_t block[GOERTZEL_BLOCK_SIZE];
+    while (readBlock(block)) {
+        bool signalNow = detector.processBlock(block, GOERTZEL_BLOCK_SIZE);
+
+        // Advance the sample clock by one hop
+        signalTimeRemainderUs += GOERTZEL_HOP_US;
+        signalTimeMs += signalTimeRemainderUs / 1000;
+        signalTimeRemainderUs %= 1000;
+
+        processSignal(signalNow, signalTimeMs);
     }
-    lastUpdateTime = currentTime;
-    
-    bool signalNow = isSignalDetected();
+}
+
+// --- Timing and Classification (FIXED: Use 'display' member variable) ---
+void AudioMorseReceiverCore::processSignal(bool signalNow, unsigned long currentTime) {
 
     // --- State Transition: Tone START ---
     if (signalNow && !isTonePresent) {
@@ -102,10 +163,11 @@ void AudioMorseReceiver::update() {
         isTonePresent = true;
         toneStartTime = currentTime;
         gapStartTime = 0; // Reset gap timer
+        wordGapPending = false;
+        if (lastToneEndTime > 0) speed.addGap(currentTime - lastToneEndTime);
 
-        Serial.println(F("Tone ON!"));
-        // FIXED: Use 'display'
-        if (display) display->updateInputSequence(receivedSequence + "!"); // Visual cue
+        DEBUG_TRACELN(F("Tone ON!"));
+        showInputSequence('!'); // Visual cue
     }
     
     // --- State Transition: Tone END (Pulse classification) ---
@@ -116,27 +178,30 @@ void AudioMorseReceiver::update() {
 
         char signalType = 0;
 
-        if (pulseDuration >= DASH_MIN_MS) {
-            signalType = '-'; // Dash
-        } else if (pulseDuration >= DOT_MIN_MS && pulseDuration <= DOT_MAX_MS) {
-            signalType = '.'; // Dot
+        if (!speed.isGlitch(pulseDuration)) {
+            signalType = speed.classifyMark(pulseDuration) ? '-' : '.';
+            lastToneEndTime = currentTime;
         }
         
         if (signalType) {
-            receivedSequence += signalType;
-            Serial.print(F("[RX PULSE] Duration: "));
-            Serial.print(pulseDuration);
-            Serial.print(F("ms -> "));
-            Serial.println(signalType);
+            if (!MorseCodebook::append(receivedCode, signalType == '-')) {
+                DEBUG_WARNLN(F("[RX] Too many elements for one character"));
+            }
+            DEBUG_TRACE(F("[RX PULSE] Duration: "));
+            DEBUG_TRACE(pulseDuration);
+            DEBUG_TRACE(F("ms -> "));
+            DEBUG_TRACE(signalType);
+            DEBUG_TRACE(F(" (unit "));
+            DEBUG_TRACE(speed.getUnitMs());
+            DEBUG_TRACELN(F("ms)"));
         } else {
-             Serial.print(F("[RX PULSE] Duration: "));
-             Serial.print(pulseDuration);
-             Serial.println(F("ms -> UNCLASSIFIED (Ignored)"));
+             DEBUG_TRACE(F("[RX PULSE] Duration: "));
+             DEBUG_TRACE(pulseDuration);
+             DEBUG_TRACELN(F("ms -> UNCLASSIFIED (Ignored)"));
         }
         
         gapStartTime = currentTime; // Start the gap timer
-        // FIXED: Use 'display'
-        if (display) display->updateInputSequence(receivedSequence);
+        showInputSequence('\0');
     }
     
     // --- Part 2: Character Gap Timeout Check ---
@@ -144,12 +209,23 @@ void AudioMorseReceiver::update() {
         // No tone, and we are currently in a gap
         unsigned long gapDuration = currentTime - gapStartTime;
         
-        if (gapDuration >= CHAR_GAP_MS_RX) {
+        if (gapDuration >= speed.getCharGapThresholdMs()) {
             // Gap is long enough to signify the end of a character
             decodeCurrentSequence();
             gapStartTime = 0; // Reset gap timer
+            wordGapPending = true;
             // FIXED: Use 'display'
             if (display) display->setStatus(F("RX Char Decoded"));
         }
     }
+
+    // --- Part 3: Word Gap Check (infers the space) ---
+    else if (!signalNow && wordGapPending &&
+             currentTime - lastToneEndTime >= speed.getWordGapThresholdMs()) {
+        wordGapPending = false;
+        DEBUG_INFOLN(F("[RX DECODE] Word gap -> ' '"));
+        decodedCount++;
+        lastDecoded = ' ';
+        if (display) display->appendDecodedCharacter(' ');
+    }
 }
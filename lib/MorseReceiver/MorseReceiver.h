@@ -2,56 +2,145 @@
 #define AUDIO_MORSE_RECEIVER_H
 
 #include <Arduino.h>
+#include "MorseCodebook.h"
+#include "ToneDetector.h"
+#include "MorseSpeedTracker.h"
+#include "FastPin.h"
 
 // Forward declaration of the MorseDisplay class (so the receiver can output)
 class MorseDisplay; 
 
-// --- TIMING CONSTANTS (Uses the same T_UNIT_MS for consistency) ---
+// --- TIMING CONSTANTS ---
+// Only the starting point: dot/dash and gap thresholds follow the sender's
+// speed from there (see MorseSpeedTracker). A build can start elsewhere
+// through AudioMorseReceiverT's StartUnitMs.
 const long T_UNIT_MS_RX = 200; 
-const long DOT_MIN_MS = T_UNIT_MS_RX * 0.5; // Minimum pulse length for a dot
-const long DOT_MAX_MS = T_UNIT_MS_RX * 2;   // Maximum pulse length for a dot
-
-const long DASH_MIN_MS = T_UNIT_MS_RX * 2.5; // Minimum pulse length for a dash
-const long CHAR_GAP_MS_RX = T_UNIT_MS_RX * 5; // Time to wait to decode a full character
 
 // --- AUDIO DETECTION CONSTANTS ---
-const int ANALOG_READ_INTERVAL_MS = 10; // How often to sample the microphone
-const int NOISE_FLOOR = 30;             // Minimum change in reading to confirm signal (out of 1024)
-const int DECODE_THRESHOLD = 200;       // Analog value threshold for sound detection (adjust based on mic/noise)
+// The ADC free-runs off Timer1 (AVR) and an ISR drops 8-bit samples into a
+// ring buffer. update() runs a Goertzel filter over the latest block every
+// GOERTZEL_HOP_SIZE samples, so edges are timed by the sample clock rather
+// than by loop() speed. Blocks overlap by three quarters: an edge is placed
+// to within one hop (2 ms) instead of one block (8 ms), for four times the
+// filter work.
+const uint16_t AUDIO_SAMPLE_RATE_HZ = 4000;
+const uint16_t TONE_FREQUENCY_HZ = 700;  // Sidetone/buzzer pitch to listen for
+const uint8_t GOERTZEL_BLOCK_SIZE = 32;  // Samples per detection block (8 ms, a 125 Hz bin)
+const uint8_t GOERTZEL_HOP_SIZE = GOERTZEL_BLOCK_SIZE / 4; // New samples per block
+const unsigned long GOERTZEL_HOP_US = 1000000UL * GOERTZEL_HOP_SIZE / AUDIO_SAMPLE_RATE_HZ;
+const uint8_t AUDIO_RING_SIZE = 128;     // Power of two; ~24 ms of slack for loop()
 
 // --- CLASS DEFINITION ---
-class AudioMorseReceiver {
-public:
-    // Structure for the Morse Code Lookup Table (Duplicated for decoding locally)
-    struct MorseCodeEntry {
-        char character;
-        const char* sequence;
-    };
-
+/**
+ * @brief Tone detection and decoding, without the pin.
+ *
+ * The front end picks the input: AudioMorseReceiverT (pin fixed at compile
+ * time) or, on the host, AudioMorseReceiver (pin at run time). On the AVR
+ * the ADC ISR does the sampling; on the host the front end feeds samples
+ * on the sample clock before each update().
+ */
+class AudioMorseReceiverCore {
 private:
-    int audioPin;
     MorseDisplay* display;
     
-    // State Management for Pulse Detection
+    ToneDetector detector;
+    MorseSpeedTracker speed;
+
+    // State Management for Pulse Detection (times are on the sample clock)
     bool isTonePresent = false;
     unsigned long toneStartTime = 0;
     unsigned long gapStartTime = 0;
-    unsigned long lastUpdateTime = 0;
+    unsigned long lastToneEndTime = 0;   // End of the last real (non-glitch) pulse
+    bool wordGapPending = false;         // A char was decoded, no space inferred yet
+    unsigned long signalTimeMs = 0;      // Sample clock, advanced per hop
+    unsigned int signalTimeRemainderUs = 0;
     
-    String receivedSequence = "";
+    uint8_t receivedCode = MorseCodebook::EMPTY; // Packed pulses of the current char
+    uint16_t decodedCount = 0;           // Characters and word spaces decoded...
+    char lastDecoded = '\0';             // ...and the latest of them
     
     // Internal Helpers
-    bool isSignalDetected();
+    void startSampling(uint8_t adcChannel);
+    bool readBlock(uint8_t* block);
+    void processSignal(bool signalNow, unsigned long currentTime);
     void decodeCurrentSequence();
-    const char* getDecodedChar(const String& sequence);
+    void showInputSequence(char suffix);
 
-public:
-    // Constructor
-    AudioMorseReceiver(int audioPin);
+protected:
+    explicit AudioMorseReceiverCore(unsigned int startUnitMs = T_UNIT_MS_RX);
 
-    // Core Functions
-    void begin(MorseDisplay* displayPtr);
+    // adcChannel: the pin's ADC input (0 for A0)
+    void begin(MorseDisplay* displayPtr, uint8_t adcChannel);
+#if !defined(__AVR__)
+    // Host sampling: true once per sample period, then pushSample() it
+    static bool isSampleDue();
+    static void pushSample(uint8_t sample);
+#endif
+    // Decodes every full block sampled so far (the front end's update())
     void update();
+
+public:
+    // Current estimate of the sender's speed, for logging
+    unsigned int getUnitEstimateMs() const { return speed.getUnitMs(); }
+    unsigned int getWpmEstimate() const { return speed.getWpm(); }
+
+    // Samples dropped because update() fell more than a ring behind
+    uint16_t getSampleOverruns() const;
+
+    // Characters decoded so far ('?' if unknown, ' ' for a word gap), and
+    // the latest. A hop decodes at most one, so polling after each
+    // sample's update() sees them all.
+    uint16_t getDecodedCount() const { return decodedCount; }
+    char getLastDecoded() const { return lastDecoded; }
+};
+
+// ADC input of an analog pin given as A0-A5 or as 0-5
+inline uint8_t audioChannelOf(int pin) { return (pin >= A0) ? pin - A0 : pin; }
+
+/**
+ * @brief The receiver on an analog pin fixed at compile time.
+ *
+ * StartUnitMs is the unit the speed tracker assumes until the sender's
+ * first marks have been timed.
+ */
+template <int AudioPin, long StartUnitMs = T_UNIT_MS_RX>
+class AudioMorseReceiverT : public AudioMorseReceiverCore {
+public:
+    AudioMorseReceiverT() : AudioMorseReceiverCore(StartUnitMs) {}
+
+    void begin(MorseDisplay* displayPtr) {
+        pinMode(AudioPin, INPUT);
+        AudioMorseReceiverCore::begin(displayPtr, audioChannelOf(AudioPin));
+    }
+
+    // Call on every loop()
+    void update() {
+#if !defined(__AVR__)
+        while (isSampleDue()) pushSample(analogRead(AudioPin) >> 2);
+#endif
+        AudioMorseReceiverCore::update();
+    }
+};
+
+#if !defined(__AVR__)
+// Host: the same with the pin chosen at run time
+class AudioMorseReceiver : public AudioMorseReceiverCore {
+private:
+    int audioPin;
+
+public:
+    explicit AudioMorseReceiver(int audioPin) : audioPin(audioPin) {}
+
+    void begin(MorseDisplay* displayPtr) {
+        pinMode(audioPin, INPUT);
+        AudioMorseReceiverCore::begin(displayPtr, audioChannelOf(audioPin));
+    }
+
+    void update() {
+        while (isSampleDue()) pushSample(analogRead(audioPin) >> 2);
+        AudioMorseReceiverCore::update();
+    }
 };
+#endif
 
 #endif // AUDIO_MORSE_RECEIVER_H
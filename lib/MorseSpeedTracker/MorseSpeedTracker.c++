@@ -0,0 +1,105 @@
+#include "MorseSpeedTracker.h"
+
+MorseSpeedTracker::MorseSpeedTracker(unsigned int initialUnitMs) {
+    reset(initialUnitMs);
+}
+
+void MorseSpeedTracker::reset(unsigned int unitMs) {
+    dotMs = unitMs;
+    dashMs = unitMs * 3;
+    elementGapMs = unitMs;
+    charGapMs = unitMs * 3;
+    lastMarkMs = 0;
+    seeded = false;
+    gapSamples = 0;
+    clamp();
+}
+
+unsigned int MorseSpeedTracker::track(unsigned int centre, unsigned long sample, uint8_t shift) {
+    long delta = (long)sample - (long)centre;
+    return (unsigned int)((long)centre + delta / (1L << shift));
+}
+
+// Keeps the centres in range and in the right order
+void MorseSpeedTracker::clamp() {
+    if (dotMs < MIN_UNIT_MS) dotMs = MIN_UNIT_MS;
+    if (dotMs > MAX_UNIT_MS) dotMs = MAX_UNIT_MS;
+    if (dashMs < dotMs * 2) dashMs = dotMs * 2;
+    if (dashMs > dotMs * 5) dashMs = dotMs * 5;
+    if (elementGapMs < MIN_UNIT_MS) elementGapMs = MIN_UNIT_MS;
+    if (elementGapMs > MAX_UNIT_MS) elementGapMs = MAX_UNIT_MS;
+    if (charGapMs < elementGapMs * 2) charGapMs = elementGapMs * 2;
+    if (charGapMs > elementGapMs * 5) charGapMs = elementGapMs * 5;
+}
+
+// First mark after a reset: it is classified against the guessed unit, then
+// sets its own cluster outright and the other one at 1:3
+void MorseSpeedTracker::seed(unsigned long markMs) {
+    if (markMs >= getDashThresholdMs()) {
+        dashMs = markMs;
+        dotMs = markMs / 3;
+    } else {
+        dotMs = markMs;
+        dashMs = markMs * 3;
+    }
+    seeded = true;
+}
+
+bool MorseSpeedTracker::classifyMark(unsigned long markMs) {
+    bool dash;
+    if (!seeded) {
+        dash = markMs >= getDashThresholdMs();
+        seed(markMs);
+    } else if (lastMarkMs && markMs >= 2UL * lastMarkMs) {
+        // A clear short/long pair re-anchors both clusters at once. This is
+        // what lets the tracker follow a big speed change within a character.
+        dash = true;
+        dotMs = track(dotMs, lastMarkMs, 1);
+        dashMs = track(dashMs, markMs, 1);
+    } else if (lastMarkMs && lastMarkMs >= 2UL * markMs) {
+        dash = false;
+        dotMs = track(dotMs, markMs, 1);
+        dashMs = track(dashMs, lastMarkMs, 1);
+    } else {
+        dash = markMs >= getDashThresholdMs();
+        if (dash) {
+            dashMs = track(dashMs, markMs, SPEED_TRACK_SHIFT);
+            dotMs = track(dotMs, dashMs / 3, SPEED_COUPLE_SHIFT);
+        } else {
+            dotMs = track(dotMs, markMs, SPEED_TRACK_SHIFT);
+            dashMs = track(dashMs, dotMs * 3UL, SPEED_COUPLE_SHIFT);
+        }
+    }
+    lastMarkMs = markMs;
+
+    // Spacing follows keying speed, so the marks (which are unambiguous far
+    // more often) also pull the space clusters toward 1 and 3 units. Until
+    // enough gaps have been seen they are simply taken from the marks.
+    clamp();
+    unsigned int unit = getUnitMs();
+    if (gapSamples < SPEED_GAP_SAMPLES) {
+        elementGapMs = unit;
+        charGapMs = unit * 3;
+    } else {
+        elementGapMs = track(elementGapMs, unit, SPEED_GAP_COUPLE_SHIFT);
+        charGapMs = track(charGapMs, unit * 3UL, SPEED_GAP_COUPLE_SHIFT);
+    }
+    clamp();
+    return dash;
+}
+
+void MorseSpeedTracker::addGap(unsigned long gapMs) {
+    if (gapMs >= getWordGapThresholdMs()) {
+        lastMarkMs = 0; // New word: don't pair marks across it
+        return;
+    }
+    if (gapMs >= getCharGapThresholdMs()) {
+        charGapMs = track(charGapMs, gapMs, SPEED_TRACK_SHIFT);
+        elementGapMs = track(elementGapMs, charGapMs / 3, SPEED_COUPLE_SHIFT);
+    } else {
+        elementGapMs = track(elementGapMs, gapMs, SPEED_TRACK_SHIFT);
+        charGapMs = track(charGapMs, elementGapMs * 3UL, SPEED_COUPLE_SHIFT);
+    }
+    if (gapSamples < SPEED_GAP_SAMPLES) gapSamples++;
+    clamp();
+}
@@ -0,0 +1,77 @@
+#ifndef MORSE_SPEED_TRACKER_H
+#define MORSE_SPEED_TRACKER_H
+
+#include <stdint.h>
+
+// Plain C++ (no Arduino calls) so it can be driven with scripted timings.
+
+// --- SPEED TRACKING CONSTANTS ---
+const unsigned int MIN_UNIT_MS = 20;   // 60 WPM
+const unsigned int MAX_UNIT_MS = 400;  // 3 WPM
+const uint8_t SPEED_TRACK_SHIFT = 2;   // A sample moves its cluster centre by 1/4
+const uint8_t SPEED_COUPLE_SHIFT = 3;  // ...and pulls the other one 1/8 toward 1:3
+const uint8_t SPEED_GAP_COUPLE_SHIFT = 2; // Marks pull the space clusters 1/4 toward 1 and 3 units
+const uint8_t SPEED_GAP_SAMPLES = 4;   // In-word gaps seen before the space clusters are trusted
+
+/**
+ * @brief Online estimate of the sender's Morse speed.
+ *
+ * Keeps two cluster centres for marks (dot ~1 unit, dash ~3 units) and two for
+ * spaces (element gap ~1 unit, character gap ~3 units). Every classified
+ * duration nudges its centre, and the decision thresholds sit halfway between
+ * them, so decoding follows an operator who speeds up or slows down.
+ *
+ * The starting unit is only a guess. The first mark after a reset replaces it
+ * outright, and until SPEED_GAP_SAMPLES gaps have been learned the space
+ * clusters are set from the marks (1 and 3 units) rather than tracked, so a
+ * sender faster than the guess doesn't run the first characters together.
+ */
+class MorseSpeedTracker {
+private:
+    unsigned int dotMs;
+    unsigned int dashMs;
+    unsigned int elementGapMs;
+    unsigned int charGapMs;
+    unsigned int lastMarkMs = 0;
+    bool seeded = false;    // A mark has set the unit since reset()
+    uint8_t gapSamples = 0; // In-word gaps learned, up to SPEED_GAP_SAMPLES
+
+    static unsigned int track(unsigned int centre, unsigned long sample, uint8_t shift);
+    void clamp();
+    void seed(unsigned long markMs);
+
+public:
+    explicit MorseSpeedTracker(unsigned int initialUnitMs);
+
+    // Forgets everything learned and starts again from unitMs.
+    void reset(unsigned int unitMs);
+
+    // True for marks too short to be a real dot (contact bounce, noise spikes).
+    // Before the first mark only the fastest speed we follow is known.
+    bool isGlitch(unsigned long markMs) const { return markMs < (seeded ? dotMs / 3 : MIN_UNIT_MS); }
+
+    /**
+     * @brief Classifies a key-down duration and learns from it.
+     * @return True for a dash, false for a dot.
+     */
+    bool classifyMark(unsigned long markMs);
+
+    /**
+     * @brief Learns from a completed key-up duration (call when the next mark
+     * starts). Word gaps are ignored so pauses don't drag the estimate.
+     */
+    void addGap(unsigned long gapMs);
+
+    // Current unit (dot length) estimate and the matching PARIS speed.
+    unsigned int getUnitMs() const { return (dotMs + dashMs / 3) / 2; }
+    unsigned int getWpm() const { return 1200 / getUnitMs(); }
+
+    // Marks at or above this are dashes.
+    unsigned long getDashThresholdMs() const { return ((unsigned long)dotMs + dashMs) / 2; }
+    // Silence at or above this ends a character...
+    unsigned long getCharGapThresholdMs() const { return ((unsigned long)elementGapMs + charGapMs) / 2; }
+    // ...and at or above this (between 3 and 7 units) ends a word.
+    unsigned long getWordGapThresholdMs() const { return (unsigned long)charGapMs * 5 / 3; }
+};
+
+#endif // MORSE_SPEED_TRACKER_H
@@ -1,257 +1,513 @@
 #include "MorseTransmitter.h"
 #include "MorseDisplay.h" 
+#include "DebugLog.h"
+#include "MacroCatalogue.h"
 #include <Arduino.h>
-#include <ctype.h> 
-
-// --- UPDATED MORSE TABLE ---
-// We added '!' mapped to "..--" for your Duress Code
-const MorseTransmitter::MorseCodeEntry morseCodeTable[] = {
-  {'A', ".-"}, {'B', "-..."}, {'C', "-.-."}, {'D', "-.."},  {'E', "."},
-  {'F', "..-."}, {'G', "--."},  {'H', "...."}, {'I', ".."},  {'J', ".---"},
-  {'K', "-.-"},  {'L', ".-.."}, {'M', "--"},  {'N', "-."},  {'O', "---"},
-  {'P', ".--."}, {'Q', "--.-"}, {'R', ".-."},  {'S', "..."},  {'T', "-"},
-  {'U', "..-"},  {'V', "...-"}, {'W', ".--"},  {'X', "-..-"}, {'Y', "-.--"},
-  {'Z', "--.."},
-  {'0', "-----"}, {'1', ".----"}, {'2', "..---"}, {'3', "...--"}, {'4', "....-"},
-  {'5', "....."}, {'6', "-...."}, {'7', "--..."}, {'8', "---.."}, {'9', "----."},
-  {' ', " "},
-  {'!', "..--"} // <--- NEW: The Duress Code (Not a standard letter)
-};
-const int MORSE_TABLE_SIZE = sizeof(morseCodeTable) / sizeof(morseCodeTable[0]);
 
-MorseTransmitter::MorseTransmitter(int btnPin, int enterBtnPin, int ledP, int buzzerP)
-  : btnPin(btnPin), enterBtnPin(enterBtnPin), ledPin(ledP), buzzerPin(buzzerP), display(nullptr) {}
+static_assert(MacroCatalogue::MAX_EXPANSION <= MESSAGE_BUFFER_LEN,
+              "macro expansions must fit the message buffer");
 
-void MorseTransmitter::begin(MorseDisplay* displayPtr) {
+// FEATURE 2: SILENT DURESS (kept in flash)
+const char DURESS_TRIGGER[] PROGMEM = "!";
+const char DURESS_MESSAGE[] PROGMEM = "!!! HOSTAGE ALERT !!!";
+
+MorseTransmitterCore::MorseTransmitterCore(unsigned int unitMs, unsigned int enterHoldMs)
+  : unitMs(unitMs), enterHoldMs(enterHoldMs), speed(unitMs), display(nullptr) {}
+
+void MorseTransmitterCore::begin(MorseDisplay* displayPtr) {
     display = displayPtr; 
     if (display) display->begin(); 
-
-    pinMode(btnPin, INPUT_PULLUP);
-    if (enterBtnPin != -1) pinMode(enterBtnPin, INPUT_PULLUP);
-    pinMode(ledPin, OUTPUT);
-    if (buzzerPin != -1) pinMode(buzzerPin, OUTPUT);
     
     if (!Serial) Serial.begin(9600);
 
     // Startup Lock
     isLocked = true;
-    Serial.println(F("--- SYSTEM LOCKED ---"));
+    DEBUG_INFOLN(F("--- SYSTEM LOCKED ---"));
     if (display) display->setStatus(F("LOCKED: Enter PW"));
 }
 
-void MorseTransmitter::generateSignal(char type) {
-  long duration;
-  if (type == '.') duration = DOT_DURATION_MS; 
-  else if (type == '-') duration = DASH_DURATION_MS; 
-  else return;
+void MorseTransmitterCore::setKeyerMode(KeyerMode mode, uint8_t wpm) {
+    if (!enterKey.isEnabled()) mode = KEYER_STRAIGHT; // Iambic needs both paddles
+    keyerMode = mode;
+    keyerUnitMs = 1200 / constrain(wpm, IAMBIC_MIN_WPM, IAMBIC_MAX_WPM);
+    elementActive = false;
+    ditMemory = dahMemory = false;
+    ditDown = key.isPressed();
+    dahDown = enterKey.isPressed();
+}
+
+// Queues a single element ('.' or '-') as sidetone for the manual key.
+void MorseTransmitterCore::generateSignal(char type) {
+  if (type != '.' && type != '-') return;
+  txQueue.push(type);
+}
+
+// Shows a status for ms, then next. tick() makes the swap, so the keys and
+// the radio keep being served meanwhile (these used to be blocking delays).
+void MorseTransmitterCore::showStatusFor(const __FlashStringHelper* status, unsigned long ms,
+                                         const __FlashStringHelper* next) {
+  if (!display) return;
+  display->setStatus(status);
+  nextStatus = next;
+  statusUntil = millis() + ms;
+}
+
+const __FlashStringHelper* MorseTransmitterCore::idleStatusText() const {
+  return idleStatus ? idleStatus : F("Ready");
+}
+
+void MorseTransmitterCore::updateStatus(unsigned long now) {
+  if (!nextStatus || (long)(now - statusUntil) < 0) return;
+  display->setStatus(nextStatus);
+  nextStatus = nullptr;
+}
+
+// The front end writes the pins once tick() returns
+void MorseTransmitterCore::setKeyOutput(bool on) {
+  keyOutput = on;
+}
 
-  Serial.print(type); 
+// Duration of the element at the top of playbackCode
+long MorseTransmitterCore::nextElementDuration() const {
+  bool dash = playbackCode & (1 << (playbackElements - 1));
+  return (dash ? 3L : 1L) * unitMs;
+}
 
-  digitalWrite(ledPin, HIGH);
-  if (buzzerPin != -1) digitalWrite(buzzerPin, HIGH);
-  delay(duration);
-  digitalWrite(ledPin, LOW);
-  if (buzzerPin != -1) digitalWrite(buzzerPin, LOW);
-  delay(ELEMENT_GAP_MS);
+void MorseTransmitterCore::beginPlaybackStep(PlaybackState state, long duration, unsigned long now) {
+  playbackState = state;
+  playbackStepStart = now;
+  playbackStepDuration = duration;
+  if (state == PLAYBACK_MARK) {
+    DEBUG_TRACE(duration > (long)unitMs ? '-' : '.');
+    setKeyOutput(true);
+  }
 }
 
-const char* MorseTransmitter::getMorseCode(char c) {
-  c = toupper(c); 
-  for (int i = 0; i < MORSE_TABLE_SIZE; ++i) {
-    if (morseCodeTable[i].character == c) return morseCodeTable[i].sequence;
+// Pops the next queued character and starts keying its first element.
+void MorseTransmitterCore::startNextCharacter(unsigned long now) {
+  char c = '\0';
+  txQueue.pop(c);
+
+  // Sidetone for the manual key: a lone element, no display changes
+  if (c == '.' || c == '-') {
+    playbackCode = MorseCodebook::EMPTY;
+    MorseCodebook::append(playbackCode, c == '-');
+    playbackElements = 1;
+    playbackCharGap = unitMs;
+    beginPlaybackStep(PLAYBACK_MARK, nextElementDuration(), now);
+    return;
+  }
+
+  uint8_t code = MorseCodebook::encode(c);
+  if (code == MorseCodebook::NONE) return; // Unsupported character, skip it
+
+  if (display) {
+    char pattern[MorseCodebook::MAX_ELEMENTS + 1];
+    MorseCodebook::toPattern(code, pattern);
+    display->appendDecodedCharacter(c);
+    display->setStatus(F("RX: "), pattern);
+  }
+
+  playbackCode = code;
+  playbackElements = MorseCodebook::length(code);
+  if (playbackElements == 0) {
+    // Space: no elements, just hold the word gap
+    beginPlaybackStep(PLAYBACK_GAP, 6L * unitMs, now); // Word gap less the element gap
+    return;
+  }
+  playbackCharGap = 3L * unitMs;
+  beginPlaybackStep(PLAYBACK_MARK, nextElementDuration(), now);
+}
+
+bool MorseTransmitterCore::tick() {
+  bool wasDown = keyOutput;
+  updateStatus(millis());
+  advancePlayback();
+  return keyOutput != wasDown;
+}
+
+void MorseTransmitterCore::advancePlayback() {
+  unsigned long currentTime = millis();
+
+  if (playbackState != PLAYBACK_IDLE) {
+    if (currentTime - playbackStepStart < playbackStepDuration) return;
+
+    if (playbackState == PLAYBACK_MARK) {
+      // Mark finished: drop the key and hold the element (or char) gap
+      setKeyOutput(false);
+      playbackElements--;
+      long gap = (playbackElements == 0) ? playbackCharGap : (long)unitMs;
+      beginPlaybackStep(PLAYBACK_GAP, gap, currentTime);
+      return;
+    }
+
+    // Gap finished: next element of the same character, if any
+    if (playbackElements > 0) {
+      beginPlaybackStep(PLAYBACK_MARK, nextElementDuration(), currentTime);
+      return;
+    }
+    playbackState = PLAYBACK_IDLE;
+    if (txQueue.isEmpty() && playbackStatusPending) {
+      DEBUG_TRACELN(F(" [DONE]"));
+      playbackStepStart = currentTime;
+    }
+  }
+
+  if (!txQueue.isEmpty()) {
+    startNextCharacter(currentTime);
+    return;
+  }
+
+  // Idle: put the status line back once the last "RX:" has been seen
+  if (playbackStatusPending && currentTime - playbackStepStart >= PLAYBACK_STATUS_HOLD_MS) {
+    playbackStatusPending = false;
+    if (playbackCut) showStatusFor(F("Playback CUT"), STATUS_LONG_MS, idleStatusText());
+    else if (display) display->setStatus(idleStatusText());
+    playbackCut = false;
   }
-  return nullptr;
 }
 
-void MorseTransmitter::checkUnlock() {
-    if (manualSequence.length() == 0) return;
-    unlockBuffer += manualSequence;
-    Serial.print(F(" [Checking PW] So far: ")); Serial.println(unlockBuffer);
+// A character ended while locked: its elements are already in unlockCode
+void MorseTransmitterCore::checkUnlock() {
+    if (manualCode == MorseCodebook::EMPTY) return;
+    manualCode = MorseCodebook::EMPTY;
+
+    if (unlockLength > PASSCODE_LENGTH) {
+        showStatusFor(F("WRONG PASSCODE"), STATUS_BRIEF_MS, F("LOCKED: Enter PW"));
+        unlockCode = MorseCodebook::EMPTY;
+        unlockLength = 0;
+        return;
+    }
+    DEBUG_TRACE(F(" [Checking PW] So far: ")); DEBUG_TRACE(unlockLength); DEBUG_TRACELN(F(" elements"));
     
-    if (unlockBuffer.equals(PASSCODE)) {
+    if (unlockLength == PASSCODE_LENGTH && unlockCode == PASSCODE) {
         isLocked = false;
-        Serial.println(F("--- ACCESS GRANTED ---"));
-        if (display) {
-            display->clearAll();
-            display->setStatus(F("ACCESS GRANTED"));
-            delay(1000);
-            display->setStatus(F("Ready"));
-        }
-        unlockBuffer = "";
-    } else if (unlockBuffer.length() > PASSCODE.length()) {
-        if (display) display->setStatus(F("WRONG PASSCODE"));
-        delay(500);
-        if (display) display->setStatus(F("LOCKED: Enter PW"));
-        unlockBuffer = "";
+        DEBUG_INFOLN(F("--- ACCESS GRANTED ---"));
+        if (display) display->clearAll();
+        showStatusFor(F("ACCESS GRANTED"), STATUS_LONG_MS, idleStatusText());
+        unlockCode = MorseCodebook::EMPTY;
+        unlockLength = 0;
     }
-    manualSequence = "";
 }
 
 // --- FEATURE 3: MACRO EXPANSION ---
-String MorseTransmitter::expandMacro(String input) {
-    // You can add more codes here!
-    if (input == "S1") return "SECTOR 1 SECURE";
-    if (input == "S2") return "SECTOR 2 COMPROMISED";
-    if (input == "RTB") return "RETURNING TO BASE";
-    if (input == "B9") return "BATTERY CRITICAL";
-    if (input == "73") return "BEST REGARDS";
-    return input; // Return original if no match
+bool MorseTransmitterCore::expandMacro(const char* input, MessageBuffer& out) {
+    // Add codes to lib/MacroCatalogue/macros.txt
+    return MacroCatalogue::expand(input, out);
 }
 
-void MorseTransmitter::processText(const String& text) {
-  Serial.print(F("[TX] Playing: '")); Serial.print(text); Serial.print(F("' -> "));
+bool MorseTransmitterCore::processText(const char* text) {
+  DEBUG_INFO(F("[TX] Playing: '")); DEBUG_INFO(text); DEBUG_INFOLN('\'');
+  nextStatus = nullptr; // Playback takes the status line over
   if (display) {
       display->clearAll();
       display->setStatus(F("RX Mode..."));
   }
-  for (unsigned int i = 0; i < text.length(); ++i) {
-    char c = text[i];
-    const char* morseSeq = getMorseCode(c);
-    if (morseSeq) {
-        if (display) {
-             display->appendDecodedCharacter(c);
-             String txStatus = F("RX: "); txStatus += morseSeq;
-             display->setStatus(txStatus);
-        }
-        for (int j = 0; morseSeq[j] != '\0'; ++j) generateSignal(morseSeq[j]); 
-        Serial.print(" "); 
-        if (c != ' ') delay(CHAR_GAP_MS - ELEMENT_GAP_MS); 
-        else delay(WORD_GAP_MS - ELEMENT_GAP_MS);
-    }
+  bool queuedAll = true;
+  for (; *text; ++text) {
+    if (!txQueue.push(*text)) { queuedAll = false; break; }
   }
-  Serial.println(F(" [DONE]"));
-  if (display) { delay(1000); display->setStatus(F("Ready")); }
+  if (!queuedAll) {
+    DEBUG_WARNLN(F("[TX QUEUE FULL]"));
+    playbackCut = true;
+  }
+  playbackStatusPending = true;
+  return queuedAll;
 }
 
-void MorseTransmitter::decodeCurrentSequence() {
+void MorseTransmitterCore::decodeCurrentSequence() {
   if (isLocked) { checkUnlock(); return; }
 
-  if (manualSequence.length() == 0) return;
-  Serial.print(F(" -> Seq: ")); Serial.print(manualSequence);
-  if (manualSequence.startsWith("......")) {
-      Serial.println(F(" -> [CMD] CLEAR BUFFER"));
-      decodedMessageBuffer = ""; // Wipe the memory
-      manualSequence = "";       // Wipe the current sequence
+  uint8_t len = MorseCodebook::length(manualCode);
+  if (len == 0) return;
+  char pattern[MorseCodebook::MAX_ELEMENTS + 1];
+  MorseCodebook::toPattern(manualCode, pattern);
+  DEBUG_INFO(F(" -> Seq: ")); DEBUG_INFO(pattern);
+  // Six (or more) leading dots wipe the message
+  if (len >= 6 && (manualCode >> (len - 6)) == MorseCodebook::pack("......")) {
+      DEBUG_INFOLN(F(" -> [CMD] CLEAR BUFFER"));
+      decodedMessageBuffer.clear(); // Wipe the memory
+      manualCode = MorseCodebook::EMPTY; // Wipe the current sequence
       
-      if (display) {
-          display->setStatus(F("CLEARED!"));
-          delay(1000);
-          display->clearAll();
-          display->setStatus(F("Ready"));
-      }
+      if (display) display->clearAll();
+      showStatusFor(F("CLEARED!"), STATUS_LONG_MS, idleStatusText());
+      return;
+  }
+  // AR sends the message when the Enter button is a paddle
+  if (keyerMode != KEYER_STRAIGHT && manualCode == MorseCodebook::pack(".-.-.")) {
+      DEBUG_INFOLN(F(" -> [CMD] SEND"));
+      manualCode = MorseCodebook::EMPTY;
+      sendRequested = true;
       return;
   }
-  for (int i = 0; i < MORSE_TABLE_SIZE; ++i) {
-    if (manualSequence.equals(morseCodeTable[i].sequence)) {
-      char decodedChar = morseCodeTable[i].character;
-      Serial.print(F(" -> Char: ")); Serial.println(decodedChar);
+  char decodedChar = MorseCodebook::decode(manualCode);
+  manualCode = MorseCodebook::EMPTY;
+  if (decodedChar) {
+      DEBUG_INFO(F(" -> Char: ")); DEBUG_INFOLN(decodedChar);
       
       if (display) display->appendDecodedCharacter(decodedChar);
-      decodedMessageBuffer += decodedChar;
+      decodedMessageBuffer.append(decodedChar);
       
-      manualSequence = "";
-      if (display) display->setStatus(String(F("Msg: ")) + decodedMessageBuffer);
+      if (display) display->setStatus(F("Msg: "), decodedMessageBuffer.c_str());
       return;
-    }
   }
-  Serial.println(F(" -> UNKNOWN"));
+  DEBUG_INFOLN(F(" -> UNKNOWN"));
   if (display) display->setStatus(F("Unknown Char"));
-  manualSequence = "";
 }
 
-String MorseTransmitter::update() {
-  unsigned long currentTime = millis();
-  String messageToSend = ""; 
-
-  // --- 1. HANDLE MORSE BUTTON ---
-  int reading = digitalRead(btnPin);
-  if (reading == LOW && lastButtonState == HIGH) { pressStartTime = currentTime; } 
-  else if (reading == HIGH && lastButtonState == LOW) { 
-    unsigned long pressDuration = currentTime - pressStartTime;
-    char signalType = 0;
-    
-    if (pressDuration > 50) {
-        if (pressDuration <= MAX_DOT_DURATION_MS) signalType = '.';
-        else signalType = '-';
-        
-        Serial.print(F("[DEBUG] ")); Serial.print(pressDuration);
-        Serial.print(F("ms -> ")); Serial.println(signalType);
-        
-        if (signalType) {
-          manualSequence += signalType;
-          generateSignal(signalType); 
-          lastActivityTime = currentTime; 
-          if (display && !isLocked) display->updateInputSequence(manualSequence);
-        }
+// Records one keyed element; markEndUs is when its mark ends
+void MorseTransmitterCore::addElement(bool dash, unsigned long markEndUs) {
+  bool fits = MorseCodebook::append(manualCode, dash);
+  if (isLocked) {
+    if (unlockLength <= PASSCODE_LENGTH) {
+      unlockCode = (unlockCode << 1) | (dash ? 1 : 0);
+      unlockLength++;
     }
+  } else {
+    nextStatus = nullptr; // Keying takes the status line over
+    if (!fits) DEBUG_WARNLN(F(" [TX] Too many elements for one character"));
   }
-  lastButtonState = reading;
+  generateSignal(dash ? '-' : '.');
+#if !defined(__AVR__)
+  keyedElements++;
+  recentDashes = (recentDashes << 1) | (dash ? 1 : 0);
+#endif
+  lastActivityUs = markEndUs;
+  lastReleaseUs = markEndUs;
+  if (display && !isLocked) {
+    char pattern[MorseCodebook::MAX_ELEMENTS + 1];
+    MorseCodebook::toPattern(manualCode, pattern);
+    display->updateInputSequence(pattern);
+  }
+}
 
-  if (reading == HIGH && manualSequence.length() > 0 && lastActivityTime > 0) {
-    if (currentTime - lastActivityTime >= DECODE_TIMEOUT_MS) {
-      decodeCurrentSequence(); lastActivityTime = 0; 
+unsigned long MorseTransmitterCore::charGapThresholdMs() const {
+  if (keyerMode == KEYER_STRAIGHT) return speed.getCharGapThresholdMs();
+  return (unsigned long)IAMBIC_CHAR_GAP_UNITS * keyerUnitMs;
+}
+
+unsigned long MorseTransmitterCore::wordGapThresholdMs() const {
+  if (keyerMode == KEYER_STRAIGHT) return speed.getWordGapThresholdMs();
+  return (unsigned long)IAMBIC_WORD_GAP_UNITS * keyerUnitMs;
+}
+
+// Closes the character, then the word, if the key has been up long enough
+// by atUs. Signed: in iambic mode the last mark may still be in progress.
+void MorseTransmitterCore::checkGaps(unsigned long atUs) {
+  // Character ends after an adaptive inter-character gap...
+  if (manualCode != MorseCodebook::EMPTY && lastActivityUs > 0 &&
+      (long)(atUs - lastActivityUs) >= (long)(charGapThresholdMs() * 1000)) {
+    decodeCurrentSequence(); lastActivityUs = 0;
+    wordGapPending = true;
+  }
+
+  // ...and a longer pause infers the word space (no Enter click needed)
+  if (wordGapPending && (long)(atUs - lastReleaseUs) >= (long)(wordGapThresholdMs() * 1000)) {
+    wordGapPending = false;
+    if (!isLocked && !decodedMessageBuffer.isEmpty() && decodedMessageBuffer.back() != ' ') {
+      decodedMessageBuffer.append(' ');
+      if (display) display->appendDecodedCharacter('_');
     }
   }
+}
 
-  // --- 2. HANDLE ENTER/SPACE BUTTON ---
-  if (enterBtnPin != -1 && !isLocked) { 
-      int enterReading = digitalRead(enterBtnPin);
-
-      if (enterReading == LOW && lastEnterState == HIGH) { enterPressStartTime = currentTime; }
-      else if (enterReading == HIGH && lastEnterState == LOW) { 
-          unsigned long enterDuration = currentTime - enterPressStartTime;
-
-          if (enterDuration > 50) {
-              if (enterDuration >= 1000) { 
-                  // --- LONG PRESS: SEND MESSAGE ---
-                  if (decodedMessageBuffer.length() > 0) {
-                      
-                      // === FEATURE 2: SILENT DURESS CHECK ===
-                      if (decodedMessageBuffer == DURESS_TRIGGER) {
-                          Serial.println(F("[ALERT] DURESS TRIGGERED!"));
-                          messageToSend = DURESS_MESSAGE; 
-                          
-                          // DECEPTION: Tell user it worked normally
-                          if (display) {
-                              display->setStatus(F("Sending..."));
-                              delay(500);
-                              display->clearAll();
-                              display->setStatus(F("Msg Sent OK")); 
-                          }
-                          decodedMessageBuffer = ""; 
-                          return messageToSend; // Exit immediately
-                      }
-
-                      // === FEATURE 3: MACRO EXPANSION ===
-                      // Try to expand short code (e.g. "S1")
-                      String expanded = expandMacro(decodedMessageBuffer);
-                      
-                      if (expanded != decodedMessageBuffer) {
-                          Serial.print(F("[MACRO] Expanded: "));
-                          Serial.println(expanded);
-                          messageToSend = expanded;
-                      } else {
-                          messageToSend = decodedMessageBuffer;
-                      }
-                      
-                      decodedMessageBuffer = ""; 
-                      if (display) {
-                          display->setStatus(F("Sending..."));
-                          delay(500);
-                          display->clearAll();
-                      }
-                  }
-              } else {
-                  // --- SHORT PRESS: ADD SPACE ---
-                  decodedMessageBuffer += ' ';
-                  if (display) {
-                      display->appendDecodedCharacter('_'); 
-                      display->setStatus(F("Space Added"));
-                  }
-              }
-          }
+// Straight key: each mark is classified from its own edge timestamps
+void MorseTransmitterCore::updateStraightKey(unsigned long nowUs) {
+  KeyEvent edge;
+  while (key.read(edge)) {
+    if (edge.pressed) {
+      // Gaps end when the key went down, however late we got here
+      checkGaps(edge.us);
+      pressStartUs = edge.us;
+      wordGapPending = false;
+      if (lastReleaseUs > 0) speed.addGap((edge.us - lastReleaseUs) / 1000);
+      continue;
+    }
+    unsigned long pressDuration = (edge.us - pressStartUs) / 1000;
+    if (speed.isGlitch(pressDuration)) continue;
+
+    bool dash = speed.classifyMark(pressDuration);
+    DEBUG_TRACE(F("[DEBUG] ")); DEBUG_TRACE(pressDuration);
+    DEBUG_TRACE(F("ms -> ")); DEBUG_TRACE(dash ? '-' : '.');
+    DEBUG_TRACE(F(" (unit ")); DEBUG_TRACE(speed.getUnitMs()); DEBUG_TRACELN(F("ms)"));
+    addElement(dash, edge.us);
+  }
+  if (!key.isPressed()) checkGaps(key.settledUntil(nowUs));
+}
+
+// Enter: a short press adds a space, a hold sends
+const char* MorseTransmitterCore::updateEnterButton() {
+  KeyEvent edge;
+  while (enterKey.read(edge)) {
+    if (edge.pressed) { enterPressStartUs = edge.us; continue; }
+    if (isLocked) continue;
+
+    unsigned long enterDuration = (edge.us - enterPressStartUs) / 1000;
+    if (enterDuration >= enterHoldMs) {
+      // --- LONG PRESS: SEND MESSAGE ---
+      const char* message = sendMessage();
+      if (message) return message;
+    } else {
+      // --- SHORT PRESS: ADD SPACE ---
+      decodedMessageBuffer.append(' ');
+      if (display) {
+          display->appendDecodedCharacter('_'); 
+          display->setStatus(F("Space Added"));
       }
-      lastEnterState = enterReading;
+    }
+  }
+  return nullptr;
+}
+
+// --- IAMBIC KEYER ---
+// Runs on the paddles' timestamps: paddle events and element ends are
+// handled in time order, up to the point where both paddles are known.
+void MorseTransmitterCore::updateIambic(unsigned long nowUs) {
+  for (;;) {
+    KeyEvent dit, dah;
+    bool hasDit = key.peek(dit);
+    bool hasDah = enterKey.peek(dah);
+    unsigned long ditUs = hasDit ? dit.us : key.settledUntil(nowUs);
+    unsigned long dahUs = hasDah ? dah.us : enterKey.settledUntil(nowUs);
+    bool dahFirst = (long)(dahUs - ditUs) < 0;
+    unsigned long horizonUs = dahFirst ? dahUs : ditUs;
+
+    if (elementActive && (long)(elementEndUs - horizonUs) <= 0) {
+      finishElement();
+      continue;
+    }
+    if (!(dahFirst ? hasDah : hasDit)) break; // Nothing known past the horizon yet
+
+    KeyEvent edge;
+    (dahFirst ? enterKey : key).read(edge);
+    if (dahFirst) dahDown = edge.pressed; else ditDown = edge.pressed;
+    if (!edge.pressed) continue;
+
+    if (!elementActive) startElement(dahFirst, edge.us);
+    else if (keyerMode == KEYER_IAMBIC_B && dahFirst != elementDash) {
+      if (dahFirst) dahMemory = true; else ditMemory = true;
+    }
+  }
+  if (!elementActive) {
+    unsigned long ditUs = key.settledUntil(nowUs);
+    unsigned long dahUs = enterKey.settledUntil(nowUs);
+    checkGaps((long)(dahUs - ditUs) < 0 ? dahUs : ditUs);
   }
-  return messageToSend;
-}
\ No newline at end of file
+}
+
+void MorseTransmitterCore::startElement(bool dash, unsigned long startUs) {
+  checkGaps(startUs);
+  unsigned long markMs = (dash ? 3UL : 1UL) * keyerUnitMs;
+  elementActive = true;
+  elementDash = dash;
+  elementEndUs = startUs + (markMs + keyerUnitMs) * 1000;
+  if (keyerMode == KEYER_IAMBIC_B) {
+    // A squeeze already held counts as pressed during this element
+    if (dash) ditMemory = ditDown; else dahMemory = dahDown;
+  }
+  DEBUG_TRACE(F("[DEBUG] ")); DEBUG_TRACE(markMs);
+  DEBUG_TRACE(F("ms -> ")); DEBUG_TRACELN(dash ? '-' : '.');
+  addElement(dash, startUs + markMs * 1000);
+}
+
+// The element and its gap are over: key the next one if a paddle asks
+void MorseTransmitterCore::finishElement() {
+  elementActive = false;
+  bool wantDit = ditDown || ditMemory;
+  bool wantDah = dahDown || dahMemory;
+  ditMemory = dahMemory = false;
+  if (wantDit && wantDah) startElement(!elementDash, elementEndUs); // Squeeze: alternate
+  else if (wantDit || wantDah) startElement(wantDah, elementEndUs);
+}
+
+// Hands out the typed message (duress and macros applied), or nullptr
+const char* MorseTransmitterCore::sendMessage() {
+  // (the pause before sending is long enough to add a word space; drop it)
+  while (decodedMessageBuffer.back() == ' ') {
+      decodedMessageBuffer.truncate(decodedMessageBuffer.length() - 1);
+  }
+  if (decodedMessageBuffer.isEmpty()) return nullptr;
+
+  // === FEATURE 2: SILENT DURESS CHECK ===
+  if (strcmp_P(decodedMessageBuffer.c_str(), DURESS_TRIGGER) == 0) {
+      DEBUG_WARNLN(F("[ALERT] DURESS TRIGGERED!"));
+      decodedMessageBuffer.assign(reinterpret_cast<const __FlashStringHelper*>(DURESS_MESSAGE));
+      outgoingDuress = true;
+      messageHandedOut = true;
+      
+      // DECEPTION: Tell user it worked normally
+      if (display) display->clearAll();
+      showStatusFor(F("Sending..."), STATUS_BRIEF_MS, F("Msg Sent OK"));
+      return decodedMessageBuffer.c_str();
+  }
+
+  outgoingDuress = false;
+
+  // === FEATURE 3: MACRO EXPANSION ===
+  // Try to expand short code (e.g. "S1"), in place: the key is looked up
+  // before the expansion overwrites it
+  if (expandMacro(decodedMessageBuffer.c_str(), decodedMessageBuffer)) {
+      DEBUG_INFO(F("[MACRO] Expanded: "));
+      DEBUG_INFOLN(decodedMessageBuffer.c_str());
+  }
+  messageHandedOut = true;
+
+  // The caller shows what became of it
+  nextStatus = nullptr;
+  if (display) {
+      display->clearAll();
+      display->setStatus(F("Sending..."));
+  }
+  return decodedMessageBuffer.c_str();
+}
+
+const char* MorseTransmitterCore::update() {
+  // The caller is done with the message handed out last time
+  if (messageHandedOut) {
+    decodedMessageBuffer.clear();
+    messageHandedOut = false;
+  }
+
+  // Marks and gaps come from the edge timestamps; the clock only says
+  // how long nothing has happened
+  unsigned long nowUs = micros();
+
+  // --- 1. HANDLE MORSE KEY (or paddles) ---
+  if (keyerMode != KEYER_STRAIGHT) {
+    updateIambic(nowUs);
+    if (!sendRequested) return nullptr;
+    sendRequested = false;
+    return isLocked ? nullptr : sendMessage();
+  }
+  updateStraightKey(nowUs);
+
+  // --- 2. HANDLE ENTER/SPACE BUTTON ---
+  return updateEnterButton();
+}
+
+#if !defined(__AVR__)
+// --- Host front end: pins chosen at run time ---
+MorseTransmitter::MorseTransmitter(int btnPin, int enterBtnPin, int ledP, int buzzerP)
+  : MorseTransmitterCore(T_UNIT_MS, ENTER_HOLD_TIME_MS),
+    keyPin(btnPin), enterPin(enterBtnPin), ledPin(ledP), buzzerPin(buzzerP) {}
+
+void MorseTransmitter::begin(MorseDisplay* displayPtr) {
+  keyPin.begin(key);
+  enterPin.begin(enterKey);
+  pinMode(ledPin, OUTPUT);
+  if (buzzerPin != NO_PIN) pinMode(buzzerPin, OUTPUT);
+  MorseTransmitterCore::begin(displayPtr);
+}
+
+const char* MorseTransmitter::update() {
+  key.sample(keyPin.read());
+  enterKey.sample(enterPin.read());
+  return MorseTransmitterCore::update();
+}
+
+void MorseTransmitter::tick() {
+  if (!MorseTransmitterCore::tick()) return;
+  digitalWrite(ledPin, isKeyDown() ? HIGH : LOW);
+  if (buzzerPin != NO_PIN) digitalWrite(buzzerPin, isKeyDown() ? HIGH : LOW);
+}
+#endif
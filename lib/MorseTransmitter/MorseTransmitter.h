@@ -2,78 +2,287 @@
 #define MORSE_TRANSMITTER_H
 
 #include <Arduino.h>
+#include "MorseCodebook.h"
+#include "MorseSpeedTracker.h"
+#include "KeyInput.h"
+#include "FastPin.h"
+#include "FixedString.h"
+#include "RingBuffer.h"
 
 class MorseDisplay; 
 
 // --- TIMING CONSTANTS ---
+// Unit of the default profile (DefaultMorseTiming, below). Playback keys
+// dots and element gaps of 1 unit, dashes and character gaps of 3, and
+// word gaps of 7.
 const long T_UNIT_MS = 150; 
-const long DOT_DURATION_MS = T_UNIT_MS * 1;
-const long DASH_DURATION_MS = T_UNIT_MS * 3;
-const long ELEMENT_GAP_MS = T_UNIT_MS * 1;
-const long CHAR_GAP_MS = T_UNIT_MS * 3; 
-const long WORD_GAP_MS = T_UNIT_MS * 7; 
 
 // INPUT TIMINGS
-const long MAX_DOT_DURATION_MS = 280; 
-const long MIN_DASH_DURATION_MS = 281;
-const long DECODE_TIMEOUT_MS = 1500; 
+// Key input starts out expecting the profile's unit; the dot/dash split and the
+// character/word gaps then adapt to the operator (see MorseSpeedTracker).
+// Marks and gaps are measured between the keys' interrupt timestamps
+// (see KeyInput), not between loop() passes.
+
+// IAMBIC KEYER
+// Paddles on the two key pins: BUTTON_PIN dits, ENTER_BTN_PIN dahs. The
+// keyer times the elements itself; squeezing both alternates them.
+//   A: the paddles are read as each element ends
+//   B: a paddle pressed at any time during an element is remembered, so
+//      letting go of a squeeze still sends one more alternate element
+// With Enter taken by a paddle, the AR prosign (.-.-.) sends the message.
+enum KeyerMode : uint8_t { KEYER_STRAIGHT, KEYER_IAMBIC_A, KEYER_IAMBIC_B };
+const uint8_t IAMBIC_DEFAULT_WPM = 15;
+const uint8_t IAMBIC_MIN_WPM = 5;
+const uint8_t IAMBIC_MAX_WPM = 40;
+const uint8_t IAMBIC_CHAR_GAP_UNITS = 2;   // Silence after a mark that ends the character...
+const uint8_t IAMBIC_WORD_GAP_UNITS = 5;   // ...and the word (midway to 3 and 7 units)
 
 // Button 2 Timings
 const long ENTER_HOLD_TIME_MS = 1000; 
 
-class MorseTransmitter {
-public:
-    struct MorseCodeEntry {
-        char character;
-        const char* sequence;
-    };
+// TIMING PROFILES
+// The playback unit (elements and gaps are 1, 3 and 7 of it) and the Enter
+// hold that sends, picked per build through MorseTransmitterT's Timing.
+template <long UnitMs, long EnterHoldMs = ENTER_HOLD_TIME_MS>
+struct MorseTiming {
+    static const long UNIT_MS = UnitMs;
+    static const long ENTER_HOLD_MS = EnterHoldMs;
+};
+typedef MorseTiming<T_UNIT_MS> DefaultMorseTiming;
+
+// MESSAGE BUFFERS
+const uint8_t MESSAGE_BUFFER_LEN = 64;     // Longest message typed or expanded
+
+// PLAYBACK QUEUE
+// Max characters waiting to be keyed out (power of 2, at most 128): the
+// longest radio message (RADIO_MAX_MESSAGE_LEN, 64) fits whole
+const uint8_t TX_QUEUE_SIZE = 64;
+const long PLAYBACK_STATUS_HOLD_MS = 1000; // How long the last "RX:" status stays up
 
+// STATUS MESSAGES
+// Shown for a moment, then replaced from tick(): nothing waits for them
+const unsigned long STATUS_BRIEF_MS = 500;  // "WRONG PASSCODE", duress "Sending..."
+const unsigned long STATUS_LONG_MS = 1000;  // "ACCESS GRANTED", "CLEARED!"
+
+/**
+ * @brief Keying, decoding and playback, without the pins.
+ *
+ * All the logic lives here, compiled once. The pins are handled by the
+ * front end deriving from it: MorseTransmitterT (pins fixed at compile time)
+ * on the units, or MorseTransmitter (pins at run time) on the host. The
+ * front end begins the keys, sample()s them before update() and drives the
+ * LED and buzzer whenever tick() says the key output changed.
+ */
+class MorseTransmitterCore {
 private:
-    int btnPin;
-    int enterBtnPin; 
-    int ledPin;
-    int buzzerPin;
+    // Timing profile (see MorseTiming)
+    unsigned int unitMs;
+    unsigned int enterHoldMs;
+    bool keyOutput = false;             // LED/buzzer state for the front end
 
     // --- SECURITY CONFIGURATION ---
     bool isLocked = true;               
-    const String PASSCODE = "...---..."; // SOS to Unlock
-    String unlockBuffer = "";           
+    static const uint16_t PASSCODE = MorseCodebook::pack("...---..."); // SOS to Unlock
+    static const uint8_t PASSCODE_LENGTH = 9;
+    // Elements keyed since the last attempt, packed like a character but
+    // 16 bits wide: the passcode may be keyed as one run of 9, more than a
+    // character code holds. Stops growing one element past the passcode.
+    uint16_t unlockCode = MorseCodebook::EMPTY;
+    uint8_t unlockLength = 0;
 
     // FEATURE 2: SILENT DURESS
     // Trigger: "..--" (mapped to '!')
     // This is short, distinct, and not a standard letter.
-    const String DURESS_TRIGGER = "!"; 
-    const String DURESS_MESSAGE = "!!! HOSTAGE ALERT !!!";
+    // (DURESS_TRIGGER / DURESS_MESSAGE live in flash, see the .c++)
 
     // FEATURE 3: SEMANTIC MACROS
-    // "S1" -> "SECTOR 1 SECURE"
+    // "S1" -> "SECTOR 1 SECURE" (brevity codes: see MacroCatalogue)
     
-    // State Management
-    int lastButtonState = HIGH; 
-    unsigned long pressStartTime = 0;
-    unsigned long lastActivityTime = 0; 
-    String manualSequence = "";
+    // State Management (times are micros() stamps of key edges)
+    unsigned long pressStartUs = 0;
+    unsigned long lastActivityUs = 0;   // End of the last mark of the current char
+    unsigned long lastReleaseUs = 0;    // Never cleared, used for gap timing
+    bool wordGapPending = false;        // Char decoded, word space not yet added
+    MorseSpeedTracker speed;
+    uint8_t manualCode = MorseCodebook::EMPTY; // Packed elements of the current char
 
-    int lastEnterState = HIGH;
-    unsigned long enterPressStartTime = 0;
+    unsigned long enterPressStartUs = 0;
 
-    String decodedMessageBuffer = "";
+    // Iambic keyer state
+    KeyerMode keyerMode = KEYER_STRAIGHT;
+    unsigned int keyerUnitMs = 1200 / IAMBIC_DEFAULT_WPM;
+    bool ditDown = false;               // Paddles, as of the last event consumed
+    bool dahDown = false;
+    bool elementActive = false;         // Keying an element or the gap after it
+    bool elementDash = false;
+    unsigned long elementEndUs = 0;     // End of that gap: the next element may start
+    bool ditMemory = false;             // Mode B: paddle pressed during the element
+    bool dahMemory = false;
+    bool sendRequested = false;         // AR keyed
+
+    typedef FixedString<MESSAGE_BUFFER_LEN> MessageBuffer;
+    // The message being keyed; update() hands it out in place (duress and
+    // macros applied) and empties it on the next call
+    MessageBuffer decodedMessageBuffer;
+    bool messageHandedOut = false;
+    bool outgoingDuress = false;        // The message handed out is the duress alert
     MorseDisplay *display; 
 
+    // Playback State Machine (driven by tick(), never blocks)
+    enum PlaybackState { PLAYBACK_IDLE, PLAYBACK_MARK, PLAYBACK_GAP };
+    PlaybackState playbackState = PLAYBACK_IDLE;
+    RingBuffer<char, TX_QUEUE_SIZE> txQueue;
+    uint8_t playbackCode = MorseCodebook::EMPTY; // Packed code of current char
+    uint8_t playbackElements = 0;           // Elements of it still to key
+    long playbackCharGap = 0;               // Gap to hold after its last element
+    unsigned long playbackStepStart = 0;
+    unsigned long playbackStepDuration = 0;
+    bool playbackStatusPending = false;     // Restore the idle status once idle
+    bool playbackCut = false;               // Text was dropped: say so once idle
+
+    // Timed status: the one on screen gives way to nextStatus at statusUntil
+    const __FlashStringHelper* nextStatus = nullptr;
+    unsigned long statusUntil = 0;
+    const __FlashStringHelper* idleStatus = nullptr; // nullptr: "Ready"
+
+#if !defined(__AVR__)
+    uint16_t keyedElements = 0;         // Host: elements keyed since begin()...
+    uint16_t recentDashes = 0;          // ...and the last 16 of them, 1 = dash
+#endif
+
+    void advancePlayback();
+    void startNextCharacter(unsigned long now);
+    void beginPlaybackStep(PlaybackState state, long duration, unsigned long now);
+    void setKeyOutput(bool on);
+    void showStatusFor(const __FlashStringHelper* status, unsigned long ms,
+                       const __FlashStringHelper* next);
+    void updateStatus(unsigned long now);
+    const __FlashStringHelper* idleStatusText() const;
+    long nextElementDuration() const;
     void generateSignal(char type);
-    const char* getMorseCode(char c);
     void decodeCurrentSequence();
     void checkUnlock(); 
+    void addElement(bool dash, unsigned long markEndUs);
+    void checkGaps(unsigned long atUs);
+    unsigned long charGapThresholdMs() const;
+    unsigned long wordGapThresholdMs() const;
+    void updateStraightKey(unsigned long nowUs);
+    const char* updateEnterButton();
+    void updateIambic(unsigned long nowUs);
+    void startElement(bool dash, unsigned long startUs);
+    void finishElement();
+    const char* sendMessage();
     
-    // Helper for Macros
-    String expandMacro(String input);
+    // Helper for Macros: writes the expansion into out, false if no match
+    bool expandMacro(const char* input, MessageBuffer& out);
+
+protected:
+    KeyInput key;                       // Morse key, or the dit paddle
+    KeyInput enterKey;                  // Enter/space button, or the dah paddle
+
+    MorseTransmitterCore(unsigned int unitMs, unsigned int enterHoldMs);
+
+    // The front end's begin(), update() and tick() wrap these
+    void begin(MorseDisplay* displayPtr); 
+    const char* update(); 
+    bool tick();                        // True if the key output changed
+    bool isKeyDown() const { return keyOutput; }
+
+public:
+    // The message update() last returned was the duress alert (the display
+    // already claims it was sent: send it first and show nothing about it)
+    bool wasDuress() const { return outgoingDuress; }
+
+    // The status line's resting text (e.g. "Spy Unit Ready"), put back after
+    // playback, "ACCESS GRANTED" and "CLEARED!". A flash string (F()).
+    void setIdleStatus(const __FlashStringHelper* status) { idleStatus = status; }
+
+    // Straight key (the default) or iambic paddles at a fixed speed. Iambic
+    // needs both pins; without an Enter pin it stays on the straight key.
+    void setKeyerMode(KeyerMode mode, uint8_t wpm = IAMBIC_DEFAULT_WPM);
+    KeyerMode getKeyerMode() const { return keyerMode; }
+
+    // Queues text for Morse playback and returns immediately.
+    // Returns false if the queue filled up and the tail was dropped; the
+    // LCD then shows "Playback CUT" once what did fit has played.
+    bool processText(const char* text);  
+
+    // Current estimate of the operator's keying speed (the keyer's own
+    // speed with paddles), for logging
+    unsigned int getUnitEstimateMs() const {
+        return keyerMode == KEYER_STRAIGHT ? speed.getUnitMs() : keyerUnitMs;
+    }
+
+    // Key contact bursts dropped by the debouncer, and edge ring overruns
+    unsigned int getKeyGlitches() const { return key.getGlitches() + enterKey.getGlitches(); }
+    unsigned int getKeyOverruns() const { return key.getOverruns() + enterKey.getOverruns(); }
+    void resetKeyStats() { key.resetStats(); enterKey.resetStats(); }
+
+    bool isPlaying() const { return playbackState != PLAYBACK_IDLE || !txQueue.isEmpty(); }
+    bool isUnlocked() const { return !isLocked; }
+
+#if !defined(__AVR__)
+    // Host: every element keyed, locked or not, to follow the decoder
+    // without its trace output. Bit 0 of getRecentDashes() is the latest.
+    uint16_t getKeyedElements() const { return keyedElements; }
+    uint16_t getRecentDashes() const { return recentDashes; }
+#endif
+};
+
+/**
+ * @brief The transmitter on pins fixed at compile time (from Config.h).
+ *
+ * Keys are read and the LED/buzzer driven straight through the port
+ * registers (see FastPin), and a pin given as NO_PIN (e.g. the spy's
+ * buzzer) compiles out: no member, no test, no write. Timing is a
+ * MorseTiming profile.
+ */
+template <int BtnPin, int EnterBtnPin, int LedPin, int BuzzerPin, class Timing = DefaultMorseTiming>
+class MorseTransmitterT : public MorseTransmitterCore {
+public:
+    MorseTransmitterT() : MorseTransmitterCore(Timing::UNIT_MS, Timing::ENTER_HOLD_MS) {}
+
+    void begin(MorseDisplay* displayPtr) {
+        KeyPin<BtnPin>::begin(key);
+        KeyPin<EnterBtnPin>::begin(enterKey);
+        FastPin<LedPin>::output();
+        FastPin<BuzzerPin>::output();
+        MorseTransmitterCore::begin(displayPtr);
+    }
+
+    // Consumes the keys' edges. Returns a message to send (valid until the
+    // next call), or nullptr if there is nothing to send.
+    const char* update() {
+        key.sample(KeyPin<BtnPin>::read());
+        enterKey.sample(KeyPin<EnterBtnPin>::read());
+        return MorseTransmitterCore::update();
+    }
+
+    // Advances LED/buzzer playback. Call on every loop() iteration.
+    void tick() {
+        if (!MorseTransmitterCore::tick()) return;
+        FastPin<LedPin>::write(isKeyDown());
+        FastPin<BuzzerPin>::write(isKeyDown());
+    }
+};
+
+#if !defined(__AVR__)
+// Host: the same with pins chosen at run time (-1 for none), for tools and
+// tests that pick their wiring as they go. Same begin/update/tick contract.
+class MorseTransmitter : public MorseTransmitterCore {
+private:
+    RuntimeKeyPin keyPin;
+    RuntimeKeyPin enterPin;
+    int ledPin;
+    int buzzerPin;
 
 public:
     MorseTransmitter(int btnPin, int enterBtnPin, int ledP, int buzzerP);
 
-    void begin(MorseDisplay* displayPtr); 
-    String update(); 
-    void processText(const String& text);  
+    void begin(MorseDisplay* displayPtr);
+    const char* update();
+    void tick();
 };
+#endif
 
 #endif
\ No newline at end of file
@@ -0,0 +1,28 @@
+#ifndef NATIVE_HAL_EEPROM_H
+#define NATIVE_HAL_EEPROM_H
+
+#include <Arduino.h>
+
+// The selected board's EEPROM. Writes are counted per cell so wear can be
+// checked, and cost the 3.3 ms erase/write cycle of the real part.
+class EEPROMClass {
+public:
+    uint8_t read(int address);
+    void write(int address, uint8_t value);
+    void update(int address, uint8_t value) { if (read(address) != value) write(address, value); }
+    uint16_t length();
+
+    template <typename T> T& get(int address, T& value) {
+        uint8_t* bytes = reinterpret_cast<uint8_t*>(&value);
+        for (size_t i = 0; i < sizeof(T); ++i) bytes[i] = read(address + i);
+        return value;
+    }
+    template <typename T> const T& put(int address, const T& value) {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+        for (size_t i = 0; i < sizeof(T); ++i) update(address + i, bytes[i]);
+        return value;
+    }
+};
+extern EEPROMClass EEPROM;
+
+#endif // NATIVE_HAL_EEPROM_H
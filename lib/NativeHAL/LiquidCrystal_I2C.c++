@@ -0,0 +1,46 @@
+#include "LiquidCrystal_I2C.h"
+#include "NativeHAL.h"
+
+const uint8_t LiquidCrystal_I2C::MAX_COLS;
+const uint8_t LiquidCrystal_I2C::MAX_ROWS;
+const uint8_t LiquidCrystal_I2C::BUS_BYTES_PER_LCD_BYTE;
+
+LiquidCrystal_I2C::LiquidCrystal_I2C(uint8_t, uint8_t lcdCols, uint8_t lcdRows)
+    : cols(min(lcdCols, MAX_COLS)), rows(min(lcdRows, MAX_ROWS)) {
+    memset(ddram, ' ', sizeof(ddram));
+}
+
+void LiquidCrystal_I2C::sendByte() {
+    lcdBytes++;
+    NativeHAL::advanceMicros(BUS_BYTES_PER_LCD_BYTE * NativeHAL::I2C_BYTE_US);
+}
+
+void LiquidCrystal_I2C::init() {
+    for (uint8_t i = 0; i < 6; ++i) sendByte(); // Function set, display on, entry mode...
+    clear();
+}
+
+void LiquidCrystal_I2C::clear() {
+    sendByte();
+    NativeHAL::advanceMicros(2000); // The controller needs ~1.5 ms to clear
+    memset(ddram, ' ', sizeof(ddram));
+    col = row = 0;
+}
+
+void LiquidCrystal_I2C::setCursor(uint8_t newCol, uint8_t newRow) {
+    sendByte();
+    col = newCol;
+    row = newRow < rows ? newRow : rows - 1;
+}
+
+size_t LiquidCrystal_I2C::write(uint8_t c) {
+    sendByte();
+    if (col < cols) ddram[row][col] = (char)c;
+    col++; // Past the last column the byte lands in hidden DDRAM
+    return 1;
+}
+
+std::string LiquidCrystal_I2C::rowText(uint8_t r) const {
+    if (r >= rows) return std::string();
+    return std::string(ddram[r], cols);
+}
@@ -0,0 +1,47 @@
+#ifndef NATIVE_HAL_LIQUID_CRYSTAL_I2C_H
+#define NATIVE_HAL_LIQUID_CRYSTAL_I2C_H
+
+#include <Arduino.h>
+#include <string>
+
+// Host stand-in for the PCF8574-backed HD44780. Keeps the DDRAM contents for
+// inspection and charges each byte's I2C time to the caller's clock.
+class LiquidCrystal_I2C : public Print {
+public:
+    static const uint8_t MAX_COLS = 20;
+    static const uint8_t MAX_ROWS = 4;
+    // One LCD byte = 2 nibbles x 3 expander writes x (address + data)
+    static const uint8_t BUS_BYTES_PER_LCD_BYTE = 12;
+
+private:
+    uint8_t cols;
+    uint8_t rows;
+    uint8_t col = 0;
+    uint8_t row = 0;
+    char ddram[MAX_ROWS][MAX_COLS];
+
+    unsigned long lcdBytes = 0;   // Commands and characters sent
+
+    void sendByte();
+
+public:
+    using Print::write;
+
+    LiquidCrystal_I2C(uint8_t address, uint8_t lcdCols, uint8_t lcdRows);
+
+    void init();
+    void begin(uint8_t lcdCols, uint8_t lcdRows) { cols = lcdCols; rows = lcdRows; init(); }
+    void backlight() { sendByte(); }
+    void noBacklight() { sendByte(); }
+    void clear();
+    void home() { setCursor(0, 0); }
+    void setCursor(uint8_t newCol, uint8_t newRow);
+    size_t write(uint8_t c) override;
+
+    // --- Inspection ---
+    std::string rowText(uint8_t r) const;
+    unsigned long getLcdBytes() const { return lcdBytes; }
+    unsigned long getBusBytes() const { return lcdBytes * BUS_BYTES_PER_LCD_BYTE; }
+};
+
+#endif // NATIVE_HAL_LIQUID_CRYSTAL_I2C_H
@@ -0,0 +1,233 @@
+#include "NativeHAL.h"
+
+namespace NativeHAL {
+
+namespace {
+Board defaultBoard("default");
+Board* selected = &defaultBoard;
+uint32_t randomState = 1;
+std::function<void(uint64_t)> syncHook;
+}
+
+Board::Board(const std::string& boardName) : name(boardName) {
+    memset(input, HIGH, sizeof(input)); // Unconnected pins read as pulled up
+    memset(eeprom, 0xFF, sizeof(eeprom)); // Erased EEPROM
+}
+
+void select(Board& board) { selected = &board; }
+Board& current() { return *selected; }
+
+void advanceMicros(uint64_t us) {
+    selected->nowUs += us;
+    if (selected->onClock) selected->onClock(*selected);
+}
+
+void setSyncHook(const std::function<void(uint64_t untilUs)>& hook) { syncHook = hook; }
+
+void syncOthers() {
+    if (!syncHook) return;
+    Board* caller = selected;
+    syncHook(caller->nowUs);
+    selected = caller;
+}
+
+void setInput(Board& board, uint8_t pin, uint8_t level) {
+    if (pin >= NUM_DIGITAL_PINS) return;
+    uint8_t previous = board.input[pin];
+    board.input[pin] = level;
+    if (previous == level) return;
+
+    int interruptNum = digitalPinToInterrupt(pin);
+    if (interruptNum == NOT_AN_INTERRUPT) return;
+    if (!board.isr[interruptNum] && !board.isrWithArg[interruptNum]) return;
+    int mode = board.isrMode[interruptNum];
+    if (mode == CHANGE || (mode == RISING && level == HIGH) || (mode == FALLING && level == LOW)) {
+        Board* caller = selected;
+        selected = &board;
+        if (board.isr[interruptNum]) board.isr[interruptNum]();
+        else board.isrWithArg[interruptNum](board.isrArg[interruptNum]);
+        selected = caller;
+    }
+}
+
+void setInputAt(Board& board, uint8_t pin, uint8_t level, uint64_t atUs) {
+    uint64_t nowUs = board.nowUs;
+    if (atUs < nowUs) board.nowUs = atUs;
+    setInput(board, pin, level);
+    board.nowUs = nowUs;
+}
+
+void typeOnSerial(Board& board, const char* text) {
+    while (*text) board.serialInput.push_back((uint8_t)*text++);
+}
+
+} // namespace NativeHAL
+
+using NativeHAL::current;
+
+// --- Print ---
+size_t Print::write(const uint8_t* buffer, size_t size) {
+    size_t n = 0;
+    while (size--) n += write(*buffer++);
+    return n;
+}
+
+size_t Print::print(const __FlashStringHelper* s) {
+    return write(reinterpret_cast<const char*>(s));
+}
+
+size_t Print::printNumber(unsigned long n, uint8_t base) {
+    char buf[8 * sizeof(long) + 1];
+    char* str = &buf[sizeof(buf) - 1];
+    *str = '\0';
+    if (base < 2) base = 10;
+    do {
+        char digit = n % base;
+        n /= base;
+        *--str = digit < 10 ? digit + '0' : digit + 'A' - 10;
+    } while (n);
+    return write(str);
+}
+
+size_t Print::print(long n, int base) {
+    if (base == DEC && n < 0) return print('-') + printNumber(-(unsigned long)n, 10);
+    return printNumber((unsigned long)n, base);
+}
+
+size_t Print::print(unsigned long n, int base) {
+    return printNumber(n, base);
+}
+
+size_t Print::print(double n, int digits) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.*f", digits, n);
+    return write(buf);
+}
+
+// --- Serial (selected board's console) ---
+HardwareSerial Serial;
+
+void HardwareSerial::begin(unsigned long baud) { current().serialByteUs = 10000000UL / baud; }
+
+int HardwareSerial::available() { return (int)current().serialInput.size(); }
+
+int HardwareSerial::read() {
+    NativeHAL::Board& board = current();
+    if (board.serialInput.empty()) return -1;
+    uint8_t c = board.serialInput.front();
+    board.serialInput.pop_front();
+    return c;
+}
+
+int HardwareSerial::peek() {
+    NativeHAL::Board& board = current();
+    return board.serialInput.empty() ? -1 : board.serialInput.front();
+}
+
+// Bytes still in the TX buffer, rounded up
+static uint32_t serialTxQueued(const NativeHAL::Board& board) {
+    if (board.serialTxDoneUs <= board.nowUs) return 0;
+    return (uint32_t)((board.serialTxDoneUs - board.nowUs + board.serialByteUs - 1) / board.serialByteUs);
+}
+
+int HardwareSerial::availableForWrite() {
+    uint32_t queued = serialTxQueued(current());
+    return queued >= SERIAL_TX_BUFFER_SIZE - 1 ? 0 : (int)(SERIAL_TX_BUFFER_SIZE - 1 - queued);
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+    NativeHAL::Board& board = current();
+    // Full buffer: the hardware would wait here for a slot; the host doesn't
+    if (serialTxQueued(board) < SERIAL_TX_BUFFER_SIZE - 1) {
+        uint64_t start = board.serialTxDoneUs > board.nowUs ? board.serialTxDoneUs : board.nowUs;
+        board.serialTxDoneUs = start + board.serialByteUs;
+    }
+    if (c == '\r') return 1;
+    if (c != '\n') { board.serialLine += (char)c; return 1; }
+
+    if (board.echo) fprintf(stderr, "[%s %9.3f] %s\n", board.name.c_str(),
+                            board.nowUs / 1000.0, board.serialLine.c_str());
+    if (board.onSerialLine) board.onSerialLine(board.serialLine, board.nowUs);
+    board.serialLine.clear();
+    return 1;
+}
+
+HardwareSerial::operator bool() const { return true; }
+
+// --- Time ---
+unsigned long millis() { return (unsigned long)(current().nowUs / 1000); }
+unsigned long micros() { return (unsigned long)current().nowUs; }
+void delay(unsigned long ms) { NativeHAL::advanceMicros((uint64_t)ms * 1000); }
+void delayMicroseconds(unsigned int us) { NativeHAL::advanceMicros(us); }
+void yield() {}
+
+// --- Pins ---
+void pinMode(uint8_t pin, uint8_t mode) {
+    if (pin < NUM_DIGITAL_PINS) current().mode[pin] = mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    NativeHAL::Board& board = current();
+    if (pin >= NUM_DIGITAL_PINS) return;
+    value = value ? HIGH : LOW;
+    if (board.output[pin] == value) return;
+    board.output[pin] = value;
+    if (board.outputListener) board.outputListener(pin, value, board.nowUs);
+}
+
+int digitalRead(uint8_t pin) {
+    NativeHAL::Board& board = current();
+    if (pin >= NUM_DIGITAL_PINS) return LOW;
+    return board.mode[pin] == OUTPUT ? board.output[pin] : board.input[pin];
+}
+
+int analogRead(uint8_t pin) {
+    NativeHAL::Board& board = current();
+    return board.analogSource ? board.analogSource(pin, board.nowUs) : 0;
+}
+
+// --- Interrupts ---
+int digitalPinToInterrupt(uint8_t pin) {
+    return pin == 2 ? 0 : (pin == 3 ? 1 : NOT_AN_INTERRUPT);
+}
+
+void attachInterrupt(uint8_t interruptNum, void (*handler)(), int mode) {
+    if (interruptNum >= NativeHAL::EXTERNAL_INTERRUPTS) return;
+    current().isr[interruptNum] = handler;
+    current().isrWithArg[interruptNum] = nullptr;
+    current().isrMode[interruptNum] = mode;
+}
+
+void attachInterruptArg(uint8_t interruptNum, void (*handler)(void*), void* arg, int mode) {
+    if (interruptNum >= NativeHAL::EXTERNAL_INTERRUPTS) return;
+    current().isr[interruptNum] = nullptr;
+    current().isrWithArg[interruptNum] = handler;
+    current().isrArg[interruptNum] = arg;
+    current().isrMode[interruptNum] = mode;
+}
+
+void detachInterrupt(uint8_t interruptNum) {
+    if (interruptNum >= NativeHAL::EXTERNAL_INTERRUPTS) return;
+    current().isr[interruptNum] = nullptr;
+    current().isrWithArg[interruptNum] = nullptr;
+}
+
+// Nothing runs concurrently on the host: ISRs fire from setInput()
+void noInterrupts() {}
+void interrupts() {}
+
+// --- Random (deterministic LCG, same sequence every run) ---
+long random(long howBig) {
+    if (howBig <= 0) return 0;
+    NativeHAL::randomState = NativeHAL::randomState * 1103515245UL + 12345UL;
+    return (long)((NativeHAL::randomState >> 1) % (unsigned long)howBig);
+}
+
+long random(long howSmall, long howBig) {
+    if (howSmall >= howBig) return howSmall;
+    return howSmall + random(howBig - howSmall);
+}
+
+void randomSeed(unsigned long seed) {
+    if (seed != 0) NativeHAL::randomState = (uint32_t)seed;
+}
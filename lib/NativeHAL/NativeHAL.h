@@ -0,0 +1,88 @@
+#ifndef NATIVE_HAL_H
+#define NATIVE_HAL_H
+
+#include <Arduino.h>
+#include <deque>
+#include <functional>
+#include <string>
+
+/**
+ * @brief Control side of the host HAL, used by the simulator.
+ *
+ * Every simulated Arduino is a Board with its own pins, console, EEPROM and
+ * clock. The Arduino API (millis, digitalRead, Serial, ...) acts on the
+ * selected board. Clocks only move when something advances them: delay(),
+ * the I/O cost models below, or the simulator itself. Runs are therefore
+ * fully deterministic.
+ */
+namespace NativeHAL {
+
+const uint16_t EEPROM_SIZE = 1024; // ATmega328P
+const uint8_t EXTERNAL_INTERRUPTS = 2; // INT0 (pin 2), INT1 (pin 3)
+
+// --- I/O cost model (virtual time charged to the calling board) ---
+const uint32_t I2C_BYTE_US = 90;      // 9 bits at 100 kHz
+const uint32_t RTC_READ_US = 10 * I2C_BYTE_US; // Address, register, 7 data bytes
+
+struct Board {
+    std::string name;
+    uint64_t nowUs = 0;
+
+    uint8_t mode[NUM_DIGITAL_PINS] = {};
+    uint8_t input[NUM_DIGITAL_PINS];    // Level driven from outside
+    uint8_t output[NUM_DIGITAL_PINS] = {};
+
+    // Analog inputs: called with the pin and the board's time
+    std::function<int(uint8_t pin, uint64_t nowUs)> analogSource;
+    // Output edges, e.g. to time the keyed LED
+    std::function<void(uint8_t pin, uint8_t level, uint64_t nowUs)> outputListener;
+    // Called whenever the clock moves, even inside loop(): inputs driven from
+    // here interrupt a busy sketch on time, as they would on the hardware
+    std::function<void(Board& board)> onClock;
+
+    // Console: complete lines go to onSerialLine (and stderr if echo is set)
+    std::string serialLine;
+    std::deque<uint8_t> serialInput;
+    std::function<void(const std::string& line, uint64_t nowUs)> onSerialLine;
+    bool echo = false;
+    // The TX buffer drains at the begin() baud rate; this is when it empties.
+    // write() never waits for room, so DEBUG_LEVEL=4 traces cost no time,
+    // but availableForWrite() reports what would still fit on the hardware.
+    uint32_t serialByteUs = 1042; // 9600 baud
+    uint64_t serialTxDoneUs = 0;
+
+    uint8_t eeprom[EEPROM_SIZE];
+    uint32_t eepromWrites[EEPROM_SIZE] = {};
+
+    void (*isr[EXTERNAL_INTERRUPTS])() = {};
+    void (*isrWithArg[EXTERNAL_INTERRUPTS])(void*) = {};
+    void* isrArg[EXTERNAL_INTERRUPTS] = {};
+    int isrMode[EXTERNAL_INTERRUPTS] = {};
+
+    explicit Board(const std::string& boardName);
+};
+
+// --- Board selection ---
+void select(Board& board);
+Board& current();
+
+// --- Time ---
+void advanceMicros(uint64_t us);
+
+// Brings every other board up to the selected board's time. Shared media
+// (the radio ether) call this before acting, so a board that blocks inside
+// one loop() still sees its peers run meanwhile. Installed by the simulator.
+void setSyncHook(const std::function<void(uint64_t untilUs)>& hook);
+void syncOthers();
+
+// --- Stimulus ---
+// Drives an input pin; fires an attached interrupt on a matching edge.
+void setInput(Board& board, uint8_t pin, uint8_t level);
+// The same for an edge that happened at atUs (<= board.nowUs): the interrupt
+// handler sees micros() == atUs, as it would have on the hardware.
+void setInputAt(Board& board, uint8_t pin, uint8_t level, uint64_t atUs);
+void typeOnSerial(Board& board, const char* text);
+
+} // namespace NativeHAL
+
+#endif // NATIVE_HAL_H
@@ -0,0 +1,29 @@
+#include "NativeHAL.h"
+#include "EEPROM.h"
+#include "SPI.h"
+#include "Wire.h"
+
+TwoWire Wire;
+SPIClass SPI;
+EEPROMClass EEPROM;
+
+namespace {
+const uint32_t EEPROM_WRITE_US = 3300;
+}
+
+uint8_t EEPROMClass::read(int address) {
+    if (address < 0 || address >= NativeHAL::EEPROM_SIZE) return 0xFF;
+    return NativeHAL::current().eeprom[address];
+}
+
+void EEPROMClass::write(int address, uint8_t value) {
+    if (address < 0 || address >= NativeHAL::EEPROM_SIZE) return;
+    NativeHAL::Board& board = NativeHAL::current();
+    board.eeprom[address] = value;
+    board.eepromWrites[address]++;
+    NativeHAL::advanceMicros(EEPROM_WRITE_US);
+}
+
+uint16_t EEPROMClass::length() {
+    return NativeHAL::EEPROM_SIZE;
+}
@@ -0,0 +1,252 @@
+#include "RF24.h"
+#include "NativeHAL.h"
+#include <algorithm>
+
+namespace NativeHAL {
+
+namespace {
+Ether sharedEther;
+}
+
+Ether& ether() { return sharedEther; }
+
+namespace {
+const size_t AIR_HISTORY = 32; // Plenty for a handful of radios
+}
+
+void Ether::reset() {
+    attempts = delivered = lost = failed = collisions = airtimeUs = 0;
+    air.clear();
+}
+
+void Ether::onAir(const void* radio, uint8_t channel, uint64_t startUs, uint64_t endUs) {
+    Transmission t = {radio, channel, startUs, endUs};
+    air.push_back(t);
+    if (air.size() > AIR_HISTORY) air.pop_front();
+}
+
+bool Ether::collides(const void* radio, uint8_t channel, uint64_t startUs, uint64_t endUs) const {
+    for (size_t i = 0; i < air.size(); ++i) {
+        const Transmission& t = air[i];
+        if (t.radio != radio && t.channel == channel && t.startUs < endUs && startUs < t.endUs) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace NativeHAL
+
+namespace {
+const uint32_t TX_SETTLING_US = 130; // PLL settling before each TX or ACK
+
+bool attemptLost() {
+    NativeHAL::Ether& ether = NativeHAL::ether();
+    if (ether.lossPercent == 0) return false;
+    ether.seed = ether.seed * 1103515245UL + 12345UL;
+    return ((ether.seed >> 16) % 100) < ether.lossPercent;
+}
+}
+
+const uint8_t RF24::MAX_PAYLOAD;
+const uint8_t RF24::FIFO_DEPTH;
+const uint8_t RF24::PIPES;
+
+std::vector<RF24*>& RF24::registry() {
+    static std::vector<RF24*> radios;
+    return radios;
+}
+
+RF24::RF24(uint16_t, uint16_t) {
+    registry().push_back(this);
+}
+
+RF24::~RF24() {
+    std::vector<RF24*>& radios = registry();
+    radios.erase(std::remove(radios.begin(), radios.end(), this), radios.end());
+}
+
+bool RF24::begin() {
+    started = true;
+    return true;
+}
+
+void RF24::openReadingPipe(uint8_t pipe, const uint8_t* address) {
+    if (pipe >= PIPES) return;
+    // Pipes 2-5 share bytes 1-4 with pipe 1 and only set their LSB
+    if (pipe >= 2) {
+        memcpy(pipeAddress[pipe], pipeAddress[1], 5);
+        pipeAddress[pipe][0] = address[0];
+    } else {
+        memcpy(pipeAddress[pipe], address, 5);
+    }
+    pipeOpen[pipe] = true;
+}
+
+void RF24::closeReadingPipe(uint8_t pipe) {
+    if (pipe < PIPES) pipeOpen[pipe] = false;
+}
+
+void RF24::openWritingPipe(const uint8_t* address) {
+    memcpy(txAddress, address, 5);
+}
+
+void RF24::startListening() {
+    listening = true;
+}
+
+void RF24::stopListening() {
+    listening = false;
+}
+
+// Preamble, address, packet control field, payload, CRC16 - then the ACK
+uint32_t RF24::airtimeUs(uint8_t length) const {
+    uint32_t usPerByte = dataRate == RF24_250KBPS ? 32 : (dataRate == RF24_2MBPS ? 4 : 8);
+    uint32_t packet = (1 + 5 + length + 2) * usPerByte + 9 * usPerByte / 8;
+    uint32_t ack = (1 + 5 + 2) * usPerByte + 9 * usPerByte / 8;
+    return TX_SETTLING_US + packet + (autoAck ? TX_SETTLING_US + ack : 0);
+}
+
+RF24* RF24::findReceiver(uint8_t& pipe) {
+    std::vector<RF24*>& radios = registry();
+    for (size_t i = 0; i < radios.size(); ++i) {
+        RF24* other = radios[i];
+        if (other == this || !other->started || !other->listening) continue;
+        if (other->channel != channel || other->dataRate != dataRate) continue;
+        for (uint8_t p = 0; p < PIPES; ++p) {
+            if (other->pipeOpen[p] && memcmp(other->pipeAddress[p], txAddress, 5) == 0) {
+                pipe = p;
+                return other;
+            }
+        }
+    }
+    return nullptr;
+}
+
+// One payload with auto-retransmit; charges the airtime to the caller's clock
+bool RF24::transmit(const void* buf, uint8_t len) {
+    NativeHAL::Ether& ether = NativeHAL::ether();
+    len = min(len, MAX_PAYLOAD);
+    if (!dynamicPayloads) len = payloadSize;
+
+    for (uint8_t attempt = 0; attempt <= retryCount; ++attempt) {
+        uint32_t cost = airtimeUs(len);
+        uint64_t startUs = NativeHAL::current().nowUs;
+        ether.attempts++;
+        ether.airtimeUs += cost;
+        // On the air before the peers run, so a peer that starts sending
+        // meanwhile sees this attempt (and both collide)
+        ether.onAir(this, channel, startUs, startUs + cost);
+        NativeHAL::advanceMicros(cost);
+        NativeHAL::syncOthers(); // Peers drain their FIFOs meanwhile
+
+        uint8_t pipe = 0;
+        RF24* receiver = findReceiver(pipe);
+        bool lost = attemptLost();
+        if (lost) ether.lost++;
+        if (!lost && ether.collides(this, channel, startUs, startUs + cost)) {
+            ether.collisions++;
+            lost = true;
+        }
+
+        // A full RX FIFO means no ACK, exactly like a missing receiver
+        if (receiver && !lost && receiver->rxFifo.size() < FIFO_DEPTH) {
+            Packet packet;
+            packet.arrivalUs = NativeHAL::current().nowUs;
+            packet.pipe = pipe;
+            packet.length = len;
+            memcpy(packet.data, buf, len);
+            receiver->rxFifo.push_back(packet);
+            ether.delivered++;
+            lastArc = attempt;
+
+            if (receiver->ackPayloads) {
+                for (size_t i = 0; i < receiver->ackFifo.size(); ++i) {
+                    if (receiver->ackFifo[i].pipe != pipe) continue;
+                    Packet ack = receiver->ackFifo[i];
+                    ack.pipe = 0;
+                    ack.arrivalUs = packet.arrivalUs;
+                    receiver->ackFifo.erase(receiver->ackFifo.begin() + i);
+                    if (rxFifo.size() < FIFO_DEPTH) rxFifo.push_back(ack);
+                    break;
+                }
+            }
+            return true;
+        }
+        if (!autoAck) { lastArc = 0; return true; } // Fire and forget
+        if (attempt < retryCount) NativeHAL::advanceMicros((retryDelay + 1) * 250UL);
+    }
+    lastArc = retryCount;
+    ether.failed++;
+    return false;
+}
+
+bool RF24::write(const void* buf, uint8_t len) {
+    maxRetriesHit = false;
+    return transmit(buf, len);
+}
+
+// The simulated FIFO drains instantly, so the only way writeFast() can
+// refuse is a payload still stuck at max retries.
+bool RF24::writeFast(const void* buf, uint8_t len) {
+    if (maxRetriesHit) return false;
+    if (transmit(buf, len)) return true;
+    maxRetriesHit = true;
+    failedPacket.length = min(len, MAX_PAYLOAD);
+    memcpy(failedPacket.data, buf, failedPacket.length);
+    return true; // Accepted into the FIFO; the failure shows up later
+}
+
+bool RF24::txStandBy() {
+    if (!maxRetriesHit) return true;
+    maxRetriesHit = false;
+    return false;
+}
+
+bool RF24::txStandBy(uint32_t timeout, bool) {
+    unsigned long start = millis();
+    while (maxRetriesHit) {
+        if (millis() - start >= timeout) {
+            maxRetriesHit = false; // The driver flushes the TX FIFO on timeout
+            return false;
+        }
+        if (transmit(failedPacket.data, failedPacket.length)) maxRetriesHit = false;
+    }
+    return true;
+}
+
+bool RF24::writeAckPayload(uint8_t pipe, const void* buf, uint8_t len) {
+    if (!ackPayloads || ackFifo.size() >= FIFO_DEPTH) return false;
+    Packet packet;
+    packet.pipe = pipe;
+    packet.length = min(len, MAX_PAYLOAD);
+    memcpy(packet.data, buf, packet.length);
+    ackFifo.push_back(packet);
+    return true;
+}
+
+bool RF24::frontArrived() const {
+    return !rxFifo.empty() && rxFifo.front().arrivalUs <= NativeHAL::current().nowUs;
+}
+
+bool RF24::available() {
+    return frontArrived();
+}
+
+bool RF24::available(uint8_t* pipe) {
+    if (!frontArrived()) return false;
+    if (pipe) *pipe = rxFifo.front().pipe;
+    return true;
+}
+
+uint8_t RF24::getDynamicPayloadSize() {
+    if (!frontArrived()) return 0;
+    return dynamicPayloads ? rxFifo.front().length : payloadSize;
+}
+
+void RF24::read(void* buf, uint8_t len) {
+    if (!frontArrived()) return;
+    Packet& packet = rxFifo.front();
+    memcpy(buf, packet.data, min(len, packet.length));
+    rxFifo.pop_front();
+}
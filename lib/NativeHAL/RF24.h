@@ -0,0 +1,128 @@
+#ifndef NATIVE_HAL_RF24_H
+#define NATIVE_HAL_RF24_H
+
+#include <Arduino.h>
+#include <deque>
+#include <vector>
+
+// Host stand-in for the TMRh20 RF24 driver. Every RF24 object joins one
+// shared "ether": a write is delivered to whichever listening radio has a
+// reading pipe on the destination address, with auto-ack, retries, ack
+// payloads and airtime charged to the sender's virtual clock. Attempts from
+// two radios that overlap in time on one channel collide and are both lost.
+
+typedef enum { RF24_PA_MIN = 0, RF24_PA_LOW, RF24_PA_HIGH, RF24_PA_MAX } rf24_pa_dbm_e;
+typedef enum { RF24_1MBPS = 0, RF24_2MBPS, RF24_250KBPS } rf24_datarate_e;
+
+namespace NativeHAL {
+
+// Simulated link conditions and counters, shared by all radios
+struct Ether {
+    uint8_t lossPercent = 0;     // Chance that one attempt (or its ACK) is lost
+    uint32_t seed = 12345;
+
+    unsigned long attempts = 0;  // Every transmission, retries included
+    unsigned long delivered = 0; // Payloads that reached a receiver FIFO
+    unsigned long lost = 0;      // Attempts lost to lossPercent
+    unsigned long failed = 0;    // Payloads that ran out of retries
+    unsigned long collisions = 0; // Attempts lost to overlapping transmissions
+    unsigned long airtimeUs = 0;
+
+    // Recent attempts (packet and ACK), on each sender's clock
+    struct Transmission {
+        const void* radio;
+        uint8_t channel;
+        uint64_t startUs;
+        uint64_t endUs;
+    };
+    std::deque<Transmission> air;
+
+    void reset();
+    void onAir(const void* radio, uint8_t channel, uint64_t startUs, uint64_t endUs);
+    bool collides(const void* radio, uint8_t channel, uint64_t startUs, uint64_t endUs) const;
+};
+Ether& ether();
+
+} // namespace NativeHAL
+
+class RF24 {
+public:
+    static const uint8_t MAX_PAYLOAD = 32;
+    static const uint8_t FIFO_DEPTH = 3;
+    static const uint8_t PIPES = 6;
+
+private:
+    struct Packet {
+        uint64_t arrivalUs;  // Receiver can't see it before this (its clock)
+        uint8_t pipe;
+        uint8_t length;
+        uint8_t data[MAX_PAYLOAD];
+    };
+
+    bool started = false;
+    bool listening = false;
+    uint8_t channel = 76;
+    rf24_datarate_e dataRate = RF24_1MBPS;
+    uint8_t payloadSize = MAX_PAYLOAD;
+    bool dynamicPayloads = false;
+    bool ackPayloads = false;
+    bool autoAck = true;
+    uint8_t retryDelay = 5;
+    uint8_t retryCount = 15;
+    uint8_t lastArc = 0;
+
+    uint8_t pipeAddress[PIPES][5] = {};
+    bool pipeOpen[PIPES] = {};
+    uint8_t txAddress[5] = {};
+
+    std::deque<Packet> rxFifo;
+    std::deque<Packet> ackFifo;  // Ack payloads waiting for the next PTX
+    bool maxRetriesHit = false;
+    Packet failedPacket;         // Kept for txStandBy() to retry, like the chip
+
+    static std::vector<RF24*>& registry();
+
+    uint32_t airtimeUs(uint8_t length) const;
+    RF24* findReceiver(uint8_t& pipe);
+    bool frontArrived() const;
+    bool transmit(const void* buf, uint8_t len);
+
+public:
+    RF24(uint16_t cePin, uint16_t csnPin);
+    ~RF24();
+
+    bool begin();
+    bool isChipConnected() { return started; }
+    void setChannel(uint8_t ch) { channel = ch; }
+    void setPALevel(uint8_t) {}
+    bool setDataRate(rf24_datarate_e rate) { dataRate = rate; return true; }
+    void setPayloadSize(uint8_t size) { payloadSize = min(size, MAX_PAYLOAD); }
+    void enableDynamicPayloads() { dynamicPayloads = true; }
+    void enableAckPayload() { ackPayloads = true; }
+    void setAutoAck(bool enable) { autoAck = enable; }
+    void setRetries(uint8_t delay, uint8_t count) { retryDelay = delay & 0x0F; retryCount = count & 0x0F; }
+
+    void openReadingPipe(uint8_t pipe, const uint8_t* address);
+    void closeReadingPipe(uint8_t pipe);
+    void openWritingPipe(const uint8_t* address);
+    void startListening();
+    void stopListening();
+
+    bool write(const void* buf, uint8_t len);
+    bool writeFast(const void* buf, uint8_t len);
+    bool txStandBy();
+    bool txStandBy(uint32_t timeout, bool startTx = 0);
+    bool writeAckPayload(uint8_t pipe, const void* buf, uint8_t len);
+    bool isAckPayloadAvailable() { return frontArrived(); }
+    uint8_t getARC() { return lastArc; }
+
+    bool available();
+    bool available(uint8_t* pipe);
+    bool rxFifoFull() { return rxFifo.size() >= FIFO_DEPTH; }
+    uint8_t getDynamicPayloadSize();
+    void read(void* buf, uint8_t len);
+    void flush_rx() { rxFifo.clear(); }
+    void flush_tx() { ackFifo.clear(); maxRetriesHit = false; }
+};
+
+#endif // NATIVE_HAL_RF24_H
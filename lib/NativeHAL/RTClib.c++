@@ -0,0 +1,70 @@
+#include "RTClib.h"
+#include "NativeHAL.h"
+
+namespace {
+const uint32_t SECONDS_PER_DAY = 86400UL;
+
+// Days since 1970-01-01 for a proleptic Gregorian date
+int32_t daysFromCivil(int32_t y, uint32_t m, uint32_t d) {
+    y -= m <= 2;
+    int32_t era = (y >= 0 ? y : y - 399) / 400;
+    uint32_t yoe = (uint32_t)(y - era * 400);
+    uint32_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + (int32_t)doe - 719468;
+}
+
+uint8_t parseTwoDigits(const char* p) {
+    uint8_t v = 0;
+    if (isdigit((unsigned char)p[0])) v = p[0] - '0';
+    if (isdigit((unsigned char)p[1])) v = v * 10 + p[1] - '0';
+    return v;
+}
+}
+
+DateTime::DateTime(uint32_t t) {
+    ss = t % 60; t /= 60;
+    mm = t % 60; t /= 60;
+    hh = t % 24;
+    int32_t z = (int32_t)(t / 24) + 719468;
+    int32_t era = z / 146097;
+    uint32_t doe = (uint32_t)(z - era * 146097);
+    uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    uint32_t mp = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    yOff = (uint16_t)(yoe + era * 400 + (m <= 2));
+}
+
+DateTime::DateTime(uint16_t year, uint8_t month, uint8_t day,
+                   uint8_t hour, uint8_t min, uint8_t sec)
+    : yOff(year), m(month), d(day), hh(hour), mm(min), ss(sec) {}
+
+DateTime::DateTime(const char* date, const char* time) {
+    static const char MONTHS[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+    m = 1;
+    for (uint8_t i = 0; i < 12; ++i) {
+        if (strncmp(date, MONTHS + 3 * i, 3) == 0) { m = i + 1; break; }
+    }
+    d = parseTwoDigits(date + 4);
+    yOff = 2000 + parseTwoDigits(date + 9);
+    hh = parseTwoDigits(time);
+    mm = parseTwoDigits(time + 3);
+    ss = parseTwoDigits(time + 6);
+}
+
+uint32_t DateTime::unixtime() const {
+    return (uint32_t)daysFromCivil(yOff, m, d) * SECONDS_PER_DAY +
+           hh * 3600UL + mm * 60UL + ss;
+}
+
+void RTC_DS3231::adjust(const DateTime& dt) {
+    epochAtZero = dt.unixtime() - (uint32_t)(NativeHAL::current().nowUs / 1000000ULL);
+}
+
+DateTime RTC_DS3231::now() {
+    reads++;
+    NativeHAL::advanceMicros(NativeHAL::RTC_READ_US);
+    return DateTime(epochAtZero + (uint32_t)(NativeHAL::current().nowUs / 1000000ULL));
+}
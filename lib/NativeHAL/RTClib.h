@@ -0,0 +1,43 @@
+#ifndef NATIVE_HAL_RTCLIB_H
+#define NATIVE_HAL_RTCLIB_H
+
+#include <Arduino.h>
+
+// Host stand-in for Adafruit RTClib: just enough DateTime for the logger,
+// and a DS3231 whose time runs on the selected board's virtual clock.
+class DateTime {
+private:
+    uint16_t yOff;
+    uint8_t m, d, hh, mm, ss;
+
+public:
+    explicit DateTime(uint32_t t = 0);
+    DateTime(uint16_t year, uint8_t month, uint8_t day,
+             uint8_t hour = 0, uint8_t min = 0, uint8_t sec = 0);
+    // __DATE__ ("Mmm dd yyyy") and __TIME__ ("hh:mm:ss")
+    DateTime(const char* date, const char* time);
+
+    uint16_t year() const { return yOff; }
+    uint8_t month() const { return m; }
+    uint8_t day() const { return d; }
+    uint8_t hour() const { return hh; }
+    uint8_t minute() const { return mm; }
+    uint8_t second() const { return ss; }
+    uint32_t unixtime() const;
+};
+
+class RTC_DS3231 {
+private:
+    uint32_t epochAtZero = 1735689600UL; // 2025-01-01 00:00:00 at virtual t=0
+    unsigned long reads = 0;
+
+public:
+    bool begin() { return true; }
+    bool lostPower() { return false; }
+    void adjust(const DateTime& dt);
+    DateTime now();
+
+    unsigned long getReadCount() const { return reads; }
+};
+
+#endif // NATIVE_HAL_RTCLIB_H
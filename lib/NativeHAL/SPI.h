@@ -0,0 +1,13 @@
+#ifndef NATIVE_HAL_SPI_H
+#define NATIVE_HAL_SPI_H
+
+#include <Arduino.h>
+
+// The only SPI device is the radio, modelled at the RF24 level
+class SPIClass {
+public:
+    void begin() {}
+};
+extern SPIClass SPI;
+
+#endif // NATIVE_HAL_SPI_H
@@ -0,0 +1,24 @@
+#include "SoftwareSerial.h"
+#include "NativeHAL.h"
+
+const uint8_t SoftwareSerial::RX_BUFFER_SIZE;
+
+int SoftwareSerial::read() {
+    if (rxBuffer.empty()) return -1;
+    uint8_t c = rxBuffer.front();
+    rxBuffer.pop_front();
+    return c;
+}
+
+size_t SoftwareSerial::write(uint8_t c) {
+    txLog += (char)c;
+    NativeHAL::advanceMicros(10000000UL / baud); // Start + 8 data + stop bits
+    return 1;
+}
+
+void SoftwareSerial::inject(const uint8_t* data, size_t length) {
+    for (size_t i = 0; i < length; ++i) {
+        if (rxBuffer.size() >= RX_BUFFER_SIZE) { overflowed = true; continue; }
+        rxBuffer.push_back(data[i]);
+    }
+}
@@ -0,0 +1,39 @@
+#ifndef NATIVE_HAL_SOFTWARE_SERIAL_H
+#define NATIVE_HAL_SOFTWARE_SERIAL_H
+
+#include <Arduino.h>
+#include <deque>
+#include <string>
+
+// Host stand-in for SoftwareSerial. Transmit is bit-banged on the real thing,
+// so each byte sent costs 10 bit times on the caller's clock. The receive
+// side keeps the library's 64-byte buffer and overflow behaviour.
+class SoftwareSerial : public Stream {
+public:
+    static const uint8_t RX_BUFFER_SIZE = 64;
+
+private:
+    unsigned long baud = 9600;
+    std::deque<uint8_t> rxBuffer;
+    std::string txLog;
+    bool overflowed = false;
+
+public:
+    using Print::write;
+
+    SoftwareSerial(uint8_t rxPin, uint8_t txPin) { (void)rxPin; (void)txPin; }
+
+    void begin(long baudRate) { baud = baudRate; }
+    int available() override { return (int)rxBuffer.size(); }
+    int read() override;
+    int peek() override { return rxBuffer.empty() ? -1 : rxBuffer.front(); }
+    size_t write(uint8_t c) override;
+    bool overflow() { bool was = overflowed; overflowed = false; return was; }
+
+    // --- Host side ---
+    void inject(const uint8_t* data, size_t length);
+    void inject(const char* text) { inject((const uint8_t*)text, strlen(text)); }
+    std::string takeOutput() { std::string out; out.swap(txLog); return out; }
+};
+
+#endif // NATIVE_HAL_SOFTWARE_SERIAL_H
@@ -0,0 +1,14 @@
+#ifndef NATIVE_HAL_WIRE_H
+#define NATIVE_HAL_WIRE_H
+
+#include <Arduino.h>
+
+// I2C devices are modelled by their own stand-ins (LCD, RTC)
+class TwoWire {
+public:
+    void begin() {}
+    void setClock(uint32_t) {}
+};
+extern TwoWire Wire;
+
+#endif // NATIVE_HAL_WIRE_H
@@ -0,0 +1,294 @@
+#include "OutboundQueue.h"
+#include <EEPROM.h>
+
+namespace {
+const uint8_t RECORD_QUEUED = 0xA5; // Anything else (0xFF when erased) is free
+const uint8_t RECORD_DONE = 0x00;
+
+const uint8_t OFFSET_STATE = 0;
+const uint8_t OFFSET_SEQUENCE = 1;
+const uint8_t OFFSET_INFO = 3;
+const uint8_t OFFSET_LENGTH = 4;
+}
+
+OutboundQueue::OutboundQueue(RadioInterface& radioLink) : radio(radioLink), jitterState(1) {
+    for (uint8_t i = 0; i < OUTBOX_SLOTS; ++i) entries[i].info = ENTRY_FREE;
+}
+
+void OutboundQueue::begin() {
+    unsigned long now = millis();
+    bool seen = false;
+    uint16_t newest = 0;
+    uint8_t recovered = 0;
+
+    for (uint8_t slot = 0; slot < OUTBOX_SLOTS; ++slot) {
+        uint16_t address = slotAddress(slot);
+        entries[slot].info = ENTRY_FREE;
+        uint8_t state = EEPROM.read(address + OFFSET_STATE);
+        if (state != RECORD_QUEUED && state != RECORD_DONE) continue; // Never used
+
+        // Delivered records still count for the ring position and the IDs
+        uint16_t sequence = EEPROM.read(address + OFFSET_SEQUENCE) |
+                            (uint16_t)EEPROM.read(address + OFFSET_SEQUENCE + 1) << 8;
+        if (!seen || (int16_t)(sequence - newest) > 0) {
+            newest = sequence;
+            nextSlot = (slot + 1) % OUTBOX_SLOTS;
+            seen = true;
+        }
+        if (state != RECORD_QUEUED) continue;
+
+        uint8_t info = EEPROM.read(address + OFFSET_INFO);
+        uint8_t length = EEPROM.read(address + OFFSET_LENGTH);
+        if ((info >> 4) > PRIORITY_NORMAL || (info & 0x0F) > RADIO_MAX_NODES ||
+            length < TEXT_FRAME_HEADER || length > RADIO_MAX_FRAME_LEN) {
+            EEPROM.update(address + OFFSET_STATE, RECORD_DONE); // Not ours
+            continue;
+        }
+        Entry& entry = entries[slot];
+        entry.sequence = sequence;
+        entry.info = info;
+        entry.attempts = 0;
+        entry.dueAt = now;
+        entry.queuedAt = now;
+        recovered++;
+    }
+    if (seen) nextSequence = newest + 1;
+
+    // Different on every unit, so units that failed together spread out
+    jitterState = micros() ^ ((uint32_t)radio.getNodeId() * 2654435761UL) ^ nextSequence;
+
+    if (recovered) {
+        DEBUG_INFO(F("[OUTBOX] ")); DEBUG_INFO(recovered); DEBUG_INFOLN(F(" stored message(s) to send"));
+    }
+}
+
+// Next slot in ring order that holds nothing; an urgent message may take
+// the oldest normal one's
+uint8_t OutboundQueue::freeSlot(MessagePriority priority) {
+    for (uint8_t i = 0; i < OUTBOX_SLOTS; ++i) {
+        uint8_t slot = (nextSlot + i) % OUTBOX_SLOTS;
+        if (entries[slot].info == ENTRY_FREE) return slot;
+    }
+    if (priority != PRIORITY_URGENT) return NO_SLOT;
+
+    uint8_t oldest = NO_SLOT;
+    for (uint8_t slot = 0; slot < OUTBOX_SLOTS; ++slot) {
+        if (slot == inFlight || (stagedSlots & (1 << slot)) ||
+            (entries[slot].info >> 4) != PRIORITY_NORMAL) continue;
+        if (oldest == NO_SLOT || (int16_t)(entries[slot].sequence - entries[oldest].sequence) < 0) {
+            oldest = slot;
+        }
+    }
+    if (oldest != NO_SLOT) {
+        DEBUG_WARNLN(F("[OUTBOX] Full: oldest message dropped"));
+        release(oldest);
+        dropped++;
+    }
+    return oldest;
+}
+
+bool OutboundQueue::enqueue(const char* text, uint8_t toNode, MessagePriority priority) {
+    size_t length = strlen(text);
+    if (length > RADIO_MAX_MESSAGE_LEN) { dropped++; return false; }
+    if (radio.getNodeId() != RADIO_HUB_NODE) toNode = RADIO_HUB_NODE;
+
+    // Back to back: staged behind the records still being written, if the
+    // longest frame this text could take fits (in front of the hub's reply)
+    uint8_t* record = staged + stagedBytes;
+    uint8_t room = (inFlight != NO_SLOT) ? SEND_AREA : OUTBOX_BUFFER_SIZE;
+    if (stagedBytes + OUTBOX_RECORD_HEADER + TextCodec::maxFrameLength(length) > room) {
+        DEBUG_WARNLN(F("[OUTBOX] Busy storing: message refused"));
+        dropped++;
+        return false;
+    }
+    uint8_t slot = freeSlot(priority);
+    if (slot == NO_SLOT) {
+        DEBUG_WARNLN(F("[OUTBOX] Full: message refused"));
+        dropped++;
+        return false;
+    }
+
+    // The slot is taken from here on, but due only once its record is stored
+    uint8_t info = priority << 4 | toNode;
+    record[OFFSET_STATE] = slot;
+    record[OFFSET_SEQUENCE] = nextSequence & 0xFF;
+    record[OFFSET_SEQUENCE + 1] = nextSequence >> 8;
+    record[OFFSET_INFO] = info;
+    record[OFFSET_LENGTH] = TextCodec::encode(text, length, TEXT_ENCODINGS_ALL, record + OUTBOX_RECORD_HEADER);
+    stagedBytes += OUTBOX_RECORD_HEADER + record[OFFSET_LENGTH];
+    stagedSlots |= 1 << slot;
+    releasePending &= ~(1 << slot); // Its first write marks the old record done anyway
+
+    Entry& entry = entries[slot];
+    entry.sequence = nextSequence++;
+    entry.info = info;
+    entry.attempts = 0;
+    entry.dueAt = millis();
+    entry.queuedAt = entry.dueAt;
+    nextSlot = (slot + 1) % OUTBOX_SLOTS;
+    enqueued++;
+    return true;
+}
+
+// Up to `writes` bytes that differ from what the EEPROM holds: done marks
+// first, then the oldest staged record, body first and state byte last (a
+// reset part way leaves the slot free, RECORD_DONE).
+void OutboundQueue::store(uint8_t writes) {
+    while (writes && (stagedBytes || releasePending)) {
+#if defined(__AVR__)
+        if (!eeprom_is_ready()) return; // The last byte is still being written
+#endif
+        uint8_t slot, offset, value;
+        if (releasePending) {
+            slot = 0;
+            while (!(releasePending & (1 << slot))) slot++;
+            releasePending &= ~(1 << slot);
+            offset = OFFSET_STATE;
+            value = RECORD_DONE;
+        } else {
+            slot = staged[OFFSET_STATE];
+            uint8_t length = OUTBOX_RECORD_HEADER + staged[OFFSET_LENGTH];
+            offset = (stagedStep < length) ? stagedStep : OFFSET_STATE;
+            value = (stagedStep == 0) ? RECORD_DONE : (stagedStep < length) ? staged[stagedStep] : RECORD_QUEUED;
+            if (stagedStep++ == length) {
+                // Stored: the next record moves up
+                stagedSlots &= ~(1 << slot);
+                stagedBytes -= length;
+                memmove(staged, staged + length, stagedBytes);
+                stagedStep = 0;
+            }
+        }
+        uint16_t address = slotAddress(slot) + offset;
+        if (EEPROM.read(address) != value) {
+            EEPROM.write(address, value);
+            writes--;
+        }
+    }
+}
+
+// Free in RAM now; update() marks the record done in EEPROM
+void OutboundQueue::release(uint8_t slot) {
+    releasePending |= 1 << slot;
+    entries[slot].info = ENTRY_FREE;
+}
+
+// Most urgent message that is due, oldest first
+uint8_t OutboundQueue::dueSlot(unsigned long now) const {
+    uint8_t best = NO_SLOT;
+    for (uint8_t slot = 0; slot < OUTBOX_SLOTS; ++slot) {
+        const Entry& entry = entries[slot];
+        if (entry.info == ENTRY_FREE || (stagedSlots & (1 << slot)) || (long)(now - entry.dueAt) < 0) continue;
+        if (best == NO_SLOT) { best = slot; continue; }
+        uint8_t priority = entry.info >> 4;
+        uint8_t bestPriority = entries[best].info >> 4;
+        if (priority < bestPriority ||
+            (priority == bestPriority && (int16_t)(entry.sequence - entries[best].sequence) < 0)) {
+            best = slot;
+        }
+    }
+    return best;
+}
+
+unsigned long OutboundQueue::backoffMs(uint8_t attempts) {
+    uint8_t doublings = min(attempts - 1, 6);
+    unsigned long delayMs = min(OUTBOX_RETRY_BASE_MS << doublings, OUTBOX_RETRY_MAX_MS);
+    jitterState = jitterState * 1103515245UL + 12345UL;
+    return delayMs / 2 + (jitterState >> 8) % (delayMs / 2 + 1);
+}
+
+OutboxEvent OutboundQueue::finish(uint8_t slot, bool ok, unsigned long now) {
+    Entry& entry = entries[slot];
+    lastNode = entry.info & 0x0F;
+    lastPriority = (MessagePriority)(entry.info >> 4);
+
+    if (ok) {
+        unsigned long latencyMs = now - entry.queuedAt;
+        latencyTotalMs += latencyMs;
+        latencyMaxMs = max(latencyMaxMs, latencyMs);
+        deliveredCount++;
+        release(slot);
+        return OUTBOX_DELIVERED;
+    }
+    if (lastPriority != PRIORITY_URGENT && entry.attempts >= OUTBOX_MAX_ATTEMPTS) {
+        DEBUG_WARN(F("[OUTBOX] Gave up on message ")); DEBUG_WARNLN((uint8_t)entry.sequence);
+        gaveUp++;
+        release(slot);
+        return OUTBOX_GAVE_UP;
+    }
+    retries++;
+    entry.dueAt = now + backoffMs(entry.attempts);
+    DEBUG_INFO(F("[OUTBOX] Retry ")); DEBUG_INFO(entry.attempts);
+    DEBUG_INFO(F(" in ")); DEBUG_INFO(entry.dueAt - now); DEBUG_INFOLN(F(" ms"));
+    return OUTBOX_RETRYING;
+}
+
+OutboxEvent OutboundQueue::update() {
+    OutboxEvent event = sendDue();
+    // After the attempt: a record completed here is due from the next call
+    store(OUTBOX_STAGE_WRITES);
+    return event;
+}
+
+OutboxEvent OutboundQueue::sendDue() {
+    // Hub: the radio hands the message out in the background
+    if (inFlight != NO_SLOT) {
+        if (radio.isSendPending()) return OUTBOX_IDLE;
+        uint8_t slot = inFlight;
+        inFlight = NO_SLOT;
+        return finish(slot, radio.lastSendDelivered(), millis());
+    }
+
+    uint8_t slot = dueSlot(millis());
+    if (slot == NO_SLOT) return OUTBOX_IDLE;
+    Entry& entry = entries[slot];
+
+    // Hub: a node that isn't polling can't collect it, and handing it to the
+    // radio would hold up the other nodes' messages. It counts as an attempt.
+    if (!radio.isNodeReachable(entry.info & 0x0F)) {
+        entry.attempts++;
+        attemptsTotal++;
+        DEBUG_INFO(F("[OUTBOX] Node ")); DEBUG_INFO(entry.info & 0x0F); DEBUG_INFOLN(F(" not heard from"));
+        return finish(slot, false, millis());
+    }
+
+    // The text goes behind the staged records: wait for them to shrink
+    if (stagedBytes > SEND_AREA) return OUTBOX_IDLE;
+
+    // The frame goes at the end of the buffer and decodes in place
+    char* text = sendText();
+    uint16_t address = slotAddress(slot);
+    uint8_t frameLength = EEPROM.read(address + OFFSET_LENGTH);
+    uint8_t start = RADIO_MAX_FRAME_LEN - frameLength;
+    for (uint8_t i = 0; i < frameLength; ++i) {
+        text[start + i] = EEPROM.read(address + OUTBOX_RECORD_HEADER + i);
+    }
+    if (TextCodec::decode(text, RADIO_MAX_FRAME_LEN, frameLength) < 0) {
+        entry.attempts = OUTBOX_MAX_ATTEMPTS; // Corrupt record: nothing to retry
+        entry.info = PRIORITY_NORMAL << 4 | (entry.info & 0x0F);
+        return finish(slot, false, millis());
+    }
+
+    entry.attempts++;
+    attemptsTotal++;
+    // The ID is the sequence number's low byte: the same on every retry.
+    // The hub reads the text from sendText() until it has been collected.
+    bool ok = radio.sendMessage(text, entry.info & 0x0F, (uint8_t)entry.sequence);
+    if (ok && radio.isSendPending()) {
+        inFlight = slot;
+        return OUTBOX_IDLE;
+    }
+    return finish(slot, ok, millis());
+}
+
+uint8_t OutboundQueue::getDepth() const {
+    uint8_t depth = 0;
+    for (uint8_t slot = 0; slot < OUTBOX_SLOTS; ++slot) {
+        if (entries[slot].info != ENTRY_FREE) depth++;
+    }
+    return depth;
+}
+
+void OutboundQueue::resetStats() {
+    enqueued = deliveredCount = attemptsTotal = retries = gaveUp = dropped = 0;
+    latencyTotalMs = latencyMaxMs = 0;
+}
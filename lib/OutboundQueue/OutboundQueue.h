@@ -0,0 +1,159 @@
+#ifndef OUTBOUND_QUEUE_H
+#define OUTBOUND_QUEUE_H
+
+#include <Arduino.h>
+#include "RadioInterface.h"
+#include "TextCodec.h"
+
+// --- PERSISTENT QUEUE (EEPROM) ---
+// Messages are stored before the first attempt and stay there until they are
+// delivered or given up, so a reset doesn't lose them. The EEPROM area is a
+// ring of fixed-size records written in turn (each new message takes the slot
+// after the newest one), so wear spreads evenly over every slot.
+//   [0] state   [1-2] sequence   [3] priority << 4 | node   [4] frame length
+//   [5..] the text as a TextCodec frame (brevity codes pack to a few bytes)
+// The state byte is written last: a record cut short by a reset never counts.
+// enqueue() only stages the record in RAM; update() writes it a byte at a
+// time, so no loop() waits out more than one 3.3 ms write cycle. Marking a
+// record done (delivered or given up) goes the same way.
+const uint16_t OUTBOX_EEPROM_START = 0;
+const uint8_t OUTBOX_SLOTS = 6;
+const uint8_t OUTBOX_SLOT_SIZE = 128;
+const uint8_t OUTBOX_RECORD_HEADER = 5;
+static_assert(OUTBOX_RECORD_HEADER + RADIO_MAX_FRAME_LEN <= OUTBOX_SLOT_SIZE,
+              "a record must hold the longest frame");
+static_assert(OUTBOX_SLOTS <= 8, "slots are tracked in 8-bit masks");
+const uint8_t OUTBOX_STAGE_WRITES = 1; // EEPROM bytes written per update() (unchanged bytes are free)
+// One buffer for the records waiting for their turn to be written (back to
+// back from the front) and the text of the message being sent (the last
+// RADIO_MAX_FRAME_LEN bytes; on the hub, the radio reads it from there until
+// the node has collected it). It holds the longest record, or a message
+// being sent plus a short record (the duress alert packs to 22 bytes).
+const uint8_t OUTBOX_BUFFER_SIZE = RADIO_MAX_FRAME_LEN + 32;
+static_assert(OUTBOX_RECORD_HEADER + RADIO_MAX_FRAME_LEN <= OUTBOX_BUFFER_SIZE,
+              "the staging area must take the longest record");
+
+// --- RETRIES ---
+// A failed attempt waits base * 2^(attempts - 1), capped, with half of that
+// randomised ("equal jitter"): units that failed together don't retry in step.
+const unsigned long OUTBOX_RETRY_BASE_MS = 1000;
+const unsigned long OUTBOX_RETRY_MAX_MS = 60000;
+const uint8_t OUTBOX_MAX_ATTEMPTS = 8; // Then a normal message is given up; urgent ones never are
+
+// Urgent messages (the duress alert) go before everything else that is due
+enum MessagePriority : uint8_t { PRIORITY_URGENT = 0, PRIORITY_NORMAL = 1 };
+
+// What update() just did, for the status line and the log
+enum OutboxEvent : uint8_t { OUTBOX_IDLE, OUTBOX_DELIVERED, OUTBOX_RETRYING, OUTBOX_GAVE_UP };
+
+/**
+ * @brief Store-and-forward queue in front of RadioInterface::sendMessage().
+ *
+ * enqueue() only stages the message; update() stores and sends, one message
+ * at a time, and never waits: the hub's sends finish in the background
+ * (isSendPending()), a node's take one blocking attempt. On the hub, a
+ * message for a node that isn't polling (RadioInterface::isNodeReachable())
+ * counts a failed attempt without reaching the radio, so it never holds up
+ * the other nodes' messages. Each message keeps its ID (the low byte of its
+ * sequence number) across retries and resets, so the receiver drops the
+ * copies it already has.
+ *
+ * A message is only sent once its record is complete in EEPROM, so a reset
+ * can't lose a message that already went out once. Until then its slot is
+ * taken but not due. A reset before a delivered record is marked done sends
+ * it once more; the receiver drops the copy.
+ *
+ * RAM: 12 bytes per slot, plus the buffer the staging area shares with the
+ * message being sent. Attempt counts are not persisted: after a reset, every
+ * stored message starts over with a fresh attempt budget.
+ */
+class OutboundQueue {
+private:
+    struct Entry {
+        uint16_t sequence;
+        uint8_t info;           // priority << 4 | node; ENTRY_FREE if not queued
+        uint8_t attempts;
+        unsigned long dueAt;    // millis() of the next attempt
+        unsigned long queuedAt; // For the delivery latency (boot, after a reset)
+    };
+    static const uint8_t ENTRY_FREE = 0xFF;
+    static const uint8_t NO_SLOT = 0xFF;
+
+    RadioInterface& radio;
+    Entry entries[OUTBOX_SLOTS];
+    uint16_t nextSequence = 0;
+    uint8_t nextSlot = 0;           // Where the next record goes (ring order)
+    uint8_t inFlight = NO_SLOT;     // Hub: handed to the radio, result pending
+    uint8_t lastNode = 0;
+    MessagePriority lastPriority = PRIORITY_NORMAL;
+    uint32_t jitterState;
+
+    // Records enqueue() staged, oldest first, on their way into EEPROM. Each
+    // is laid out as in EEPROM except byte 0, which holds its slot. Writing
+    // the first one: step 0 marks the slot's old record done, then the body
+    // follows and the state byte last. The message being sent sits behind
+    // them (see OUTBOX_BUFFER_SIZE).
+    uint8_t staged[OUTBOX_BUFFER_SIZE];
+    uint8_t stagedBytes = 0;
+    uint8_t stagedStep = 0;
+    uint8_t stagedSlots = 0;        // Bit n: slot n is staged, not yet stored
+    uint8_t releasePending = 0;     // Bit n: slot n is free, its record not yet marked done
+
+    // Statistics
+    uint16_t enqueued = 0;
+    uint16_t deliveredCount = 0;
+    uint16_t attemptsTotal = 0;
+    uint16_t retries = 0;           // Attempts that failed and were rescheduled
+    uint16_t gaveUp = 0;
+    uint16_t dropped = 0;           // Refused or pushed out while the queue was full
+    unsigned long latencyTotalMs = 0;
+    unsigned long latencyMaxMs = 0;
+
+    static uint16_t slotAddress(uint8_t slot) { return OUTBOX_EEPROM_START + slot * OUTBOX_SLOT_SIZE; }
+    static const uint8_t SEND_AREA = OUTBOX_BUFFER_SIZE - RADIO_MAX_FRAME_LEN; // Where the text goes
+    char* sendText() { return reinterpret_cast<char*>(staged + SEND_AREA); }
+    uint8_t freeSlot(MessagePriority priority);
+    uint8_t dueSlot(unsigned long now) const;
+    void release(uint8_t slot);
+    void store(uint8_t writes);
+    OutboxEvent finish(uint8_t slot, bool ok, unsigned long now);
+    OutboxEvent sendDue();
+    unsigned long backoffMs(uint8_t attempts);
+
+public:
+    explicit OutboundQueue(RadioInterface& radioLink);
+
+    // Reloads the messages that survived a reset. Call once, after the radio.
+    void begin();
+
+    // Stores a message for toNode (ignored on a node: it only talks to the
+    // hub). The record goes to EEPROM over the following update()s, after
+    // any staged before it. Returns false if the text is too long, the queue
+    // is full (an urgent message pushes out the oldest normal one instead)
+    // or the staging area has no room left for it.
+    bool enqueue(const char* text, uint8_t toNode, MessagePriority priority = PRIORITY_NORMAL);
+
+    // Starts the next due attempt or collects the result of the hub's, then
+    // writes a little more of what is staged.
+    OutboxEvent update();
+
+    // The message the last event was about
+    uint8_t getLastNode() const { return lastNode; }
+    MessagePriority getLastPriority() const { return lastPriority; }
+
+    // --- Monitoring ---
+    uint8_t getDepth() const;   // Messages stored, not yet delivered
+    bool isStoring() const { return stagedBytes || releasePending; } // EEPROM writes still to do
+    uint16_t getEnqueued() const { return enqueued; }
+    uint16_t getDelivered() const { return deliveredCount; }
+    uint16_t getAttempts() const { return attemptsTotal; }
+    uint16_t getRetries() const { return retries; }
+    uint16_t getGaveUp() const { return gaveUp; }
+    uint16_t getDropped() const { return dropped; }
+    // Queued to delivered, in ms (from boot for messages that survived a reset)
+    unsigned long getMeanLatencyMs() const { return deliveredCount ? latencyTotalMs / deliveredCount : 0; }
+    unsigned long getMaxLatencyMs() const { return latencyMaxMs; }
+    void resetStats();
+};
+
+#endif // OUTBOUND_QUEUE_H
@@ -1,14 +1,23 @@
 #include "RadioInterface.h"
 
-RadioInterface::RadioInterface(RF24& radioInstance, const byte* address)
-    : radio(radioInstance), pipeAddress(address) {
+RadioInterface::RadioInterface(RF24& radioInstance, const byte* address, uint8_t node)
+    : radio(radioInstance), pipeAddress(address), nodeId(node) {
     // Constructor initializes the reference and pipe address
+    for (uint8_t i = 0; i < RADIO_REASSEMBLY_SLOTS; ++i) slots[i].state = SLOT_FREE;
+    for (uint8_t i = 0; i < RADIO_MAX_NODES; ++i) peerEncodings[i] = 1 << TEXT_ENCODING_RAW;
+    for (uint8_t i = 0; i < RADIO_DEDUP_WINDOW; ++i) delivered[i].checksum = 0;
+    outbox.active = false;
+}
+
+void RadioInterface::nodeAddress(const byte* base, uint8_t node, uint8_t* address) {
+    memcpy(address, base, 5);
+    address[0] += node;
 }
 
 bool RadioInterface::begin() {
     // Initialize the radio
     if (!radio.begin()) {
-        Serial.println(F("Radio hardware not responding!!"));
+        DEBUG_ERRORLN(F("Radio hardware not responding!!"));
         return false;
     }
 
@@ -22,73 +31,463 @@ bool RadioInterface::begin() {
     // Set Data Rate
     radio.setDataRate(RF24_250KBPS); // Slower rate for more reliability/range
 
-    // Set payload size (32 bytes is default)
-    radio.setPayloadSize(32);
-
-    // Set the address
-    // Use openReadingPipe(1, ...) for multi-pipe listening
-    radio.openReadingPipe(0, pipeAddress);
-    
-    // Set the writing pipe to the same address for replies
-    radio.openWritingPipe(pipeAddress);
+    // Fragments carry their own length, so let each payload be only as long
+    // as it needs to be (32 bytes max). Ack payloads need dynamic payloads.
+    radio.setPayloadSize(RADIO_PAYLOAD_SIZE);
+    radio.enableDynamicPayloads();
+    radio.enableAckPayload();
 
-    // Set retries (15 max) and delay (5*250us = 1250us)
-    radio.setRetries(15, 15);
+    uint8_t address[5];
+    if (isHub()) {
+        // One pipe per node; the hub only ever listens
+        for (uint8_t node = 1; node <= RADIO_MAX_NODES; ++node) {
+            nodeAddress(pipeAddress, node, address);
+            radio.openReadingPipe(node - 1, address);
+        }
+        startListening();
+    } else {
+        // Also becomes the pipe 0 address the ACKs (and ack payloads) come back on
+        nodeAddress(pipeAddress, nodeId, address);
+        radio.openWritingPipe(address);
 
-    // Start in listening mode
-    startListening();
+        // Staggered retry delay (max 15 retries); the hub's 32-byte ack
+        // payloads need at least 1500 us at 250 kbps, which every node has
+        radio.setRetries(RADIO_RETRY_DELAY - nodeId, RADIO_MAX_RETRIES);
+        radio.stopListening(); // TX standby from here on
+        pollInterval = 0;      // Poll right away
+    }
     
     return true;
 }
 
 void RadioInterface::startListening() {
-    radio.startListening();
+    if (isHub()) radio.startListening();
+}
+
+void RadioInterface::setTextEncodings(uint8_t encodings) {
+    textEncodings = encodings | (1 << TEXT_ENCODING_RAW);
+}
+
+uint8_t RadioInterface::getTextEncodings(uint8_t node) const {
+    if (isHub()) {
+        if (node == RADIO_HUB_NODE || node > RADIO_MAX_NODES) return 1 << TEXT_ENCODING_RAW;
+        return textEncodings & peerEncodings[node - 1];
+    }
+    return textEncodings & peerEncodings[0];
+}
+
+uint8_t RadioInterface::encodeFrame(const char* message, uint8_t length, uint8_t peer,
+                                    uint8_t* frame) {
+    uint8_t frameLength = TextCodec::encode(message, length, getTextEncodings(peer), frame);
+    txTextBytes += length;
+    txFrameBytes += frameLength;
+    return frameLength;
 }
 
-bool RadioInterface::sendMessage(const String& message) {
-    radio.stopListening(); // Stop listening to transmit
+uint8_t RadioInterface::fragmentCount(uint8_t length) {
+    return (length == 0) ? 1 : (length + RADIO_FRAGMENT_DATA - 1) / RADIO_FRAGMENT_DATA;
+}
+
+// Header plus this fragment's slice of the frame; returns the payload size
+uint8_t RadioInterface::buildFragment(uint8_t* packet, uint8_t messageId, uint8_t index,
+                                      const uint8_t* frame, uint8_t length) {
+    uint8_t offset = index * RADIO_FRAGMENT_DATA;
+    uint8_t chunk = min((uint8_t)RADIO_FRAGMENT_DATA, (uint8_t)(length - offset));
+    packet[0] = messageId;
+    packet[1] = (index << 4) | fragmentCount(length);
+    packet[2] = length;
+    memcpy(packet + RADIO_HEADER_SIZE, frame + offset, chunk);
+    return RADIO_HEADER_SIZE + chunk;
+}
 
-    // Ensure message fits in 32 bytes
-    if (message.length() > 32) {
-        Serial.println(F("Error: Message too long."));
-        startListening(); // Go back to listening
+bool RadioInterface::sendMessage(const char* message, uint8_t toNode) {
+    return sendMessage(message, toNode, nextMessageId++);
+}
+
+bool RadioInterface::sendMessage(const char* message, uint8_t toNode, uint8_t messageId) {
+    unsigned int length = strlen(message);
+    if (length > RADIO_MAX_MESSAGE_LEN) {
+        DEBUG_WARNLN(F("Error: Message too long."));
         return false;
     }
 
-    // Convert String to char array
-    char sendBuffer[33];
-    message.toCharArray(sendBuffer, 33);
+    if (!isHub()) {
+        lastSendOk = transmitMessage(message, length, messageId);
+        return lastSendOk;
+    }
 
-    // Send the message
-    Serial.print(F("Sending message: "));
-    Serial.println(sendBuffer);
+    // Hub: park the reply until the node's polls collect it
+    if (outbox.active || toNode == RADIO_HUB_NODE || toNode > RADIO_MAX_NODES) return false;
+    uint8_t frame[RADIO_MAX_FRAME_LEN];
+    outbox.active = true;
+    outbox.loaded = false;
+    outbox.node = toNode;
+    outbox.messageId = messageId;
+    outbox.encodings = getTextEncodings(toNode);
+    outbox.length = encodeFrame(message, length, toNode, frame);
+    outbox.nextFragment = 0;
+    outbox.text = message;
+    outbox.queuedAt = millis();
+    txMessages++;
 
-    bool tx_ok = radio.write(&sendBuffer, strlen(sendBuffer) + 1); // +1 for null terminator
+    DEBUG_INFO(F("Queued for node ")); DEBUG_INFO(toNode);
+    DEBUG_INFO(F(": ")); DEBUG_INFOLN(message);
+    return true;
+}
+
+// Node: fragments written back-to-back, acknowledged in a pipeline
+bool RadioInterface::transmitMessage(const char* message, uint8_t length, uint8_t messageId) {
+    uint8_t frame[RADIO_MAX_FRAME_LEN];
+    uint8_t frameLength = encodeFrame(message, length, RADIO_HUB_NODE, frame);
+    uint8_t count = fragmentCount(frameLength);
+
+    DEBUG_INFO(F("Sending message: "));
+    DEBUG_INFOLN(message);
+
+    txMessages++;
+    unsigned long startMicros = micros();
+    bool tx_ok = true;
+
+    for (uint8_t index = 0; index < count && tx_ok; ++index) {
+        uint8_t packet[RADIO_PAYLOAD_SIZE];
+        uint8_t size = buildFragment(packet, messageId, index, frame, frameLength);
+
+        // Queue behind the fragments still in flight. If an earlier one hit
+        // max retries, txStandBy() keeps retrying it until the timeout.
+        while (!radio.writeFast(packet, size)) {
+            txRetryStalls++;
+            txRetries += RADIO_MAX_RETRIES;
+            if (!radio.txStandBy(RADIO_TX_TIMEOUT_MS)) { tx_ok = false; break; }
+        }
+        if (tx_ok) txFragments++;
+        // Reply fragments may come back on these ACKs; keep the RX FIFO clear
+        drainRxFifo();
+    }
+    // Wait for the last fragments to be acknowledged
+    if (tx_ok) tx_ok = radio.txStandBy(RADIO_TX_TIMEOUT_MS);
+    unsigned long elapsed = micros() - startMicros;
+    // With fragments pipelined, ARC only covers the last one; earlier
+    // fragments show up here only if they stalled, so this is a lower bound.
+    if (tx_ok) txRetries += radio.getARC();
+    drainRxFifo();
 
     if (!tx_ok) {
-        Serial.println(F("Transmission failed."));
+        txFailures++;
+        DEBUG_WARNLN(F("Transmission failed."));
     } else {
-        Serial.println(F("Transmission successful."));
+        lastTxBytes = length;
+        lastTxMicros = elapsed;
+        lastPollTime = millis(); // The data packets polled the hub as well
+        DEBUG_INFO(F("Transmission successful: "));
+        DEBUG_INFO(length); DEBUG_INFO(F(" bytes ("));
+        DEBUG_INFO(frameLength); DEBUG_INFO(F(" on air), "));
+        DEBUG_INFO(count); DEBUG_INFO(F(" frag, "));
+        DEBUG_INFO(elapsed); DEBUG_INFO(F(" us, "));
+        DEBUG_INFO(getLastThroughputBps()); DEBUG_INFOLN(F(" B/s"));
     }
-
-    startListening(); // Always return to listening mode
     return tx_ok;
 }
 
-bool RadioInterface::isMessageAvailable() {
-    return radio.available();
+void RadioInterface::resetStats() {
+    evictedMessages = malformedFragments = duplicateMessages = 0;
+    txMessages = txFailures = txFragments = txRetries = txRetryStalls = 0;
+#if !defined(__AVR__)
+    rxMessages = 0;
+#endif
+    polls = failedPolls = 0;
+    txTextBytes = txFrameBytes = 0;
 }
 
-String RadioInterface::getMessage() {
-    if (radio.available()) {
-        // Read the data into the buffer
-        radio.read(&receiveBuffer, sizeof(receiveBuffer));
-        
-        // Ensure null-termination for safety
-        receiveBuffer[32] = '\0'; 
-        
-        return String(receiveBuffer);
+unsigned long RadioInterface::getLastThroughputBps() const {
+    if (lastTxMicros == 0) return 0;
+    return (unsigned long)lastTxBytes * 1000000UL / lastTxMicros;
+}
+
+// --- Hub: replies as ack payloads ---
+
+// A packet from a node arrived, so the ACK that answered it carried whatever
+// was loaded for the node: an encodings announcement or a reply fragment
+// (never both at once). Returns true if it was an announcement.
+// (A packet that slipped in between draining the FIFO and loading the
+// payload is miscounted; the node's reassembly timeout then drops the message.)
+bool RadioInterface::ackPayloadCollected(uint8_t node) {
+    uint8_t bit = 1 << (node - 1);
+    if (announceLoaded & bit) {
+        announceLoaded &= ~bit;
+        announcePending &= ~bit;
+        return true;
     }
-    
-    return ""; // Return empty string if no message
-}
\ No newline at end of file
+    if (!outbox.active || !outbox.loaded || node != outbox.node) return false;
+    outbox.loaded = false;
+    txFragments++;
+    if (++outbox.nextFragment == fragmentCount(outbox.length)) {
+        outbox.active = false;
+        lastSendOk = true;
+    }
+    return false;
+}
+
+void RadioInterface::handlePoll(uint8_t node, uint8_t encodings, bool justAnnounced) {
+    polls++;
+    peerEncodings[node - 1] = (encodings & ~RADIO_ENCODINGS_REQUEST) | (1 << TEXT_ENCODING_RAW);
+    // A poll that collected the answer was sent before the node had it
+    if ((encodings & RADIO_ENCODINGS_REQUEST) && !justAnnounced) {
+        announcePending |= 1 << (node - 1);
+    }
+}
+
+bool RadioInterface::isNodeReachable(uint8_t node) const {
+    if (!isHub()) return true;
+    return node != RADIO_HUB_NODE && node <= RADIO_MAX_NODES && (heardNodes & (1 << (node - 1)));
+}
+
+void RadioInterface::expireSilentNodes() {
+    uint16_t now = millis() >> RADIO_HEARD_TICK_SHIFT;
+    for (uint8_t node = 1; node <= RADIO_MAX_NODES; ++node) {
+        uint8_t bit = 1 << (node - 1);
+        if ((heardNodes & bit) &&
+            (uint16_t)(now - lastHeard[node - 1]) >= (RADIO_NODE_SILENT_MS >> RADIO_HEARD_TICK_SHIFT)) {
+            heardNodes &= ~bit;
+        }
+    }
+}
+
+void RadioInterface::loadAckPayload() {
+    expireSilentNodes();
+    // Waiting on a node that went quiet would hold up every other node's replies
+    if (outbox.active && (!isNodeReachable(outbox.node) ||
+                          millis() - outbox.queuedAt >= RADIO_OUTBOX_TIMEOUT_MS)) {
+        radio.flush_tx(); // Drop the uncollected ack payloads
+        announceLoaded = 0; // (Still pending: reloaded below)
+        outbox.active = false;
+        lastSendOk = false;
+        txFailures++;
+        DEBUG_WARN(F("Reply not collected by node ")); DEBUG_WARNLN(outbox.node);
+    }
+
+    // Announcements first: they're one byte and unblock compression
+    for (uint8_t node = 1; node <= RADIO_MAX_NODES; ++node) {
+        uint8_t bit = 1 << (node - 1);
+        if (!(announcePending & bit) || (announceLoaded & bit)) continue;
+        if (outbox.active && outbox.loaded && outbox.node == node) continue;
+        if (!radio.writeAckPayload(node - 1, &textEncodings, RADIO_POLL_SIZE)) break;
+        announceLoaded |= bit;
+    }
+
+    if (!outbox.active || outbox.loaded || (announceLoaded & (1 << (outbox.node - 1)))) return;
+
+    // The same text and encodings give the same frame every time
+    uint8_t frame[RADIO_MAX_FRAME_LEN];
+    TextCodec::encode(outbox.text, strlen(outbox.text), outbox.encodings, frame);
+    uint8_t packet[RADIO_PAYLOAD_SIZE];
+    uint8_t size = buildFragment(packet, outbox.messageId, outbox.nextFragment,
+                                 frame, outbox.length);
+    outbox.loaded = radio.writeAckPayload(outbox.node - 1, packet, size);
+}
+
+// --- Node: polling the hub ---
+
+void RadioInterface::pollHub() {
+    if (millis() - lastPollTime < pollInterval) return;
+
+    uint8_t poll = textEncodings | (hubEncodingsKnown ? 0 : RADIO_ENCODINGS_REQUEST);
+    polls++;
+    bool acked = radio.write(&poll, RADIO_POLL_SIZE);
+    lastPollTime = millis();
+    if (!acked) {
+        failedPolls++;
+        pollInterval = RADIO_POLL_BACKOFF_MS;
+        return;
+    }
+    // A reply fragment on the ACK: ask for the next one straight away
+    pollInterval = radio.available() ? 0 : RADIO_POLL_INTERVAL_MS;
+    drainRxFifo();
+}
+
+// --- Reassembly ---
+
+RadioInterface::ReassemblySlot* RadioInterface::findSlot(uint8_t node, uint8_t messageId) {
+    for (uint8_t i = 0; i < RADIO_REASSEMBLY_SLOTS; ++i) {
+        if (slots[i].state == SLOT_ASSEMBLING && slots[i].node == node &&
+            slots[i].messageId == messageId) return &slots[i];
+    }
+    return nullptr;
+}
+
+// Takes a free slot, or sacrifices the oldest incomplete message.
+// Complete messages are never evicted: they wait for getMessage().
+RadioInterface::ReassemblySlot* RadioInterface::allocateSlot() {
+    ReassemblySlot* oldest = nullptr;
+    for (uint8_t i = 0; i < RADIO_REASSEMBLY_SLOTS; ++i) {
+        if (slots[i].state == SLOT_FREE) return &slots[i];
+        if (slots[i].state == SLOT_ASSEMBLING &&
+            (!oldest || (long)(slots[i].startTime - oldest->startTime) < 0)) {
+            oldest = &slots[i];
+        }
+    }
+    if (oldest) evictedMessages++;
+    return oldest;
+}
+
+void RadioInterface::evictExpired() {
+    unsigned long now = millis();
+    for (uint8_t i = 0; i < RADIO_REASSEMBLY_SLOTS; ++i) {
+        if (slots[i].state == SLOT_ASSEMBLING && now - slots[i].startTime >= RADIO_REASSEMBLY_TIMEOUT_MS) {
+            slots[i].state = SLOT_FREE;
+            evictedMessages++;
+        }
+    }
+}
+
+void RadioInterface::handleFragment(uint8_t node, const uint8_t* packet, uint8_t size) {
+    if (size < RADIO_HEADER_SIZE) { malformedFragments++; return; }
+
+    uint8_t messageId = packet[0];
+    uint8_t index = packet[1] >> 4;
+    uint8_t count = packet[1] & 0x0F;
+    uint8_t length = packet[2];
+    uint8_t offset = index * RADIO_FRAGMENT_DATA;
+
+    if (length < TEXT_FRAME_HEADER || length > RADIO_MAX_FRAME_LEN ||
+        count != fragmentCount(length) || index >= count ||
+        size - RADIO_HEADER_SIZE != min(RADIO_FRAGMENT_DATA, (uint8_t)(length - offset))) {
+        malformedFragments++;
+        return;
+    }
+
+    ReassemblySlot* slot = findSlot(node, messageId);
+    if (slot && (slot->length != length || slot->fragmentCount != count)) {
+        // Same ID, different message: the sender restarted. Start over.
+        slot->state = SLOT_FREE;
+        evictedMessages++;
+        slot = nullptr;
+    }
+    if (!slot) {
+        slot = allocateSlot();
+        if (!slot) { evictedMessages++; return; } // All slots hold unread messages
+        slot->state = SLOT_ASSEMBLING;
+        slot->node = node;
+        slot->messageId = messageId;
+        slot->fragmentCount = count;
+        slot->receivedMask = 0;
+        slot->length = length;
+        slot->startTime = millis();
+    }
+
+    // Frames are kept at the end of the slot, for TextCodec::decode()
+    memcpy(slot->data + (RADIO_MAX_FRAME_LEN - length) + offset, packet + RADIO_HEADER_SIZE,
+           size - RADIO_HEADER_SIZE);
+    slot->receivedMask |= (1 << index);
+    if (slot->receivedMask != (1 << count) - 1) return;
+
+    int textLength = TextCodec::decode(slot->data, RADIO_MAX_FRAME_LEN, length);
+    if (textLength < 0) {
+        slot->state = SLOT_FREE; // Unknown encoding or corrupt frame
+        malformedFragments++;
+        return;
+    }
+    if (isDuplicate(node, messageId, slot->data, textLength)) {
+        slot->state = SLOT_FREE; // A retry of something already delivered
+        duplicateMessages++;
+        return;
+    }
+    slot->state = SLOT_COMPLETE;
+}
+
+// True if this message was delivered before; otherwise remembers it
+bool RadioInterface::isDuplicate(uint8_t node, uint8_t messageId, const char* text, uint8_t length) {
+    uint8_t checksum = length;
+    for (uint8_t i = 0; i < length; ++i) checksum = (checksum << 1 | checksum >> 7) ^ text[i];
+    if (checksum == 0) checksum = 1; // 0 marks an unused entry
+
+    for (uint8_t i = 0; i < RADIO_DEDUP_WINDOW; ++i) {
+        if (delivered[i].checksum == checksum && delivered[i].node == node &&
+            delivered[i].messageId == messageId) return true;
+    }
+    Delivered& entry = delivered[deliveredNext];
+    deliveredNext = (deliveredNext + 1) % RADIO_DEDUP_WINDOW;
+    entry.node = node;
+    entry.messageId = messageId;
+    entry.checksum = checksum;
+    return false;
+}
+
+// Everything in the RX FIFO: fragments and polls on the hub, ack payloads
+// (always from the hub: fragments, or its encodings) on a node
+void RadioInterface::drainRxFifo() {
+    uint8_t pipe = 0;
+    while (radio.available(&pipe)) {
+        uint8_t size = radio.getDynamicPayloadSize(); // Flushes corrupt (>32) payloads
+        if (size == 0) { malformedFragments++; continue; }
+
+        uint8_t packet[RADIO_PAYLOAD_SIZE];
+        radio.read(packet, size);
+
+        if (!isHub()) {
+            if (size == RADIO_POLL_SIZE) {
+                peerEncodings[0] = packet[0] | (1 << TEXT_ENCODING_RAW);
+                hubEncodingsKnown = true;
+            } else {
+                handleFragment(RADIO_HUB_NODE, packet, size);
+            }
+            continue;
+        }
+
+        uint8_t node = pipe + 1;
+        heardNodes |= 1 << (node - 1);
+        lastHeard[node - 1] = millis() >> RADIO_HEARD_TICK_SHIFT;
+        bool announced = ackPayloadCollected(node);
+        if (size == RADIO_POLL_SIZE) {
+            handlePoll(node, packet[0], announced);
+        } else {
+            handleFragment(node, packet, size);
+        }
+    }
+}
+
+void RadioInterface::pollRadio() {
+    // The caller is done with the message it was lent
+    if (readingSlot) {
+        readingSlot->state = SLOT_FREE;
+        readingSlot = nullptr;
+    }
+
+    drainRxFifo();
+    evictExpired();
+}
+
+// Oldest fully reassembled message, if any
+RadioInterface::ReassemblySlot* RadioInterface::completedSlot() {
+    ReassemblySlot* oldest = nullptr;
+    for (uint8_t i = 0; i < RADIO_REASSEMBLY_SLOTS; ++i) {
+        if (slots[i].state == SLOT_COMPLETE &&
+            (!oldest || (long)(slots[i].startTime - oldest->startTime) < 0)) {
+            oldest = &slots[i];
+        }
+    }
+    return oldest;
+}
+
+bool RadioInterface::isMessageAvailable() {
+    pollRadio();
+    if (isHub()) {
+        loadAckPayload();
+    } else {
+        pollHub();
+    }
+    return completedSlot() != nullptr;
+}
+
+const char* RadioInterface::getMessage(uint8_t* fromNode) {
+    pollRadio();
+    ReassemblySlot* slot = completedSlot();
+    if (!slot) return ""; // Return empty string if no message
+
+    slot->state = SLOT_READING;
+    readingSlot = slot;
+#if !defined(__AVR__)
+    rxMessages++;
+#endif
+    if (fromNode) *fromNode = slot->node;
+    return slot->data;
+}
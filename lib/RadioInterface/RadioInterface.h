@@ -4,49 +4,298 @@
 #include <Arduino.h>
 #include <SPI.h>
 #include <RF24.h> // Make sure you have the 'RF24' library by TMRh20
+#include "DebugLog.h"
+#include "TextCodec.h"
+
+// --- LINK LAYER ---
+// A message goes out as a TextCodec frame (encoding byte + body), split into
+// fragments, each one radio payload with a small header:
+//   [0] message ID   [1] index << 4 | count   [2] total frame length
+// Payloads are dynamic-length, so short fragments cost less airtime, and no
+// null terminator goes over the air.
+const uint8_t RADIO_PAYLOAD_SIZE = 32;
+const uint8_t RADIO_HEADER_SIZE = 3;
+const uint8_t RADIO_FRAGMENT_DATA = RADIO_PAYLOAD_SIZE - RADIO_HEADER_SIZE; // 29
+// As long as anything a unit types or expands (MESSAGE_BUFFER_LEN, BT_MAX_LINE):
+// every buffer a message passes through is sized from this
+const uint8_t RADIO_MAX_MESSAGE_LEN = 64;
+const uint8_t RADIO_MAX_FRAME_LEN = RADIO_MAX_MESSAGE_LEN + TEXT_FRAME_HEADER; // 65 (RAW)
+const uint8_t RADIO_MAX_FRAGMENTS =
+    (RADIO_MAX_FRAME_LEN + RADIO_FRAGMENT_DATA - 1) / RADIO_FRAGMENT_DATA; // 3
+
+// Reassembly: partially received messages are dropped after this long
+const uint8_t RADIO_REASSEMBLY_SLOTS = 2;
+const unsigned long RADIO_REASSEMBLY_TIMEOUT_MS = 500;
+// Duplicates: a sender that missed the final ACK sends the whole message
+// again under the same ID. The receiver remembers the last few messages it
+// delivered (sender, ID, checksum) and drops a repeat.
+const uint8_t RADIO_DEDUP_WINDOW = 8;
+
+// Max time to wait for the TX FIFO to drain (auto-retries included)
+const uint32_t RADIO_TX_TIMEOUT_MS = 100;
+// Hardware auto-retransmits per payload (the chip's maximum)
+const uint8_t RADIO_MAX_RETRIES = 15;
+// Delay between retransmits, in 250 us steps. Each node subtracts its ID, so
+// two nodes whose packets collided don't collide again on every retry.
+const uint8_t RADIO_RETRY_DELAY = 15;
+
+// --- STAR NETWORK ---
+// One hub (the admin, node 0) and up to six field nodes (spies, 1-6).
+// Node n transmits to the base address with n added to byte 0, and the hub
+// listens for it on pipe n - 1. (Pipes 2-5 can only differ from pipe 1 in
+// that byte, so it is the only one that varies.)
+// The hub never leaves RX: replies ride back to a node on the ACK of the
+// node's next packet (ack payloads), so idle nodes poll with 1-byte packets.
+const uint8_t RADIO_HUB_NODE = 0;
+const uint8_t RADIO_MAX_NODES = 6;
+const uint8_t RADIO_POLL_SIZE = 1;                 // Shorter than any fragment
+const unsigned long RADIO_POLL_INTERVAL_MS = 250;  // Idle node asks for replies
+const unsigned long RADIO_POLL_BACKOFF_MS = 2000;  // ...after the hub didn't answer
+// A node the hub hasn't heard from (data or poll) for this long is taken to
+// be off the air (longer than an idle node's poll backoff). Its reply is
+// dropped and counted as a TX failure, freeing the hub for the other nodes;
+// OutboundQueue holds its messages back until it is heard again.
+const unsigned long RADIO_NODE_SILENT_MS = 3000;
+const uint8_t RADIO_HEARD_TICK_SHIFT = 4;          // Last-heard times in 16 ms ticks
+// A reply still not collected after this long is dropped all the same
+const unsigned long RADIO_OUTBOX_TIMEOUT_MS = 10000;
+
+// --- ENCODING NEGOTIATION ---
+// A poll's single byte is the node's TextCodec encoding mask, plus this bit
+// while the node doesn't know the hub's. The hub answers such a poll with its
+// own mask as a 1-byte ack payload. Until then both sides send RAW.
+const uint8_t RADIO_ENCODINGS_REQUEST = 0x80;
 
 class RadioInterface {
 private:
     RF24& radio; // A reference to the RF24 object
-    const byte* pipeAddress;
-    char receiveBuffer[33]; // Holds incoming messages (32 bytes + null terminator)
+    const byte* pipeAddress; // Base address, shared by the whole network
+    uint8_t nodeId;
+
+    enum SlotState { SLOT_FREE, SLOT_ASSEMBLING, SLOT_COMPLETE, SLOT_READING };
+    struct ReassemblySlot {
+        SlotState state;
+        uint8_t node;           // Sender; message IDs are only unique per node
+        uint8_t messageId;
+        uint8_t fragmentCount;
+        uint8_t receivedMask;   // Bit n set once fragment n arrived
+        uint8_t length;
+        unsigned long startTime;
+        // The frame is assembled at the end, then decoded in place into text
+        char data[RADIO_MAX_FRAME_LEN];
+    };
+    ReassemblySlot slots[RADIO_REASSEMBLY_SLOTS];
+    ReassemblySlot* readingSlot = nullptr; // Lent out by getMessage()
+
+    uint8_t nextMessageId = 0;
+
+    // Recently delivered messages, oldest overwritten first
+    struct Delivered {
+        uint8_t node;
+        uint8_t messageId;
+        uint8_t checksum;       // Of the decoded text; 0 marks an unused entry
+    };
+    Delivered delivered[RADIO_DEDUP_WINDOW];
+    uint8_t deliveredNext = 0;
+
+    // Hub only: the reply waiting to be collected, one fragment at a time.
+    // A single slot keeps RAM down; a second reply is refused until it's gone.
+    // The text stays in the caller's buffer and is encoded again for each
+    // fragment, so no copy of it is held here.
+    struct Outbox {
+        bool active;
+        bool loaded;            // Current fragment sits in the chip's ack FIFO
+        uint8_t node;
+        uint8_t messageId;
+        uint8_t encodings;      // Fixed when queued, so every fragment agrees
+        uint8_t length;         // Of the frame
+        uint8_t nextFragment;
+        unsigned long queuedAt;
+        const char* text;       // The caller's, see sendMessage()
+    };
+    Outbox outbox;
+    bool lastSendOk = false;
+
+    // Encodings: ours, and what the peers decode (hub: per node; node: [0] is
+    // the hub). Peers count as RAW-only until they tell us otherwise.
+    uint8_t textEncodings = TEXT_ENCODINGS_ALL;
+    uint8_t peerEncodings[RADIO_MAX_NODES];
+    bool hubEncodingsKnown = false;   // Node: the hub has answered
+    uint8_t announcePending = 0;      // Hub: bit n - 1 set if node n asked
+    uint8_t announceLoaded = 0;       // ...and its answer is in the ack FIFO
+
+    // Hub only: nodes heard within RADIO_NODE_SILENT_MS (bit n - 1), and when
+    // (millis() >> RADIO_HEARD_TICK_SHIFT; stale bits are cleared before the
+    // 16-bit ticks wrap)
+    uint8_t heardNodes = 0;
+    uint16_t lastHeard[RADIO_MAX_NODES];
+
+    // Node only: poll schedule
+    unsigned long lastPollTime = 0;
+    unsigned long pollInterval = 0;
+
+    // Statistics
+    uint16_t evictedMessages = 0;   // Timed out or pushed out while incomplete
+    uint16_t malformedFragments = 0;
+    uint16_t duplicateMessages = 0; // Complete, but delivered before
+    uint16_t txMessages = 0;        // sendMessage() calls
+    uint16_t txFailures = 0;        // ...that were not fully acknowledged
+    uint16_t txFragments = 0;       // Payloads handed to the TX FIFO
+    uint16_t txRetries = 0;         // Auto-retransmits (see sendMessage())
+    uint16_t txRetryStalls = 0;     // Payloads that used up every retry
+    uint16_t polls = 0;             // Sent (node) or received (hub)
+    uint16_t failedPolls = 0;       // Node: hub didn't acknowledge
+    unsigned long txTextBytes = 0;  // Message text handed to sendMessage()
+    unsigned long txFrameBytes = 0; // ...and what it encoded to
+    uint8_t lastTxBytes = 0;
+    unsigned long lastTxMicros = 0;
+#if !defined(__AVR__)
+    uint16_t rxMessages = 0;        // Host: handed out by getMessage()
+#endif
+
+    bool isHub() const { return nodeId == RADIO_HUB_NODE; }
+    static void nodeAddress(const byte* base, uint8_t node, uint8_t* address);
+    static uint8_t fragmentCount(uint8_t length);
+    static uint8_t buildFragment(uint8_t* packet, uint8_t messageId, uint8_t index,
+                                 const uint8_t* frame, uint8_t length);
+
+    void pollRadio();
+    void drainRxFifo();
+    void handleFragment(uint8_t node, const uint8_t* packet, uint8_t size);
+    void handlePoll(uint8_t node, uint8_t encodings, bool justAnnounced);
+    bool ackPayloadCollected(uint8_t node);
+    void loadAckPayload();
+    void expireSilentNodes();
+    void pollHub();
+    uint8_t encodeFrame(const char* message, uint8_t length, uint8_t peer, uint8_t* frame);
+    bool transmitMessage(const char* message, uint8_t length, uint8_t messageId);
+    bool isDuplicate(uint8_t node, uint8_t messageId, const char* text, uint8_t length);
+    ReassemblySlot* findSlot(uint8_t node, uint8_t messageId);
+    ReassemblySlot* allocateSlot();
+    void evictExpired();
+    ReassemblySlot* completedSlot();
 
 public:
     /**
      * @brief Constructor for the Radio Interface.
      * @param radioInstance An initialized RF24 object.
-     * @param pipeAddress A 5-byte array representing the pipe address.
+     * @param pipeAddress A 5-byte array, the network's base address.
+     * @param node RADIO_HUB_NODE for the admin, 1-RADIO_MAX_NODES for a spy.
      */
-    RadioInterface(RF24& radioInstance, const byte* pipeAddress);
+    RadioInterface(RF24& radioInstance, const byte* pipeAddress, uint8_t node);
 
     /**
-     * @brief Initializes the radio hardware.
+     * @brief Initializes the radio hardware. The hub opens one reading pipe
+     * per node and stays in RX; a node sets up its TX address and stays in TX
+     * standby (it only hears the hub through ack payloads).
      */
     bool begin();
 
     /**
-     * @brief Switches the radio into receiver mode.
+     * @brief Switches the radio into receiver mode (hub only).
      */
     void startListening();
 
     /**
-     * @brief Sends a message.
-     * @param message The String message to send (max 32 bytes).
-     * @return True on success, false on failure.
+     * @brief Sends a message, fragmenting it as needed.
+     * A node writes its fragments back-to-back into the TX FIFO and blocks
+     * until they are acknowledged (toNode is ignored: nodes only talk to the
+     * hub). The hub can't transmit, so it queues the message for toNode and
+     * hands it out one fragment per poll; see isSendPending(). The hub does
+     * not copy the message: it must stay unchanged until isSendPending() is
+     * false.
+     * @param message Null-terminated text (max RADIO_MAX_MESSAGE_LEN bytes).
+     * @param toNode Destination node (hub only).
+     * @return Node: true if every fragment was acknowledged.
+     *         Hub: true if queued (false if a reply is still pending).
+     */
+    bool sendMessage(const char* message, uint8_t toNode = RADIO_HUB_NODE);
+
+    /**
+     * @brief The same, under a message ID chosen by the caller. A retry that
+     * reuses the ID of a message the receiver already has is dropped there
+     * (see RADIO_DEDUP_WINDOW), so retrying after a lost ACK is safe.
+     */
+    bool sendMessage(const char* message, uint8_t toNode, uint8_t messageId);
+
+    /**
+     * @brief Limits the TextCodec encodings this unit advertises and sends
+     * with (RAW is always allowed). Defaults to TEXT_ENCODINGS_ALL.
+     */
+    void setTextEncodings(uint8_t encodings);
+
+    /**
+     * @brief Encodings in use towards a peer: those both sides support.
+     * @param node The peer (a node can only ask about RADIO_HUB_NODE).
+     */
+    uint8_t getTextEncodings(uint8_t node = RADIO_HUB_NODE) const;
+
+    /**
+     * @brief Hub: true while a queued reply is still being collected.
+     * (Always false on a node, whose sends finish inside sendMessage().)
+     */
+    bool isSendPending() const { return outbox.active; }
+
+    /**
+     * @brief Hub: true if the node has been heard from lately (see
+     * RADIO_NODE_SILENT_MS), so a reply to it can be collected now.
+     * A node always sees the hub as reachable: its sends find out.
      */
-    bool sendMessage(const String& message);
+    bool isNodeReachable(uint8_t node) const;
 
     /**
-     * @brief Checks if a message is available from the radio.
-     * @return True if a message is waiting.
+     * @brief Whether the last message was delivered: on the hub, fully
+     * collected (false if it timed out); on a node, fully acknowledged.
+     * Only meaningful once isSendPending() is false.
+     */
+    bool lastSendDelivered() const { return lastSendOk; }
+
+    /**
+     * @brief Drains received fragments and checks for a complete message.
+     * On a node this is also where the hub gets polled, when due.
+     * @return True if a fully reassembled message is waiting.
      */
     bool isMessageAvailable();
 
     /**
-     * @brief Reads the available message.
-     * @return The received message as a String.
+     * @brief Reads the oldest complete message, in place (no copy).
+     * @param fromNode If given, receives the sender's node ID.
+     * @return The message text, valid until the next isMessageAvailable()
+     *         or getMessage() call; an empty string if none is waiting.
+     */
+    const char* getMessage(uint8_t* fromNode = nullptr);
+
+    uint8_t getNodeId() const { return nodeId; }
+
+    /**
+     * @brief Throughput of the last successful sendMessage() call, measured
+     * from the first FIFO write to the last acknowledgement.
+     * @return Bytes per second, or 0 if nothing has been sent yet.
      */
-    String getMessage();
+    unsigned long getLastThroughputBps() const;
+
+    uint16_t getEvictedMessages() const { return evictedMessages; }
+    uint16_t getMalformedFragments() const { return malformedFragments; }
+    uint16_t getDuplicateMessages() const { return duplicateMessages; }
+#if !defined(__AVR__)
+    // Host: messages read with getMessage(), for tests that follow the
+    // traffic without the sketches' console output
+    uint16_t getRxMessages() const { return rxMessages; }
+#endif
+
+    // --- Transmit statistics ---
+    uint16_t getTxMessages() const { return txMessages; }
+    uint16_t getTxFailures() const { return txFailures; }
+    uint16_t getTxFragments() const { return txFragments; }
+    uint16_t getTxRetries() const { return txRetries; }
+    uint16_t getTxRetryStalls() const { return txRetryStalls; }
+    uint16_t getPolls() const { return polls; }
+    uint16_t getFailedPolls() const { return failedPolls; }
+    unsigned long getTxTextBytes() const { return txTextBytes; }
+    unsigned long getTxFrameBytes() const { return txFrameBytes; }
+
+    // Zeroes the receive and transmit counters
+    void resetStats();
 };
 
-#endif // RADIO_INTERFACE_H
\ No newline at end of file
+#endif // RADIO_INTERFACE_H
@@ -0,0 +1,164 @@
+#include "TextCodec.h"
+
+namespace {
+
+const uint8_t CODE_BITS = 6;
+const uint8_t CODE_END = 0;
+const uint8_t CODE_SPACE = 1;
+const uint8_t CODE_FIRST_LETTER = 2;   // 'A'
+const uint8_t CODE_FIRST_DIGIT = 28;   // '0'
+const uint8_t CODE_DURESS = 38;        // '!'
+const uint8_t CODE_FIRST_TOKEN = 39;
+const uint8_t CODE_COUNT = 1 << CODE_BITS;
+
+// --- THE DICTIONARY (shared by every unit: changing it changes DICT) ---
+// Frequent traffic, macro expansions first. Tokens take one code wherever
+// they appear; the encoder picks the longest match. At least 2 characters
+// each, which keeps in-place decoding safe.
+const uint8_t TOKEN_COUNT = CODE_COUNT - CODE_FIRST_TOKEN; // 25
+const uint8_t TOKEN_MAX = 20;
+const char DICTIONARY[TOKEN_COUNT][TOKEN_MAX + 1] PROGMEM = {
+    "SECTOR 2 COMPROMISED", "RETURNING TO BASE", "SECTOR 1 SECURE", "BATTERY CRITICAL",
+    "BEST REGARDS", "ALL CLEAR", "POSITION", "REQUEST", "CONFIRM", "CONTACT",
+    "MESSAGE", "SECTOR ", "REPORT", "STATUS", "TARGET", "ENEMY ", "ROGER", "OVER",
+    "HOLD ", "BASE", "THE ", "AND ", "ING ", "ION", "ER"
+};
+
+// Alphabet code for a character, or CODE_END if it has none
+uint8_t codeFor(char c) {
+    if (c >= 'A' && c <= 'Z') return CODE_FIRST_LETTER + (c - 'A');
+    if (c >= '0' && c <= '9') return CODE_FIRST_DIGIT + (c - '0');
+    if (c == ' ') return CODE_SPACE;
+    if (c == '!') return CODE_DURESS;
+    return CODE_END;
+}
+
+char charFor(uint8_t code) {
+    if (code >= CODE_FIRST_DIGIT) return code == CODE_DURESS ? '!' : '0' + (code - CODE_FIRST_DIGIT);
+    if (code >= CODE_FIRST_LETTER) return 'A' + (code - CODE_FIRST_LETTER);
+    return ' ';
+}
+
+bool packable(const char* text, uint8_t length) {
+    for (uint8_t i = 0; i < length; ++i) {
+        if (codeFor(text[i]) == CODE_END) return false;
+    }
+    return true;
+}
+
+// Longest dictionary token at the start of text, or TOKEN_COUNT if none
+uint8_t longestToken(const char* text, uint8_t remaining, uint8_t& tokenLength) {
+    uint8_t best = TOKEN_COUNT;
+    tokenLength = 0;
+    for (uint8_t i = 0; i < TOKEN_COUNT; ++i) {
+        if ((char)pgm_read_byte(&DICTIONARY[i][0]) != text[0]) continue;
+        uint8_t length = strlen_P(DICTIONARY[i]);
+        if (length <= tokenLength || length > remaining) continue;
+        if (strncmp_P(text, DICTIONARY[i], length) == 0) {
+            best = i;
+            tokenLength = length;
+        }
+    }
+    return best;
+}
+
+// Codes are written most significant bit first; the last byte is zero-padded
+class BitWriter {
+private:
+    uint8_t* out;
+    uint8_t bytes = 0;
+    uint16_t pending = 0;
+    uint8_t pendingBits = 0;
+
+public:
+    explicit BitWriter(uint8_t* buffer) : out(buffer) {}
+
+    void put(uint8_t code) {
+        pending = (pending << CODE_BITS) | code;
+        pendingBits += CODE_BITS;
+        if (pendingBits >= 8) {
+            pendingBits -= 8;
+            out[bytes++] = pending >> pendingBits;
+        }
+    }
+
+    uint8_t finish() {
+        if (pendingBits) out[bytes++] = pending << (8 - pendingBits);
+        pendingBits = 0;
+        return bytes;
+    }
+};
+
+uint8_t readCode(const uint8_t* body, uint16_t bitPos) {
+    uint8_t byte = bitPos >> 3;
+    uint8_t shift = bitPos & 7;
+    // Only touch the next byte if the code reaches into it
+    uint16_t window = (body[byte] << 8) | (shift > 8 - CODE_BITS ? body[byte + 1] : 0);
+    return (window >> (16 - CODE_BITS - shift)) & (CODE_COUNT - 1);
+}
+
+} // namespace
+
+uint8_t TextCodec::encode(const char* text, uint8_t length, uint8_t encodings, uint8_t* frame) {
+    bool dictionary = encodings & (1 << TEXT_ENCODING_DICT);
+    bool packed = dictionary || (encodings & (1 << TEXT_ENCODING_PACKED));
+    if (!packed || !packable(text, length)) {
+        frame[0] = TEXT_ENCODING_RAW;
+        memcpy(frame + TEXT_FRAME_HEADER, text, length);
+        return TEXT_FRAME_HEADER + length;
+    }
+
+    frame[0] = dictionary ? TEXT_ENCODING_DICT : TEXT_ENCODING_PACKED;
+    BitWriter body(frame + TEXT_FRAME_HEADER);
+    for (uint8_t i = 0; i < length;) {
+        uint8_t tokenLength = 0;
+        uint8_t token = dictionary ? longestToken(text + i, length - i, tokenLength) : TOKEN_COUNT;
+        if (token < TOKEN_COUNT) {
+            body.put(CODE_FIRST_TOKEN + token);
+            i += tokenLength;
+        } else {
+            body.put(codeFor(text[i++]));
+        }
+    }
+    return TEXT_FRAME_HEADER + body.finish();
+}
+
+int TextCodec::decode(char* buffer, uint8_t size, uint8_t frameLength) {
+    if (frameLength < TEXT_FRAME_HEADER || frameLength > size) return -1;
+    uint8_t start = size - frameLength;
+    uint8_t encoding = buffer[start];
+    const uint8_t* body = reinterpret_cast<const uint8_t*>(buffer) + start + TEXT_FRAME_HEADER;
+    uint8_t bodyLength = frameLength - TEXT_FRAME_HEADER;
+
+    if (encoding == TEXT_ENCODING_RAW) {
+        memmove(buffer, body, bodyLength);
+        buffer[bodyLength] = '\0';
+        return bodyLength;
+    }
+    if (encoding != TEXT_ENCODING_PACKED && encoding != TEXT_ENCODING_DICT) return -1;
+
+    uint8_t length = 0;
+    uint16_t bits = bodyLength * 8;
+    for (uint16_t bitPos = 0; bitPos + CODE_BITS <= bits;) {
+        uint8_t code = readCode(body, bitPos);
+        bitPos += CODE_BITS;
+        if (code == CODE_END) break;
+
+        // Bytes before this one are fully read and free to overwrite
+        uint8_t limit = start + TEXT_FRAME_HEADER + (bitPos >> 3);
+        if (code < CODE_FIRST_TOKEN) {
+            if (length >= limit) return -1;
+            buffer[length++] = charFor(code);
+        } else {
+            if (encoding != TEXT_ENCODING_DICT) return -1;
+            PGM_P token = DICTIONARY[code - CODE_FIRST_TOKEN];
+            uint8_t tokenLength = strlen_P(token);
+            if (length + tokenLength > limit) return -1;
+            memcpy_P(buffer + length, token, tokenLength);
+            length += tokenLength;
+        }
+    }
+    if (length >= size) return -1;
+    buffer[length] = '\0';
+    return length;
+}
@@ -0,0 +1,45 @@
+#ifndef TEXT_CODEC_H
+#define TEXT_CODEC_H
+
+#include <Arduino.h>
+
+// --- WIRE ENCODINGS ---
+// A frame is a one-byte header (the encoding) followed by the body:
+//   RAW     The text's bytes as they are; any character
+//   PACKED  6-bit codes, first code in the most significant bits:
+//           1 = ' ', 2-27 = A-Z, 28-37 = 0-9, 38 = '!'
+//   DICT    PACKED, plus codes 39-63 for the phrases in the dictionary
+// Code 0 ends the text; it only shows up as padding in the last byte.
+// The 6-bit alphabet is exactly what MorseTransmitter can key, so anything a
+// spy sends packs (4 characters in 3 bytes). Text with anything else in it
+// (lower case, punctuation) goes RAW.
+//
+// Each unit advertises the encodings it decodes as a bit mask (bit n set:
+// encoding n); a sender picks the most compact one both sides support.
+// RAW is always supported.
+const uint8_t TEXT_ENCODING_RAW = 0;
+const uint8_t TEXT_ENCODING_PACKED = 1;
+const uint8_t TEXT_ENCODING_DICT = 2;
+const uint8_t TEXT_ENCODINGS_ALL =
+    (1 << TEXT_ENCODING_RAW) | (1 << TEXT_ENCODING_PACKED) | (1 << TEXT_ENCODING_DICT);
+const uint8_t TEXT_FRAME_HEADER = 1;
+
+class TextCodec {
+public:
+    // Largest frame a text of this length can encode to (RAW)
+    static uint8_t maxFrameLength(uint8_t textLength) { return TEXT_FRAME_HEADER + textLength; }
+
+    // Encodes text with the most compact encoding allowed by the mask.
+    // frame must hold maxFrameLength(length) bytes. Returns the frame length.
+    static uint8_t encode(const char* text, uint8_t length, uint8_t encodings, uint8_t* frame);
+
+    // Decodes in place: the frame sits at the end of buffer (its last
+    // frameLength bytes), and the null-terminated text is written from the
+    // start. Every code is worth at least as many characters as it takes
+    // bytes, so the text never catches up with the unread part of the frame.
+    // Returns the text length, or -1 for a malformed frame or an unknown
+    // encoding (or text that would not fit in size - 1 characters).
+    static int decode(char* buffer, uint8_t size, uint8_t frameLength);
+};
+
+#endif // TEXT_CODEC_H
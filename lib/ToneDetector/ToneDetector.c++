@@ -0,0 +1,60 @@
+#include "ToneDetector.h"
+#include <math.h>
+
+void ToneDetector::configure(uint16_t sampleRateHz, uint16_t toneHz) {
+    float omega = 2.0f * (float)M_PI * toneHz / sampleRateHz;
+    coeffQ14 = (int16_t)lroundf(2.0f * cosf(omega) * 16384.0f);
+    reset();
+}
+
+void ToneDetector::reset() {
+    noiseFloor = MIN_TONE_POWER;
+    lastPower = 0;
+    toneOn = false;
+    warmupBlocks = 0;
+}
+
+bool ToneDetector::processBlock(const uint8_t* samples, uint8_t count) {
+    if (count == 0) return toneOn;
+
+    // Remove the DC bias of the microphone stage
+    uint16_t sum = 0;
+    for (uint8_t i = 0; i < count; ++i) sum += samples[i];
+    int16_t mean = sum / count;
+
+    // Goertzel recurrence: s[n] = x[n] + coeff * s[n-1] - s[n-2]
+    int32_t s1 = 0, s2 = 0;
+    for (uint8_t i = 0; i < count; ++i) {
+        int32_t s0 = (int16_t)samples[i] - mean + ((coeffQ14 * s1) >> 14) - s2;
+        s2 = s1;
+        s1 = s0;
+    }
+
+    // |X|^2 = s1^2 + s2^2 - coeff * s1 * s2
+    int32_t power = s1 * s1 + s2 * s2 - ((coeffQ14 * s1) >> 14) * s2;
+    lastPower = (power > 0) ? (uint32_t)power : 0;
+
+    // Seed the floor with a plain average of the first few blocks
+    if (warmupBlocks < NOISE_WARMUP_BLOCKS) {
+        warmupBlocks++;
+        int32_t delta = (int32_t)lastPower - (int32_t)noiseFloor;
+        noiseFloor = (uint32_t)((int32_t)noiseFloor + delta / warmupBlocks);
+        if (noiseFloor < MIN_TONE_POWER) noiseFloor = MIN_TONE_POWER;
+        return toneOn;
+    }
+
+    if (toneOn) {
+        if (lastPower < noiseFloor * TONE_OFF_RATIO) toneOn = false;
+    } else if (lastPower > noiseFloor * TONE_ON_RATIO && lastPower > MIN_TONE_POWER) {
+        toneOn = true;
+    }
+
+    // Track the background: fast while quiet, very slowly under a tone so a
+    // stuck carrier or persistent hum eventually stops reading as a key-down.
+    uint8_t shift = toneOn ? NOISE_FLOOR_TONE_SHIFT : NOISE_FLOOR_SHIFT;
+    int32_t delta = (int32_t)lastPower - (int32_t)noiseFloor;
+    int32_t next = (int32_t)noiseFloor + delta / (1 << shift);
+    noiseFloor = (next < (int32_t)MIN_TONE_POWER) ? MIN_TONE_POWER : (uint32_t)next;
+
+    return toneOn;
+}
@@ -0,0 +1,54 @@
+#ifndef TONE_DETECTOR_H
+#define TONE_DETECTOR_H
+
+#include <stdint.h>
+
+// Plain C++ (no Arduino calls) so it can be fed synthetic buffers on a host.
+
+// --- DETECTION CONSTANTS ---
+// Times assume a block every 2 ms, as the receiver's overlapping blocks come.
+const uint8_t TONE_ON_RATIO = 8;      // Tone starts when power > floor * 8 (~9 dB)
+const uint8_t TONE_OFF_RATIO = 4;     // ...and ends when power < floor * 4 (hysteresis)
+const uint8_t NOISE_FLOOR_SHIFT = 6;  // Floor follows quiet blocks with weight 1/64 (~128 ms)
+const uint8_t NOISE_FLOOR_TONE_SHIFT = 13; // ...and drifts with weight 1/8192 during tone
+                                          // (~5 s to mute a stuck carrier, well past a 5 WPM dash)
+const uint32_t MIN_TONE_POWER = 64;   // Absolute minimum, so silence never "detects"
+const uint8_t NOISE_WARMUP_BLOCKS = 32; // Blocks averaged into the floor before detecting (64 ms)
+
+/**
+ * @brief Fixed-point Goertzel filter with an adaptive noise floor.
+ *
+ * Feed it blocks of raw 8-bit ADC samples. Each block gives one power reading
+ * at the configured tone frequency, which is compared against a running
+ * estimate of the background level to produce a clean on/off tone state.
+ */
+class ToneDetector {
+private:
+    int16_t coeffQ14 = 0;          // 2*cos(2*pi*f/fs), Q14 fixed point
+    uint32_t noiseFloor = MIN_TONE_POWER;
+    uint32_t lastPower = 0;
+    bool toneOn = false;
+    uint8_t warmupBlocks = 0;      // Blocks averaged into the floor so far
+
+public:
+    /**
+     * @brief Sets the target frequency. Only call this from setup(): it uses
+     * floating point once to compute the filter coefficient.
+     */
+    void configure(uint16_t sampleRateHz, uint16_t toneHz);
+
+    /**
+     * @brief Runs the filter over one block and updates the tone state.
+     * @param samples Unsigned 8-bit samples (DC offset is removed here).
+     * @param count Block length (keep it <= 64 so the math stays in 32 bits).
+     * @return True while a tone is present.
+     */
+    bool processBlock(const uint8_t* samples, uint8_t count);
+
+    bool isToneOn() const { return toneOn; }
+    uint32_t getLastPower() const { return lastPower; }
+    uint32_t getNoiseFloor() const { return noiseFloor; }
+    void reset();
+};
+
+#endif // TONE_DETECTOR_H
@@ -0,0 +1,79 @@
+# Compares two benchmark runs of the native simulator (env:native) and flags
+# regressions, so a change can be checked against a saved baseline:
+#
+#   .pio/build/native/program > bench.json
+#   python scripts/bench_compare.py baseline.json bench.json [--threshold 10]
+#
+# Every numeric leaf present in both files is compared. Keys ending in
+# _us/_ns/_ms, latencies and byte counts are "lower is better"; accuracy,
+# success and realtime factors are "higher is better"; anything else is
+# printed but never fails the run. Host timings (host_*, realtime_*) depend on the PC
+# running the benchmark, so they only count with --host. Exits 1 if any
+# metric got worse by more than the threshold (percent).
+
+import argparse
+import json
+import sys
+
+LOWER_IS_BETTER = ("_us", "_ns", "_ms", "latency", "bytes", "lost", "failed", "dropped",
+                   "collision", "per_payload")
+HIGHER_IS_BETTER = ("accuracy", "success", "realtime", "delivered", "unlocked", "goodput")
+
+
+def leaves(node, prefix=""):
+    if isinstance(node, dict):
+        for key, value in node.items():
+            yield from leaves(value, prefix + "." + key if prefix else key)
+    elif isinstance(node, (int, float)) and not isinstance(node, bool):
+        yield prefix, float(node)
+
+
+def direction(path, include_host):
+    name = path.rsplit(".", 1)[-1]
+    if (name.startswith("host_") or name.startswith("realtime")) and not include_host:
+        return 0
+    if any(tag in name for tag in HIGHER_IS_BETTER):
+        return 1
+    if any(tag in name for tag in LOWER_IS_BETTER):
+        return -1
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("baseline")
+    parser.add_argument("current")
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="allowed regression in percent (default 10)")
+    parser.add_argument("--host", action="store_true",
+                        help="also fail on host_*/realtime_* regressions")
+    args = parser.parse_args()
+
+    with open(args.baseline) as f:
+        baseline = dict(leaves(json.load(f)))
+    with open(args.current) as f:
+        current = dict(leaves(json.load(f)))
+
+    regressions = 0
+    for path in sorted(baseline.keys() & current.keys()):
+        old, new = baseline[path], current[path]
+        sign = direction(path, args.host)
+        if old == 0:
+            change = 0.0 if new == 0 else float("inf")
+        else:
+            change = (new - old) / abs(old) * 100.0
+
+        worse = sign != 0 and change * sign < -args.threshold
+        if worse:
+            regressions += 1
+        if worse or change != 0:
+            flag = "REGRESSION" if worse else ""
+            print("%-60s %14.3f -> %14.3f  %+8.1f%%  %s" % (path, old, new, change, flag))
+
+    print("%d metric(s) compared, %d regression(s) over %.1f%%"
+          % (len(baseline.keys() & current.keys()), regressions, args.threshold))
+    sys.exit(1 if regressions else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,230 @@
+#!/usr/bin/env python3
+"""Generate the brevity-code catalogue (MacroCatalogueData.h) from macros.txt.
+
+The keys get a minimal-ish perfect hash (hash and displace): the first hash
+picks a bucket, each bucket stores the seed of a second hash that sends its
+keys to distinct slots. A lookup is two short hashes and one strcmp_P.
+Everything lands in flash; the catalogue costs no SRAM.
+
+PlatformIO runs this before every build (extra_scripts = pre:...), and the
+header is only rewritten when it changes. It also runs standalone:
+
+    python scripts/gen_macros.py            regenerate, print the size report
+    python scripts/gen_macros.py --check    fail if the header is out of date
+    python scripts/gen_macros.py --json     size report as JSON
+"""
+
+import argparse
+import json
+import os
+import re
+import sys
+
+SOURCE = os.path.join("lib", "MacroCatalogue", "macros.txt")
+HEADER = os.path.join("lib", "MacroCatalogue", "MacroCatalogueData.h")
+
+MAX_EXPANSION = 64   # MacroCatalogue::MAX_EXPANSION (MESSAGE_BUFFER_LEN)
+MAX_KEY = 16
+KEY_CHARS = re.compile(r"^[A-Z0-9]+$")
+TEXT_CHARS = re.compile(r"^[A-Z0-9 !]+$")
+DURESS_TRIGGER = "!"
+
+KEYS_PER_BUCKET = 3
+EMPTY_SLOT = 0xFFFF
+
+
+def macro_hash(key, seed):
+    """16-bit FNV-style hash; must match macroHash() in MacroCatalogue.c++."""
+    h = (0x811C + seed * 0x9E37) & 0xFFFF
+    for c in key.encode("ascii"):
+        h = ((h ^ c) * 0x0193) & 0xFFFF
+    return h ^ (h >> 8)
+
+
+def parse(path):
+    entries = []
+    seen = {}
+    with open(path) as f:
+        for number, line in enumerate(f, 1):
+            line = line.split("#", 1)[0].strip()
+            if not line:
+                continue
+            parts = line.split(None, 1)
+            where = "%s:%d" % (path, number)
+            if len(parts) != 2:
+                sys.exit("%s: expected KEY EXPANSION" % where)
+            key, expansion = parts[0], " ".join(parts[1].split())
+            if not KEY_CHARS.match(key) or len(key) > MAX_KEY:
+                sys.exit("%s: key %r must be 1-%d of A-Z, 0-9" % (where, key, MAX_KEY))
+            if key == DURESS_TRIGGER:
+                sys.exit("%s: %r is the duress trigger" % (where, key))
+            if key in seen:
+                sys.exit("%s: duplicate key %r (first on line %d)" % (where, key, seen[key]))
+            if not TEXT_CHARS.match(expansion):
+                sys.exit("%s: expansion %r must only use A-Z, 0-9, space, '!'" % (where, expansion))
+            if len(expansion) > MAX_EXPANSION:
+                sys.exit("%s: expansion is %d characters, max %d" % (where, len(expansion), MAX_EXPANSION))
+            seen[key] = number
+            entries.append((key, expansion))
+    if not entries:
+        sys.exit("%s: no entries" % path)
+    return entries
+
+
+def place(keys, slots, buckets):
+    """Seeds per bucket and the key in each slot, or None if no fit."""
+    groups = [[] for _ in range(buckets)]
+    for key in keys:
+        groups[macro_hash(key, 0) % buckets].append(key)
+
+    table = [None] * slots
+    seeds = [0] * buckets
+    # Big buckets first, while there is still room to move
+    for bucket in sorted(range(buckets), key=lambda b: -len(groups[b])):
+        group = groups[bucket]
+        if not group:
+            continue
+        for seed in range(1, 256):
+            positions = [macro_hash(key, seed) % slots for key in group]
+            if len(set(positions)) == len(group) and all(table[p] is None for p in positions):
+                for key, p in zip(group, positions):
+                    table[p] = key
+                seeds[bucket] = seed
+                break
+        else:
+            return None
+    return seeds, table
+
+
+def build(entries):
+    keys = [key for key, _ in entries]
+    buckets = max(1, (len(keys) + KEYS_PER_BUCKET - 1) // KEYS_PER_BUCKET)
+    # Smallest table that works; minimal (one slot per key) is the usual case
+    for slots in range(len(keys), 2 * len(keys) + 1):
+        placed = place(keys, slots, buckets)
+        if placed:
+            return buckets, slots, placed[0], placed[1]
+    sys.exit("no perfect hash found for %d keys" % len(keys))
+
+
+def c_string(text):
+    return '"%s\\0"' % text.replace("\\", "\\\\").replace('"', '\\"')
+
+
+def generate(entries):
+    buckets, slots, seeds, table = build(entries)
+    expansions = dict(entries)
+
+    # Pool: "KEY\0EXPANSION\0" per entry, in slot order
+    offsets = []
+    pool_lines = []
+    pool_size = 0
+    for key in table:
+        if key is None:
+            offsets.append(EMPTY_SLOT)
+            continue
+        offsets.append(pool_size)
+        pool_lines.append("    /* %4d */ %s %s" % (pool_size, c_string(key), c_string(expansions[key])))
+        pool_size += len(key) + 1 + len(expansions[key]) + 1
+    if pool_size >= EMPTY_SLOT:
+        sys.exit("catalogue too big: %d bytes of text" % pool_size)
+
+    report = {
+        "entries": len(entries),
+        "slots": slots,
+        "buckets": buckets,
+        "pool_bytes": pool_size + 1,  # + the literal's own terminator
+        "slot_table_bytes": 2 * slots,
+        "seed_bytes": buckets,
+        "sram_bytes": 0,
+    }
+    report["flash_bytes"] = report["pool_bytes"] + report["slot_table_bytes"] + report["seed_bytes"]
+    report["flash_bytes_per_entry"] = round(report["flash_bytes"] / float(len(entries)), 1)
+    report["index_bytes_per_entry"] = round(
+        (report["slot_table_bytes"] + report["seed_bytes"]) / float(len(entries)), 1)
+
+    def rows(values, per_row):
+        return ",\n".join("    " + ", ".join(str(v) for v in values[i:i + per_row])
+                          for i in range(0, len(values), per_row))
+
+    text = """// Generated by scripts/gen_macros.py from macros.txt. Do not edit: change
+// macros.txt and rebuild (PlatformIO reruns the script) or run the script.
+//
+// {entries} entries in {slots} slots, {buckets} buckets. Flash: pool {pool_bytes} B,
+// slot table {slot_table_bytes} B, seeds {seed_bytes} B = {flash_bytes} B ({flash_bytes_per_entry} B per entry,
+// {index_bytes_per_entry} B of it index). SRAM: none.
+#ifndef MACRO_CATALOGUE_DATA_H
+#define MACRO_CATALOGUE_DATA_H
+
+#include <Arduino.h>
+
+const uint16_t MACRO_COUNT = {entries};
+const uint16_t MACRO_SLOTS = {slots};
+const uint16_t MACRO_BUCKETS = {buckets};
+const uint16_t MACRO_EMPTY_SLOT = 0xFFFF;
+const uint8_t MACRO_LONGEST_KEY = {longest_key};
+const uint8_t MACRO_LONGEST_EXPANSION = {longest_expansion};
+
+// Bucket (first hash) -> seed of the second hash
+const uint8_t MACRO_SEEDS[MACRO_BUCKETS] PROGMEM = {{
+{seeds}
+}};
+
+// Slot (second hash) -> offset of the entry in MACRO_POOL
+const uint16_t MACRO_SLOT_OFFSETS[MACRO_SLOTS] PROGMEM = {{
+{offsets}
+}};
+
+// "KEY\\0EXPANSION\\0" per entry, in slot order (offsets in the comments)
+const char MACRO_POOL[] PROGMEM =
+{pool};
+
+#endif // MACRO_CATALOGUE_DATA_H
+""".format(seeds=rows(seeds, 16), offsets=rows(offsets, 10), pool="\n".join(pool_lines),
+           longest_key=max(len(k) for k, _ in entries),
+           longest_expansion=max(len(e) for _, e in entries), **report)
+    return text, report
+
+
+def run(project_dir, check=False, quiet=False):
+    source = os.path.join(project_dir, SOURCE)
+    header = os.path.join(project_dir, HEADER)
+    text, report = generate(parse(source))
+
+    current = None
+    if os.path.exists(header):
+        with open(header) as f:
+            current = f.read()
+    if check:
+        if current != text:
+            sys.exit("%s is out of date; run scripts/gen_macros.py" % HEADER)
+    elif current != text:
+        with open(header, "w") as f:
+            f.write(text)
+        if not quiet:
+            print("gen_macros: wrote %s" % HEADER)
+
+    if not quiet:
+        print("=== Macro catalogue: %d entries, %d B flash (%.1f B/entry), 0 B SRAM ===" % (
+            report["entries"], report["flash_bytes"], report["flash_bytes_per_entry"]))
+    return report
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("--check", action="store_true", help="fail if the header is stale")
+    parser.add_argument("--json", action="store_true", help="print the size report as JSON")
+    args = parser.parse_args()
+    project_dir = os.path.dirname(os.path.dirname(os.path.abspath(sys.argv[0])))
+    report = run(project_dir, check=args.check, quiet=args.json)
+    if args.json:
+        print(json.dumps(report, indent=2))
+
+
+try:
+    Import("env")  # noqa: F821 - provided by PlatformIO
+except NameError:
+    if __name__ == "__main__":
+        main()
+else:
+    run(env.subst("$PROJECT_DIR"))  # noqa: F821
@@ -0,0 +1,85 @@
+# PlatformIO post-build script: prints a static RAM report for the current
+# environment (admin / spy) and saves it next to the firmware as
+# ram_report.json, so SRAM use can be compared from build to build.
+#
+# The build fails if .data + .bss leave less than custom_ram_stack_reserve
+# bytes (platformio.ini, default STACK_RESERVE) of the board's SRAM for the
+# stack: on a 2 KB Uno, running out shows up as random resets, not errors.
+#
+# Wired up in platformio.ini with:  extra_scripts = post:scripts/ram_report.py
+
+import json
+import os
+import subprocess
+import sys
+
+Import("env")
+
+TOP_SYMBOLS = 10
+STACK_RESERVE = 400
+
+
+def section_sizes(size_tool, elf):
+    out = subprocess.check_output([size_tool, "-A", elf]).decode()
+    sizes = {}
+    for line in out.splitlines():
+        parts = line.split()
+        if len(parts) >= 2 and parts[0].startswith(".") and parts[1].isdigit():
+            sizes[parts[0]] = int(parts[1])
+    return sizes
+
+
+def largest_ram_symbols(nm_tool, elf):
+    # Symbols in .data (d/D) and .bss (b/B), biggest first
+    out = subprocess.check_output([nm_tool, "--size-sort", "-r", "-C", "-S", elf]).decode()
+    symbols = []
+    for line in out.splitlines():
+        parts = line.split(None, 3)
+        if len(parts) == 4 and parts[2] in "dDbB":
+            symbols.append({"name": parts[3], "bytes": int(parts[1], 16)})
+        if len(symbols) >= TOP_SYMBOLS:
+            break
+    return symbols
+
+
+def ram_report(source, target, env):
+    elf = str(target[0])
+    size_tool = env.subst("$SIZETOOL")
+    nm_tool = size_tool[: -len("size")] + "nm"
+
+    sizes = section_sizes(size_tool, elf)
+    data = sizes.get(".data", 0)
+    bss = sizes.get(".bss", 0)
+    ram_max = int(env.BoardConfig().get("upload.maximum_ram_size", 2048))
+    reserve = int(env.GetProjectOption("custom_ram_stack_reserve", STACK_RESERVE))
+    limit = ram_max - reserve
+
+    report = {
+        "env": env.subst("$PIOENV"),
+        "flash_bytes": sizes.get(".text", 0) + data,
+        "data_bytes": data,
+        "bss_bytes": bss,
+        "static_ram_bytes": data + bss,
+        "ram_max_bytes": ram_max,
+        "stack_headroom_bytes": ram_max - data - bss,
+        "static_ram_limit_bytes": limit,
+        "largest_symbols": largest_ram_symbols(nm_tool, elf),
+    }
+
+    print("=== RAM report [%s] ===" % report["env"])
+    print("  .data %5d  .bss %5d  static %5d / %d  (headroom %d for stack)" % (
+        data, bss, data + bss, ram_max, report["stack_headroom_bytes"]))
+    for sym in report["largest_symbols"]:
+        print("  %5d  %s" % (sym["bytes"], sym["name"]))
+
+    path = os.path.join(env.subst("$BUILD_DIR"), "ram_report.json")
+    with open(path, "w") as f:
+        json.dump(report, f, indent=2)
+
+    if data + bss > limit:
+        sys.stderr.write("Error: static RAM %d bytes is over the limit of %d (%d reserved for the stack)\n"
+                         % (data + bss, limit, reserve))
+        env.Exit(1)
+
+
+env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", ram_report)
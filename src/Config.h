@@ -7,6 +7,14 @@
 #define LED_PIN 4       // Built-in LED
 #define BUTTON_PIN 2     // Manual Morse input button
 #define ENTER_BTN_PIN 3  // button for Space (Click) and Send (Hold)
+// Both buttons sit on interrupt pins (INT0/INT1), which time every edge.
+
+// Keying: KEYER_STRAIGHT (one key + Enter), or iambic paddles on the two
+// buttons, KEYER_IAMBIC_A / KEYER_IAMBIC_B, at KEYER_WPM (AR sends)
+#ifndef KEYER_MODE
+#define KEYER_MODE KEYER_STRAIGHT
+#endif
+#define KEYER_WPM 15
 #define LCD_ADDRESS 0x27 // I2C address for the LCD
 #define LCD_COLS 16
 #define LCD_ROWS 2
@@ -18,8 +26,9 @@
 // (Uno/Nano: 13, 12, 11)
 // (Mega: 52, 50, 51)
 
-// The "pipe" address for communication. Must be identical on both units.
-// This 5-character string is the "channel" they talk on.
+// Base "pipe" address of the network. Must be identical on every unit.
+// Spy node N talks on it with N added to the first byte (see RadioInterface.h),
+// so one admin can serve up to six spies.
 const byte radioPipeAddress[6] = "MSG01";
 
 
@@ -30,6 +39,8 @@ const byte radioPipeAddress[6] = "MSG01";
 #define ADMIN_BT_RX_PIN 7       // Bluetooth HC-05 RX
 #define ADMIN_BT_TX_PIN 6       // Bluetooth HC-05 TX
 // RTC (DS3231) uses I2C pins (SDA/SCL), same as the LCD (A4/A5 on Uno)
+#define ADMIN_LOG_BINARY_FRAMES 0 // 1 = compact binary log frames over Bluetooth
+                                  // (admin_translator.py understands both)
 
 
 // --- ================================== ---
@@ -37,7 +48,13 @@ const byte radioPipeAddress[6] = "MSG01";
 // --- ================================== ---
 // The Spy unit uses LED_PIN (13) for Morse output.
 // We can define a "buzzer" pin as -1 to disable it in the transmitter.
-#define SPY_BUZZER_PIN -1       // -1 signifies no buzzer
+#define SPY_BUZZER_PIN -1       // -1 signifies no buzzer (compiled out, see FastPin)
+
+// Which field unit this is (1-6). Every spy needs its own: build each one
+// with e.g. build_flags = -D SPY_NODE_ID=2 (a copy of [env:spy] per unit).
+#ifndef SPY_NODE_ID
+#define SPY_NODE_ID 1
+#endif
 
 
 #endif // MORSE_CONFIG_H
\ No newline at end of file
@@ -4,24 +4,166 @@
 #include "MorseDisplay.h"
 #include "MorseTransmitter.h"
 #include "BluetoothInterface.h"
+#include "SerialBackend.h"
 #include "RadioInterface.h"
+#include "OutboundQueue.h"
 #include "MessageLogger.h"
+#include "FixedString.h"
+#include "DebugLog.h"
+#include "LatencyProfiler.h"
 #include <RF24.h>
 #include <RTClib.h>
+#include <SoftwareSerial.h>
 
 // --- Global Instances (Admin) ---
 MorseDisplay display(LCD_ADDRESS, LCD_COLS, LCD_ROWS);
 // Change this line in your Admin Global Instances:
-MorseTransmitter transmitter(BUTTON_PIN, ENTER_BTN_PIN, LED_PIN, ADMIN_BUZZER_PIN);
+MorseTransmitterT<BUTTON_PIN, ENTER_BTN_PIN, LED_PIN, ADMIN_BUZZER_PIN> transmitter;
+static_assert(TX_QUEUE_SIZE >= RADIO_MAX_MESSAGE_LEN, "a received message must fit the playback queue");
 //MorseTransmitter transmitter(BUTTON_PIN, LED_PIN, ADMIN_BUZZER_PIN);
-BluetoothInterface bt(ADMIN_BT_RX_PIN, ADMIN_BT_TX_PIN);
+#if defined(UBRR1H)
+// Boards with a spare hardware UART (Mega): HC-05 on Serial1's pins, ISR-fed
+Usart1Backend btBackend;
+#else
+SoftwareSerial btSerial(ADMIN_BT_RX_PIN, ADMIN_BT_TX_PIN);
+StreamBackend<SoftwareSerial> btBackend(btSerial);
+#endif
+BluetoothInterface bt(btBackend);
 RTC_DS3231 rtc;
 MessageLogger logger(bt, rtc);
 
 RF24 radio(NRF_CE_PIN, NRF_CSN_PIN);
-RadioInterface nrf(radio, radioPipeAddress);
+RadioInterface nrf(radio, radioPipeAddress, RADIO_HUB_NODE);
+// Replies wait here (in EEPROM) until their spy has collected them
+OutboundQueue outbox(nrf);
 
-String serialInputBuffer = "";
+FixedString<RADIO_MAX_MESSAGE_LEN> serialInputBuffer;
+
+// Status line when nothing else is going on (the transmitter restores it too)
+const char IDLE_STATUS[] PROGMEM = "Admin Ready";
+const __FlashStringHelper* idleStatus() { return reinterpret_cast<const __FlashStringHelper*>(IDLE_STATUS); }
+
+// Replies go to the spy heard from last, unless typed as "@3 TEXT"
+uint8_t replyNode = 1;
+
+// --- Latency profiling (dumped by /STATS) ---
+PROFILE_DEFINE(loopTime, "loop");
+PROFILE_DEFINE(radioPollTime, "nrf.poll");
+PROFILE_DEFINE(radioReadTime, "nrf.read");
+PROFILE_DEFINE(radioSendTime, "nrf.send");
+PROFILE_DEFINE(keyerTime, "tx.update");
+PROFILE_DEFINE(playbackQueueTime, "tx.text");
+PROFILE_DEFINE(lcdFlushTime, "lcd.flush");
+PROFILE_DEFINE(logQueueTime, "log.log");
+PROFILE_DEFINE(logWriteTime, "log.update");
+
+// Queues a message for a spy; the duress alert goes before everything else
+bool sendToSpy(const char* message, uint8_t node, MessagePriority priority = PRIORITY_NORMAL) {
+    return outbox.enqueue(message, node, priority);
+}
+
+void logMessage(LogOrigin origin, const char* text, uint8_t node = 0) {
+    PROFILE_SCOPE(logQueueTime);
+    logger.log(origin, text, node);
+}
+
+// Fixed texts stay in flash
+void logMessage(LogOrigin origin, const __FlashStringHelper* text, uint8_t node = 0) {
+    PROFILE_SCOPE(logQueueTime);
+    logger.log(origin, text, node);
+}
+
+void playMessage(const char* text) {
+    bool queued;
+    {
+        PROFILE_SCOPE(playbackQueueTime);
+        queued = transmitter.processText(text);
+    }
+    // The LCD says so once playback ends; keep a record too
+    if (!queued) logMessage(LOG_ERROR, F("Playback cut short (queue full)"));
+}
+
+void printStats(Print& out) {
+#if PROFILING
+    out.println(F("[STATS] name n min max p50 p99 (us) h=<32us,<64us,...,>=32ms"));
+    LatencyHistogram::printAll(out);
+#endif
+    out.print(F("[STATS] nrf tx=")); out.print(nrf.getTxMessages());
+    out.print(F(" fail=")); out.print(nrf.getTxFailures());
+    out.print(F(" frag=")); out.print(nrf.getTxFragments());
+    out.print(F(" retries>=")); out.print(nrf.getTxRetries());
+    out.print(F(" stalls=")); out.print(nrf.getTxRetryStalls());
+    out.print(F(" polls=")); out.print(nrf.getPolls());
+    out.print(F(" evicted=")); out.print(nrf.getEvictedMessages());
+    out.print(F(" malformed=")); out.print(nrf.getMalformedFragments());
+    out.print(F(" dup=")); out.println(nrf.getDuplicateMessages());
+    out.print(F("[STATS] nrf text=")); out.print(nrf.getTxTextBytes());
+    out.print(F(" wire=")); out.print(nrf.getTxFrameBytes());
+    out.print(F(" enc=0x")); out.println(nrf.getTextEncodings(replyNode), HEX);
+    out.print(F("[STATS] outbox depth=")); out.print(outbox.getDepth());
+    out.print(F(" queued=")); out.print(outbox.getEnqueued());
+    out.print(F(" delivered=")); out.print(outbox.getDelivered());
+    out.print(F(" attempts=")); out.print(outbox.getAttempts());
+    out.print(F(" retries=")); out.print(outbox.getRetries());
+    out.print(F(" gave_up=")); out.print(outbox.getGaveUp());
+    out.print(F(" dropped=")); out.print(outbox.getDropped());
+    out.print(F(" lat_mean_ms=")); out.print(outbox.getMeanLatencyMs());
+    out.print(F(" lat_max_ms=")); out.println(outbox.getMaxLatencyMs());
+    out.print(F("[STATS] log pending=")); out.print(logger.getPendingRecords());
+    out.print(F(" dropped=")); out.print(logger.getDroppedRecords());
+    out.print(F(" truncated=")); out.println(logger.getTruncatedRecords());
+    out.print(F("[STATS] bt overruns=")); out.print(bt.getByteOverruns());
+    out.print(F(" dropped=")); out.print(bt.getDroppedLines());
+    out.print(F(" truncated=")); out.println(bt.getTruncatedLines());
+    out.print(F("[STATS] lcd flushes=")); out.print(display.getFlushCount());
+    out.print(F(" i2c_bytes=")); out.println(display.getI2CBytesTotal());
+    out.print(F("[STATS] key glitches=")); out.print(transmitter.getKeyGlitches());
+    out.print(F(" overruns=")); out.println(transmitter.getKeyOverruns());
+}
+
+// Console commands, typed on Serial or Bluetooth in place of a reply:
+//   /STATS        latency histograms and link counters
+//   /STATS RESET  zero everything /STATS prints (outbox depth and the
+//                 log's pending records are state, not counters)
+bool handleCommand(const char* line, Print& out) {
+    if (strncmp_P(line, PSTR("/STATS"), 6) != 0) return false;
+    if (strcmp_P(line + 6, PSTR(" RESET")) == 0) {
+        LatencyHistogram::resetAll();
+        nrf.resetStats();
+        outbox.resetStats();
+        logger.resetStats();
+        bt.resetStats();
+        display.resetStats();
+        transmitter.resetKeyStats();
+        out.println(F("[STATS] reset"));
+    } else {
+        printStats(out);
+    }
+    return true;
+}
+
+// Sends a typed reply (Serial or Bluetooth) to a Spy and plays it locally.
+// "@N TEXT" picks spy node N; plain text goes to the last one heard from.
+void sendReply(const char* reply) {
+    if (reply[0] == '@' && reply[1] >= '1' && reply[1] <= '0' + RADIO_MAX_NODES && reply[2] == ' ') {
+        replyNode = reply[1] - '0';
+        reply += 3;
+    }
+    DEBUG_INFO(F("[N")); DEBUG_INFO(replyNode); DEBUG_INFO(F("] "));
+    DEBUG_INFO(F("Sending to Spy: ")); DEBUG_INFOLN(reply);
+    
+    // 1. Queue it; the spy's next polls collect it
+    if (sendToSpy(reply, replyNode)) {
+        display.setStatus(F("Reply Queued..."));
+        logMessage(LOG_ADMIN, reply, replyNode);
+    } else {
+        display.setStatus(F("Reply FAIL"));
+        logMessage(LOG_ERROR, F("Reply not queued (outbox full)"), replyNode);
+    }
+    
+    // 2. Play Morse locally
+    playMessage(reply);
+}
 
 void setup() {
     Serial.begin(9600);
@@ -30,39 +172,79 @@ void setup() {
     bt.begin(9600);
     display.begin();
     transmitter.begin(&display); // Pass display to transmitter
+    transmitter.setKeyerMode(KEYER_MODE, KEYER_WPM);
+    transmitter.setIdleStatus(idleStatus()); // Also after playback
     
+    logger.setBinaryFrames(ADMIN_LOG_BINARY_FRAMES);
     if (!logger.begin()) {
-        Serial.println("FATAL: Logger (RTC/BT) failed!");
+        DEBUG_ERRORLN(F("FATAL: Logger (RTC/BT) failed!"));
         display.setStatus(F("RTC FAIL"));
+        display.flush(true);
         while (1); // Halt
     } else {
-        Serial.println("Logger OK.");
+        DEBUG_INFOLN(F("Logger OK."));
     }
     
     if (!nrf.begin()) {
-        Serial.println("FATAL: Radio failed!");
+        DEBUG_ERRORLN(F("FATAL: Radio failed!"));
         display.setStatus(F("NRF FAIL"));
+        display.flush(true);
         while (1); // Halt
     }
+    outbox.begin(); // Replies still undelivered from before a reset
 
-    display.setStatus(F("Admin Ready"));
-    Serial.println("--- ADMIN SYSTEM ONLINE ---");
-    logger.log("SYSTEM", "Admin Unit Online");
+    display.setStatus(idleStatus());
+    DEBUG_INFOLN(F("--- ADMIN SYSTEM ONLINE ---"));
+    logMessage(LOG_SYSTEM, F("Admin Unit Online"));
 }
 
 void loop() {
+    PROFILE_SCOPE(loopTime);
+
+    // Advance any Morse playback in progress (never blocks)
+    transmitter.tick();
+    // Push any LCD changes out (rate-limited, only changed cells)
+    {
+        PROFILE_SCOPE(lcdFlushTime);
+        display.flush();
+    }
+
     // --- Mode 1: Check for incoming Spy messages via NRF ---
-    if (nrf.isMessageAvailable()) {
-        String msg = nrf.getMessage();
-        Serial.println("NRF MSG RX: " + msg);
+    bool spyMessageWaiting;
+    {
+        PROFILE_SCOPE(radioPollTime);
+        spyMessageWaiting = nrf.isMessageAvailable();
+    }
+    if (spyMessageWaiting) {
+        const char* msg;
+        uint8_t fromNode;
+        {
+            PROFILE_SCOPE(radioReadTime);
+            msg = nrf.getMessage(&fromNode);
+        }
+        DEBUG_INFO(F("[N")); DEBUG_INFO(fromNode); DEBUG_INFO(F("] "));
+        DEBUG_INFO(F("NRF MSG RX: ")); DEBUG_INFOLN(msg);
         
         display.setStatus(F("Spy Msg RX..."));
-        logger.log("SPY", msg);
+        logMessage(LOG_SPY, msg, fromNode);
+        replyNode = fromNode;
         
-        // Play the message in Morse
-        transmitter.processText(msg);
-        
-        display.setStatus(F("Admin Ready"));
+        // Queue the message for Morse playback (plays out via tick())
+        playMessage(msg);
+    }
+
+    // Hand the next due reply to the radio, or collect the last one's result
+    OutboxEvent sendEvent;
+    {
+        PROFILE_SCOPE(radioSendTime);
+        sendEvent = outbox.update();
+    }
+    bool showResult = outbox.getLastPriority() == PRIORITY_NORMAL; // Duress stays hidden
+    if (sendEvent == OUTBOX_DELIVERED && showResult) {
+        display.setStatus(F("Reply Sent OK"));
+    } else if (sendEvent == OUTBOX_GAVE_UP) {
+        if (showResult) display.setStatus(F("Reply FAIL"));
+        logMessage(LOG_ERROR, F("Reply not delivered"), outbox.getLastNode());
     }
 
     // --- Mode 2: Check for Serial input (to reply to Spy) ---
@@ -70,38 +252,41 @@ void loop() {
         char c = Serial.read();
         if (c == '\n' || c == '\r') {
             if (serialInputBuffer.length() > 0) {
-                Serial.println("Sending to Spy: " + serialInputBuffer);
-                
-                // 1. Stop radio listening to send
-                display.setStatus(F("Sending Reply..."));
-                if (nrf.sendMessage(serialInputBuffer)) {
-                    display.setStatus(F("Reply Sent OK"));
-                    logger.log("ADMIN", serialInputBuffer);
-                } else {
-                    display.setStatus(F("Reply FAIL"));
-                    logger.log("ERROR", "Reply send failed");
-                }
-                
-                // 2. Play Morse locally
-                transmitter.processText(serialInputBuffer);
-                
-                serialInputBuffer = "";
-                display.setStatus(F("Admin Ready"));
+                if (!handleCommand(serialInputBuffer.c_str(), Serial)) sendReply(serialInputBuffer.c_str());
+                serialInputBuffer.clear();
             }
         } else {
-            serialInputBuffer += c;
+            serialInputBuffer.append(c); // Extra characters are dropped
         }
     }
     
+    // --- Mode 2b: Replies typed on the Bluetooth terminal ---
+    bt.checkForIncoming();
+    while (bt.hasMessage()) {
+        const char* line = bt.getMessage();
+        if (!handleCommand(line, bt.getStream())) sendReply(line);
+    }
+    
     // --- Mode 3: Manual Button Input (Optional) ---
     // Uncomment this if you want the Admin to also send via button
-    String adminMsg = transmitter.update();
-    if (adminMsg.length() > 0) {
-        Serial.println("Sending manual msg to Spy: " + adminMsg);
-        if (nrf.sendMessage(adminMsg)) {
-            logger.log("ADMIN", adminMsg);
+    const char* adminMsg;
+    {
+        PROFILE_SCOPE(keyerTime);
+        adminMsg = transmitter.update();
+    }
+    if (adminMsg) {
+        DEBUG_INFO(F("Sending manual msg to Spy: ")); DEBUG_INFOLN(adminMsg);
+        MessagePriority priority = transmitter.wasDuress() ? PRIORITY_URGENT : PRIORITY_NORMAL;
+        if (sendToSpy(adminMsg, replyNode, priority)) {
+            logMessage(LOG_ADMIN, adminMsg, replyNode);
         } else {
-            logger.log("ERROR", "Manual send failed");
+            logMessage(LOG_ERROR, F("Manual send failed (outbox full)"), replyNode);
         }
     }
+
+    // --- Idle work: write out one queued log record ---
+    {
+        PROFILE_SCOPE(logWriteTime);
+        logger.update();
+    }
 }
\ No newline at end of file
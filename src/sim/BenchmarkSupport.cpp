@@ -0,0 +1,100 @@
+#include "BenchmarkSupport.h"
+#include "Benchmarks.h"
+#include "MorseCodebook.h"
+#include <algorithm>
+#include <chrono>
+
+namespace Bench {
+
+bool verbose = false;
+
+namespace {
+
+const char PANGRAM[] = "THE QUICK BROWN FOX JUMPS OVER THE LAZY DOG ";
+
+unsigned int failures = 0;
+
+size_t editDistance(const std::string& a, const std::string& b) {
+    std::vector<size_t> row(b.size() + 1);
+    for (size_t j = 0; j <= b.size(); ++j) row[j] = j;
+    for (size_t i = 1; i <= a.size(); ++i) {
+        size_t diagonal = row[0];
+        row[0] = i;
+        for (size_t j = 1; j <= b.size(); ++j) {
+            size_t above = row[j];
+            row[j] = std::min(std::min(row[j] + 1, row[j - 1] + 1),
+                              diagonal + (a[i - 1] == b[j - 1] ? 0 : 1));
+            diagonal = above;
+        }
+    }
+    return row[b.size()];
+}
+
+} // namespace
+
+void check(bool ok, const char* section, const char* run, const char* what) {
+    if (ok) return;
+    failures++;
+    fprintf(stderr, "FAIL %s.%s: %s\n", section, run, what);
+}
+
+uint64_t hostNow() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+std::string normalize(const std::string& text) {
+    std::string out;
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == ' ' && (out.empty() || out.back() == ' ')) continue;
+        out += text[i];
+    }
+    while (!out.empty() && out.back() == ' ') out.pop_back();
+    return out;
+}
+
+double accuracy(const std::string& got, const std::string& expected) {
+    if (expected.empty()) return got.empty() ? 1.0 : 0.0;
+    double errors = (double)editDistance(got, expected);
+    return std::max(0.0, 1.0 - errors / expected.size());
+}
+
+std::string elementsOf(const std::string& text) {
+    std::string out;
+    for (size_t i = 0; i < text.size(); ++i) {
+        char pattern[MorseCodebook::MAX_ELEMENTS + 1];
+        MorseCodebook::toPattern(MorseCodebook::encode(text[i]), pattern);
+        out += pattern;
+    }
+    return out;
+}
+
+std::string sampleText(size_t length) {
+    std::string text;
+    while (text.size() < length) text += PANGRAM;
+    text.resize(length);
+    if (text.back() == ' ') text.back() = 'X';
+    return text;
+}
+
+Summary summarize(std::vector<double> values) {
+    Summary s;
+    if (values.empty()) return s;
+    std::sort(values.begin(), values.end());
+    double total = 0;
+    for (size_t i = 0; i < values.size(); ++i) total += values[i];
+    s.mean = total / values.size();
+    s.p50 = values[values.size() / 2];
+    s.max = values.back();
+    return s;
+}
+
+} // namespace Bench
+
+void setBenchmarkVerbose(bool enabled) {
+    Bench::verbose = enabled;
+}
+
+unsigned int getBenchmarkFailures() {
+    return Bench::failures;
+}
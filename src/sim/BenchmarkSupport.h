@@ -0,0 +1,67 @@
+#ifndef BENCHMARK_SUPPORT_H
+#define BENCHMARK_SUPPORT_H
+
+// Helpers shared by the benchmark suites, one .cpp per library (see
+// Benchmarks.h). Runs read their results through the libraries' accessors
+// and counters; the console is only echoed (--verbose), never parsed.
+#include "JsonWriter.h"
+#include "Simulator.h"
+#include "Config.h"
+#include "RadioInterface.h"
+#include <RF24.h>
+#include <string>
+#include <vector>
+
+namespace Bench {
+
+extern bool verbose; // Echo every board's Serial to stderr
+
+// Records a missed threshold (stdout only carries the JSON)
+void check(bool ok, const char* section, const char* run, const char* what);
+
+uint64_t hostNow(); // Host wall clock, ns
+
+// Single spaces, no leading/trailing space
+std::string normalize(const std::string& text);
+// 1 - edit distance / expected length, at least 0
+double accuracy(const std::string& got, const std::string& expected);
+// The text's Morse elements, '.' and '-', without gaps
+std::string elementsOf(const std::string& text);
+// `length` characters of a pangram, not ending in a space
+std::string sampleText(size_t length);
+
+struct Summary {
+    double mean = 0;
+    double p50 = 0;
+    double max = 0;
+};
+
+Summary summarize(std::vector<double> values);
+
+// --- Link-layer units: a RadioInterface on its own node ---
+const uint32_t NETWORK_SEND_PERIOD_MS = 1000; // Per spy, +-50% jitter
+// The e2e sketches' radios stay registered in the ether; keep off their channel
+const uint8_t NETWORK_CHANNEL = 90;
+
+struct NetworkUnit {
+    SimNode node;
+    RF24 radio;
+    RadioInterface link;
+    uint64_t nextSendUs = 0;
+    uint32_t rng;
+    unsigned int sequence = 0;
+
+    NetworkUnit(const char* name, uint8_t id)
+        : node(name), radio(NRF_CE_PIN, NRF_CSN_PIN), link(radio, radioPipeAddress, id),
+          rng(id * 7919u + 17) {}
+
+    // Next send time: the period +-50%
+    uint64_t nextGapUs() {
+        rng = rng * 1103515245UL + 12345UL;
+        return (NETWORK_SEND_PERIOD_MS / 2 + (rng >> 8) % NETWORK_SEND_PERIOD_MS) * 1000ULL;
+    }
+};
+
+} // namespace Bench
+
+#endif // BENCHMARK_SUPPORT_H
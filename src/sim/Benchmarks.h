@@ -0,0 +1,49 @@
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+
+#include "JsonWriter.h"
+
+// One suite per library, each in its own <Name>Benchmark.cpp; the helpers
+// they share are in BenchmarkSupport.h.
+
+void setBenchmarkVerbose(bool enabled); // Echo every board's Serial to stderr
+// Runs check their results against fixed thresholds (accuracy, unlock,
+// delivery, loop latency) and name every miss on stderr. Misses so far:
+unsigned int getBenchmarkFailures();
+
+// AudioMorseReceiver: accuracy, decode latency and host cost per block; and
+// its ToneDetector fed generated blocks directly (on and off frequency, a
+// step in the noise floor, a stuck carrier)
+void runDecodeBenchmark(JsonWriter& json);
+// MorseTransmitter::update: accuracy of the key decoder across speeds, on a
+// busy loop with bouncing contacts, with the passcode keyed as one run, and
+// with iambic paddles (modes A and B); plus a message played back. Every run
+// also times the transmitter's own share of each loop(), and playback the
+// whole loop()
+void runKeyingBenchmark(JsonWriter& json);
+// Admin and spy sketches over the simulated radio: message latency and
+// loop() timing. Uses the sketches' globals, so it can only run once.
+void runEndToEndBenchmark(JsonWriter& json);
+// Star network of 1-6 spies and a hub (RadioInterface only): throughput,
+// latency, collisions and retries as the node count grows; one link's
+// goodput and send time as messages grow from one fragment to five; and a
+// hub OutboundQueue whose replies to a live spy must not wait behind a
+// silent one's
+void runNetworkBenchmark(JsonWriter& json);
+// OutboundQueue: a spy's messages through a hub outage and resets, with a
+// duress message queued behind the others and a resend the hub must drop
+void runOutboxBenchmark(JsonWriter& json);
+// TextCodec encodings (RAW, 6-bit, dictionary) on a message corpus: bytes,
+// fragments and airtime on a simulated link, plus a round-trip fuzz
+void runCompressionBenchmark(JsonWriter& json);
+// MacroCatalogue: every key resolves, no false hits, flash per entry, and
+// lookup cost against a linear compare chain
+void runMacroBenchmark(JsonWriter& json);
+// MorseCodebook: packed PROGMEM tables against the String scans they
+// replaced (same answers, compares per lookup, host cost, SRAM)
+void runCodebookBenchmark(JsonWriter& json);
+// MorseDisplay: LCD bus traffic for a keyed message and its status swaps,
+// against the old write-through driver and a full redraw per call
+void runDisplayBenchmark(JsonWriter& json);
+
+#endif // BENCHMARKS_H
@@ -0,0 +1,127 @@
+// MorseCodebook tables
+#include "Benchmarks.h"
+#include "BenchmarkSupport.h"
+#include "MorseCodebook.h"
+
+using namespace Bench;
+
+namespace {
+
+// --- Codebook: packed table lookups against the String scans they replaced ---
+const unsigned int CODEBOOK_REPEATS = 2000;
+
+struct LegacyMorseEntry {
+    char character;
+    const char* sequence;
+};
+
+// The table MorseTransmitter and AudioMorseReceiver each kept in SRAM
+const LegacyMorseEntry LEGACY_MORSE_TABLE[] = {
+    {'A', ".-"}, {'B', "-..."}, {'C', "-.-."}, {'D', "-.."},  {'E', "."},
+    {'F', "..-."}, {'G', "--."},  {'H', "...."}, {'I', ".."},  {'J', ".---"},
+    {'K', "-.-"},  {'L', ".-.."}, {'M', "--"},  {'N', "-."},  {'O', "---"},
+    {'P', ".--."}, {'Q', "--.-"}, {'R', ".-."},  {'S', "..."},  {'T', "-"},
+    {'U', "..-"},  {'V', "...-"}, {'W', ".--"},  {'X', "-..-"}, {'Y', "-.--"},
+    {'Z', "--.."},
+    {'0', "-----"}, {'1', ".----"}, {'2', "..---"}, {'3', "...--"}, {'4', "....-"},
+    {'5', "....."}, {'6', "-...."}, {'7', "--..."}, {'8', "---.."}, {'9', "----."},
+    {' ', " "},
+    {'!', "..--"}
+};
+const size_t LEGACY_MORSE_SIZE = sizeof(LEGACY_MORSE_TABLE) / sizeof(LEGACY_MORSE_TABLE[0]);
+
+// Old decode: compare the keyed pattern with every sequence in turn
+char legacyDecode(const char* pattern, unsigned long& compares) {
+    for (size_t i = 0; i < LEGACY_MORSE_SIZE; ++i) {
+        compares++;
+        if (strcmp(pattern, LEGACY_MORSE_TABLE[i].sequence) == 0) return LEGACY_MORSE_TABLE[i].character;
+    }
+    return '\0';
+}
+
+// Old encode (getMorseCode): scan for the character
+const char* legacyEncode(char c) {
+    c = (char)toupper((unsigned char)c);
+    for (size_t i = 0; i < LEGACY_MORSE_SIZE; ++i) {
+        if (LEGACY_MORSE_TABLE[i].character == c) return LEGACY_MORSE_TABLE[i].sequence;
+    }
+    return nullptr;
+}
+
+void benchCodebook(JsonWriter& json) {
+    // Every code a decoder can build (1-5 elements), hit or miss, and its
+    // pattern as the old decoders built it
+    std::vector<uint8_t> codes;
+    std::vector<std::string> patterns;
+    for (uint8_t code = 2; code < MorseCodebook::TABLE_SIZE; ++code) {
+        char pattern[MorseCodebook::MAX_ELEMENTS + 1];
+        MorseCodebook::toPattern(code, pattern);
+        codes.push_back(code);
+        patterns.push_back(pattern);
+    }
+    const std::string text = sampleText(RADIO_MAX_MESSAGE_LEN);
+
+    // Both must agree on every code and every character
+    unsigned long wrong = 0, compares = 0;
+    for (size_t i = 0; i < codes.size(); ++i) {
+        if (MorseCodebook::decode(codes[i]) != legacyDecode(patterns[i].c_str(), compares)) wrong++;
+    }
+    for (char c = ' ' + 1; c <= '_'; ++c) {
+        const char* sequence = legacyEncode(c);
+        char pattern[MorseCodebook::MAX_ELEMENTS + 1] = "";
+        uint8_t code = MorseCodebook::encode(c);
+        if (code != MorseCodebook::NONE) MorseCodebook::toPattern(code, pattern);
+        if ((code == MorseCodebook::NONE) != !sequence || (sequence && strcmp(pattern, sequence) != 0)) wrong++;
+    }
+
+    uintptr_t sink = 0;
+    compares = 0;
+    uint64_t start = hostNow();
+    for (unsigned int r = 0; r < CODEBOOK_REPEATS; ++r) {
+        for (size_t i = 0; i < codes.size(); ++i) sink += MorseCodebook::decode(codes[i]);
+    }
+    double tableDecodeNs = (double)(hostNow() - start) / (CODEBOOK_REPEATS * codes.size());
+    start = hostNow();
+    for (unsigned int r = 0; r < CODEBOOK_REPEATS; ++r) {
+        for (size_t i = 0; i < codes.size(); ++i) sink += legacyDecode(patterns[i].c_str(), compares);
+    }
+    double linearDecodeNs = (double)(hostNow() - start) / (CODEBOOK_REPEATS * codes.size());
+    double comparesPerDecode = (double)compares / (CODEBOOK_REPEATS * codes.size());
+    start = hostNow();
+    for (unsigned int r = 0; r < CODEBOOK_REPEATS; ++r) {
+        for (size_t i = 0; i < text.size(); ++i) sink += MorseCodebook::encode(text[i]);
+    }
+    double tableEncodeNs = (double)(hostNow() - start) / (CODEBOOK_REPEATS * text.size());
+    start = hostNow();
+    for (unsigned int r = 0; r < CODEBOOK_REPEATS; ++r) {
+        for (size_t i = 0; i < text.size(); ++i) sink += (uintptr_t)legacyEncode(text[i]);
+    }
+    double linearEncodeNs = (double)(hostNow() - start) / (CODEBOOK_REPEATS * text.size());
+    if (sink == 1) fprintf(stderr, " "); // Keeps the lookups from being optimized out
+
+    // On the AVR each old entry was a char and a pointer (3 bytes) plus its
+    // string, and both classes had a copy
+    unsigned long legacySram = 0;
+    for (size_t i = 0; i < LEGACY_MORSE_SIZE; ++i) legacySram += 3 + strlen(LEGACY_MORSE_TABLE[i].sequence) + 1;
+
+    json.beginObject("codebook");
+    json.field("codes_checked", (uint64_t)codes.size());
+    json.field("lookup_failed", (uint64_t)wrong);
+    json.field("sram_bytes", (uint64_t)0);
+    json.field("legacy_sram_bytes", (uint64_t)(2 * legacySram));
+    // A packed lookup is one table read
+    json.field("linear_compares_per_decode", comparesPerDecode);
+    json.field("host_table_decode_ns", tableDecodeNs);
+    json.field("host_linear_decode_ns", linearDecodeNs);
+    json.field("host_table_encode_ns", tableEncodeNs);
+    json.field("host_linear_encode_ns", linearEncodeNs);
+    json.endObject();
+
+    check(wrong == 0, "codebook", "lookups", "lookup_failed");
+}
+
+} // namespace
+
+void runCodebookBenchmark(JsonWriter& json) {
+    benchCodebook(json);
+}
@@ -0,0 +1,151 @@
+// TextCodec encodings over a simulated link
+#include "Benchmarks.h"
+#include "BenchmarkSupport.h"
+#include "TextCodec.h"
+#include <memory>
+
+using namespace Bench;
+
+namespace {
+
+// --- Compression: TextCodec encodings over a spy -> hub link ---
+// Spy traffic is keyed Morse (upper case, macros expanded); admin replies are
+// typed, so some of them fall back to RAW.
+const char* const COMPRESSION_CORPUS[] = {
+    "SECTOR 1 SECURE", "SECTOR 2 COMPROMISED", "RETURNING TO BASE", "BATTERY CRITICAL",
+    "BEST REGARDS", "SOS", "!", "ALL CLEAR", "HOLD POSITION", "ENEMY CONTACT AT GRID 4471",
+    "REQUEST STATUS REPORT", "CONFIRM TARGET AT 0930", "ROGER MOVING TO SECTOR 3",
+    "BATTERY CRITICAL RETURNING TO BASE BEST REGARDS",
+    "TWO VEHICLES NORTH ON THE RIVER ROAD AND A PATROL AT THE BRIDGE",
+    "THE QUICK BROWN FOX JUMPS OVER THE LAZY DOG 1234567890 PARIS",
+    "RTB NOW", "COPY THAT HOLD POSITION", "Roger, hold position until 0600.", "move to sector 3"
+};
+const size_t COMPRESSION_MESSAGES = sizeof(COMPRESSION_CORPUS) / sizeof(COMPRESSION_CORPUS[0]);
+const unsigned int COMPRESSION_FUZZ_RUNS = 20000;
+
+struct EncodingCase {
+    const char* name;
+    uint8_t encodings;
+};
+const EncodingCase ENCODING_CASES[] = {
+    {"raw", 1 << TEXT_ENCODING_RAW},
+    {"packed", (1 << TEXT_ENCODING_RAW) | (1 << TEXT_ENCODING_PACKED)},
+    {"dictionary", TEXT_ENCODINGS_ALL},
+};
+
+// Encodes and decodes (in place, like the radio) one text; true if it survives
+bool codecRoundTrip(const std::string& text, uint8_t encodings, uint8_t& frameLength) {
+    uint8_t frame[RADIO_MAX_FRAME_LEN];
+    frameLength = TextCodec::encode(text.c_str(), text.size(), encodings, frame);
+    char buffer[RADIO_MAX_FRAME_LEN];
+    memcpy(buffer + RADIO_MAX_FRAME_LEN - frameLength, frame, frameLength);
+    return TextCodec::decode(buffer, RADIO_MAX_FRAME_LEN, frameLength) == (int)text.size() &&
+           text == buffer;
+}
+
+// Random mixes of letters, digits, dictionary words and the odd RAW-only
+// character, 0 to RADIO_MAX_MESSAGE_LEN long
+unsigned long codecFuzz(uint8_t encodings) {
+    const char* const pieces[] = {"SECTOR 2 COMPROMISED", "THE ", "ER", "ION", "BASE", "A", "Q",
+                                  "7", " ", "!", "ROGER"};
+    const size_t pieceCount = sizeof(pieces) / sizeof(pieces[0]);
+    const char* const rawPieces[] = {"x", ","};
+    uint32_t rng = 2024;
+    unsigned long failed = 0;
+    for (unsigned int run = 0; run < COMPRESSION_FUZZ_RUNS; ++run) {
+        rng = rng * 1103515245UL + 12345UL;
+        size_t length = (rng >> 8) % (RADIO_MAX_MESSAGE_LEN + 1);
+        std::string text;
+        while (text.size() < length) {
+            rng = rng * 1103515245UL + 12345UL;
+            // RAW-only pieces are rare, so most texts pack
+            bool rawOnly = (rng >> 8) % 64 == 0;
+            text += rawOnly ? rawPieces[(rng >> 16) % 2] : pieces[(rng >> 16) % pieceCount];
+        }
+        text.resize(length);
+        uint8_t frameLength;
+        if (!codecRoundTrip(text, encodings, frameLength)) failed++;
+    }
+    return failed;
+}
+
+void benchCompressionRun(JsonWriter& json, const EncodingCase& encoding) {
+    NativeHAL::ether().reset();
+    NativeHAL::ether().lossPercent = 0;
+    std::unique_ptr<NetworkUnit> hub(new NetworkUnit("hub", RADIO_HUB_NODE));
+    std::unique_ptr<NetworkUnit> spy(new NetworkUnit("spy1", 1));
+    hub->link.setTextEncodings(encoding.encodings);
+    spy->link.setTextEncodings(encoding.encodings);
+
+    size_t nextMessage = 0;
+    unsigned long delivered = 0, mismatched = 0, textBytes = 0, frameBytes = 0;
+    unsigned long fragments = 0, airtimeUs = 0, attempts = 0, singleFragment = 0;
+    std::string expected;
+
+    Simulator sim;
+    NetworkUnit& h = *hub;
+    NetworkUnit& s = *spy;
+    h.node.board.echo = s.node.board.echo = verbose;
+    h.node.setup = [&h]() { h.link.begin(); h.radio.setChannel(NETWORK_CHANNEL); };
+    h.node.loop = [&]() {
+        if (!h.link.isMessageAvailable()) return;
+        if (expected == h.link.getMessage()) delivered++; else mismatched++;
+    };
+    s.node.setup = [&s]() { s.link.begin(); s.radio.setChannel(NETWORK_CHANNEL); };
+    // One message every 500 ms, after a second for the encodings exchange
+    s.node.loop = [&]() {
+        s.link.isMessageAvailable();
+        uint64_t now = NativeHAL::current().nowUs;
+        if (now < 1000000ULL + nextMessage * 500000ULL || nextMessage >= COMPRESSION_MESSAGES) return;
+
+        expected = COMPRESSION_CORPUS[nextMessage++];
+        const NativeHAL::Ether& ether = NativeHAL::ether();
+        unsigned long airtimeBefore = ether.airtimeUs, attemptsBefore = ether.attempts;
+        unsigned long framesBefore = s.link.getTxFrameBytes(), fragmentsBefore = s.link.getTxFragments();
+        s.link.sendMessage(expected.c_str());
+        airtimeUs += ether.airtimeUs - airtimeBefore;
+        attempts += ether.attempts - attemptsBefore;
+        textBytes += expected.size();
+        frameBytes += s.link.getTxFrameBytes() - framesBefore;
+        fragments += s.link.getTxFragments() - fragmentsBefore;
+        if (s.link.getTxFragments() - fragmentsBefore == 1) singleFragment++;
+    };
+    sim.add(h.node);
+    sim.add(s.node);
+    sim.setupAll();
+    sim.runUntil((COMPRESSION_MESSAGES + 4) * 500000ULL);
+
+    // Longest text of the pangram that still fits one fragment
+    size_t oneFragment = 0;
+    for (size_t length = 1; length <= RADIO_MAX_MESSAGE_LEN; ++length) {
+        uint8_t frameLength;
+        codecRoundTrip(sampleText(length), encoding.encodings, frameLength);
+        if (frameLength <= RADIO_FRAGMENT_DATA) oneFragment = length;
+    }
+
+    json.beginObject(encoding.name);
+    json.field("negotiated", (uint64_t)s.link.getTextEncodings());
+    json.field("delivered", (uint64_t)delivered);
+    json.field("roundtrip_failed", (uint64_t)mismatched);
+    json.field("text_bytes", (uint64_t)textBytes);
+    json.field("wire_bytes", (uint64_t)frameBytes);
+    json.field("wire_bytes_per_char", textBytes ? (double)frameBytes / textBytes : 0.0);
+    json.field("fragments", (uint64_t)fragments);
+    json.field("single_fragment_messages", (uint64_t)singleFragment);
+    json.field("attempts", (uint64_t)attempts);
+    json.field("airtime_us", (uint64_t)airtimeUs);
+    json.field("max_chars_one_fragment", (uint64_t)oneFragment);
+    json.field("fuzz_roundtrip_failed", (uint64_t)codecFuzz(encoding.encodings));
+    json.endObject();
+}
+
+} // namespace
+
+void runCompressionBenchmark(JsonWriter& json) {
+    json.beginObject("compression");
+    json.field("messages", (uint64_t)COMPRESSION_MESSAGES);
+    for (size_t i = 0; i < sizeof(ENCODING_CASES) / sizeof(ENCODING_CASES[0]); ++i) {
+        benchCompressionRun(json, ENCODING_CASES[i]);
+    }
+    json.endObject();
+}
@@ -0,0 +1,268 @@
+// AudioMorseReceiver on a scripted tone, and its ToneDetector on its own
+#include "Benchmarks.h"
+#include "BenchmarkSupport.h"
+#include "MorseReceiver.h"
+#include <algorithm>
+
+using namespace Bench;
+
+namespace {
+
+const char DECODE_TEXT[] = "PARIS THE QUICK BROWN FOX 1234567890";
+const unsigned int DECODE_WPM[] = {5, 10, 15, 20, 25};
+const uint8_t DECODE_JITTER = 10;
+const double DECODE_MIN_ACCURACY = 0.95;
+
+// --- Decode: AudioMorseReceiver on a scripted, noisy 700 Hz tone ---
+void benchDecodeRun(JsonWriter& json, unsigned int wpm) {
+    SimNode node("rx");
+    node.board.echo = verbose;
+    NativeHAL::select(node.board);
+
+    MorseScript script(1000000, wpm, DECODE_JITTER, wpm);
+    script.keyText(DECODE_TEXT);
+
+    size_t toneCursor = 0;
+    uint32_t noise = 1;
+    node.board.analogSource = [&](uint8_t, uint64_t nowUs) {
+        noise = noise * 1103515245UL + 12345UL;
+        int value = 512 + (int)((noise >> 16) % 61) - 30;
+        if (MorseScript::isDown(script.keyMarks, toneCursor, nowUs)) {
+            value += (int)(300 * sin(2 * M_PI * TONE_FREQUENCY_HZ * nowUs / 1e6));
+        }
+        return value;
+    };
+
+    AudioMorseReceiver receiver(A0);
+    receiver.begin(nullptr);
+
+    std::string decoded;
+    std::vector<double> latenciesMs;
+    uint64_t hostNs = 0;
+    uint64_t stopUs = script.endUs() + 3000000;
+    const uint32_t samplePeriodUs = 1000000UL / AUDIO_SAMPLE_RATE_HZ;
+    while (node.board.nowUs < stopUs) {
+        uint64_t start = hostNow();
+        receiver.update();
+        hostNs += hostNow() - start;
+        if (receiver.getDecodedCount() != decoded.size()) {
+            char c = receiver.getLastDecoded();
+            decoded += c;
+            // Latency from the end of the character's last mark
+            uint64_t nowUs = node.board.nowUs;
+            std::vector<uint64_t>::const_iterator end =
+                std::upper_bound(script.charEnds.begin(), script.charEnds.end(), nowUs);
+            if (c != ' ' && end != script.charEnds.begin()) {
+                latenciesMs.push_back((nowUs - *(end - 1)) / 1000.0);
+            }
+        }
+        NativeHAL::advanceMicros(samplePeriodUs);
+    }
+
+    std::string expected = normalize(script.text);
+    std::string got = normalize(decoded);
+    double signalSeconds = (stopUs - 1000000) / 1e6;
+    uint64_t blocks = (stopUs / samplePeriodUs) / GOERTZEL_HOP_SIZE;
+    Summary latency = summarize(latenciesMs);
+
+    char name[16];
+    snprintf(name, sizeof(name), "wpm_%u", wpm);
+    json.beginObject(name);
+    json.field("expected", expected);
+    json.field("decoded", got);
+    json.field("char_accuracy", accuracy(got, expected));
+    json.field("latency_ms_mean", latency.mean);
+    json.field("latency_ms_p50", latency.p50);
+    json.field("latency_ms_max", latency.max);
+    json.field("blocks", blocks);
+    json.field("host_ns_per_block", blocks ? (double)hostNs / blocks : 0.0);
+    json.field("realtime_factor", hostNs ? signalSeconds * 1e9 / hostNs : 0.0);
+    json.field("sample_overruns", (uint64_t)receiver.getSampleOverruns());
+    json.field("final_wpm_estimate", (uint64_t)receiver.getWpmEstimate());
+    json.endObject();
+
+    check(accuracy(got, expected) >= DECODE_MIN_ACCURACY, "decode", name, "char_accuracy");
+    // The receiver has to lock on from its first marks, whatever the speed
+    std::string firstWord = expected.substr(0, expected.find(' '));
+    check(got.compare(0, firstWord.size(), firstWord) == 0, "decode", name, "first_word");
+}
+
+// --- Tone detector: ToneDetector alone, fed generated 8-bit blocks ---
+// Uniform noise around mid-scale, plus a sine when asked for. As
+// AudioMorseReceiver feeds it, a block is GOERTZEL_BLOCK_SIZE samples (8 ms)
+// and the next one starts GOERTZEL_HOP_SIZE samples (2 ms) later; counts
+// below are in blocks.
+const uint8_t TONE_QUIET_NOISE = 8;     // +- counts
+const uint8_t TONE_LOUD_NOISE = 20;     // A noise step the floor must follow
+// A weak tone: about 14 dB over the quiet floor on frequency. Goertzel over
+// 32 samples is a 125 Hz-wide bin with ~13 dB sidelobes, so a strong tone
+// 300 Hz off still leaks past TONE_ON_RATIO; one this weak must not.
+const uint8_t TONE_AMPLITUDE = 12;
+const uint16_t TONE_OFF_FREQUENCIES_HZ[] = {400, 1000, 1400};
+const unsigned int TONE_WARMUP_BLOCKS = 128;
+const unsigned int TONE_RUN_BLOCKS = 256;
+const unsigned int TONE_SETTLE_BLOCKS = 128; // Two floor time constants after a step
+const unsigned int TONE_DETECT_MAX_BLOCKS = 5; // 10 ms: a block and a hop
+// Noise alone keys a block now and then: the Goertzel power of a noise block
+// is spread roughly exponentially, and TONE_ON_RATIO sits ~9 dB over its mean
+const double TONE_FALSE_RATE_MAX = 0.02;
+// A stuck carrier fades into the floor: not before a 5 WPM dash (720 ms)
+// ends, and within 10 s
+const double TONE_CARRIER_MUTE_MIN_MS = 720;
+const double TONE_CARRIER_MUTE_MAX_MS = 10000;
+
+struct ToneSource {
+    uint32_t rng = 1;
+    uint32_t sample = 0;
+    uint8_t window[GOERTZEL_BLOCK_SIZE];
+
+    // The next block: the last one moved on by a hop (a whole block at first)
+    const uint8_t* next(uint16_t toneHz, uint8_t toneAmplitude, uint8_t noise) {
+        uint8_t fresh = sample ? GOERTZEL_HOP_SIZE : GOERTZEL_BLOCK_SIZE;
+        memmove(window, window + fresh, GOERTZEL_BLOCK_SIZE - fresh);
+        for (uint8_t i = GOERTZEL_BLOCK_SIZE - fresh; i < GOERTZEL_BLOCK_SIZE; ++i, ++sample) {
+            rng = rng * 1103515245UL + 12345UL;
+            int value = 128 + (int)((rng >> 16) % (2 * noise + 1)) - noise;
+            value += (int)lround(toneAmplitude * sin(2 * M_PI * toneHz * sample / AUDIO_SAMPLE_RATE_HZ));
+            window[i] = (uint8_t)std::max(0, std::min(255, value));
+        }
+        return window;
+    }
+};
+
+struct ToneRun {
+    unsigned int until = 0;     // Blocks until the state first matched (limit + 1: never)
+    unsigned int onBlocks = 0;  // Blocks read as tone
+    double meanFloor = 0;       // Noise floor over the run (one block's is noisy)
+};
+
+// Feeds `limit` blocks of the given signal, watching for the state `on`
+ToneRun feedTone(ToneDetector& detector, ToneSource& source, unsigned int limit, bool on,
+                 uint16_t toneHz, uint8_t toneAmplitude, uint8_t noise) {
+    ToneRun run;
+    run.until = limit + 1;
+    for (unsigned int n = 1; n <= limit; ++n) {
+        bool tone = detector.processBlock(source.next(toneHz, toneAmplitude, noise), GOERTZEL_BLOCK_SIZE);
+        if (tone) run.onBlocks++;
+        if (tone == on && run.until > limit) run.until = n;
+        run.meanFloor += (double)detector.getNoiseFloor() / limit;
+    }
+    return run;
+}
+
+void benchToneDetector(JsonWriter& json) {
+    const double blockMs = 1000.0 * GOERTZEL_HOP_SIZE / AUDIO_SAMPLE_RATE_HZ; // Block to block
+    json.beginObject("tone_detector");
+
+    // On frequency: a keyed tone over quiet noise
+    {
+        ToneDetector detector;
+        ToneSource source;
+        detector.configure(AUDIO_SAMPLE_RATE_HZ, TONE_FREQUENCY_HZ);
+        ToneRun quiet = feedTone(detector, source, TONE_WARMUP_BLOCKS, true, 0, 0, TONE_QUIET_NOISE);
+        uint32_t floor = detector.getNoiseFloor();
+        ToneRun tone = feedTone(detector, source, TONE_RUN_BLOCKS, true, TONE_FREQUENCY_HZ,
+                                TONE_AMPLITUDE, TONE_QUIET_NOISE);
+        uint32_t power = detector.getLastPower();
+        ToneRun after = feedTone(detector, source, TONE_RUN_BLOCKS, false, 0, 0, TONE_QUIET_NOISE);
+
+        json.beginObject("on_frequency");
+        json.field("tone_to_floor", floor ? (double)power / floor : 0.0);
+        json.field("attack_ms", tone.until * blockMs);
+        json.field("release_ms", after.until * blockMs);
+        json.field("tone_blocks_missed", (uint64_t)(TONE_RUN_BLOCKS - tone.onBlocks));
+        // Blocks still on before the release don't count
+        unsigned int falseBlocks = quiet.onBlocks + after.onBlocks - (after.until - 1);
+        double falseRate = (double)falseBlocks / (TONE_WARMUP_BLOCKS + TONE_RUN_BLOCKS);
+        json.field("false_rate", falseRate);
+        json.endObject();
+        check(tone.until <= TONE_DETECT_MAX_BLOCKS, "decode.tone_detector", "on_frequency", "attack_ms");
+        check(after.until <= TONE_DETECT_MAX_BLOCKS, "decode.tone_detector", "on_frequency", "release_ms");
+        check(tone.onBlocks + TONE_DETECT_MAX_BLOCKS > TONE_RUN_BLOCKS, "decode.tone_detector",
+              "on_frequency", "tone_blocks_missed");
+        check(falseRate <= TONE_FALSE_RATE_MAX, "decode.tone_detector", "on_frequency", "false_rate");
+    }
+
+    // Off frequency: the same tone elsewhere in the band never keys
+    for (size_t i = 0; i < sizeof(TONE_OFF_FREQUENCIES_HZ) / sizeof(TONE_OFF_FREQUENCIES_HZ[0]); ++i) {
+        uint16_t hz = TONE_OFF_FREQUENCIES_HZ[i];
+        ToneDetector detector;
+        ToneSource source;
+        detector.configure(AUDIO_SAMPLE_RATE_HZ, TONE_FREQUENCY_HZ);
+        ToneRun quiet = feedTone(detector, source, TONE_WARMUP_BLOCKS, true, 0, 0, TONE_QUIET_NOISE);
+        ToneRun tone = feedTone(detector, source, TONE_RUN_BLOCKS, true, hz, TONE_AMPLITUDE, TONE_QUIET_NOISE);
+
+        char name[16];
+        snprintf(name, sizeof(name), "off_%u_hz", hz);
+        json.beginObject(name);
+        json.field("floor_rise", quiet.meanFloor ? tone.meanFloor / quiet.meanFloor : 0.0);
+        double falseRate = (double)(quiet.onBlocks + tone.onBlocks) / (TONE_WARMUP_BLOCKS + TONE_RUN_BLOCKS);
+        json.field("false_rate", falseRate);
+        json.endObject();
+        check(falseRate <= TONE_FALSE_RATE_MAX, "decode.tone_detector", name, "false_rate");
+    }
+
+    // Noise floor: follows a step in the background without keying, and
+    // still hears the tone over it
+    {
+        ToneDetector detector;
+        ToneSource source;
+        detector.configure(AUDIO_SAMPLE_RATE_HZ, TONE_FREQUENCY_HZ);
+        feedTone(detector, source, TONE_WARMUP_BLOCKS, true, 0, 0, TONE_QUIET_NOISE);
+        ToneRun quiet = feedTone(detector, source, TONE_RUN_BLOCKS, true, 0, 0, TONE_QUIET_NOISE);
+        // The step itself may key a block or two before the floor catches up
+        ToneRun step = feedTone(detector, source, TONE_SETTLE_BLOCKS, true, 0, 0, TONE_LOUD_NOISE);
+        ToneRun loud = feedTone(detector, source, TONE_RUN_BLOCKS, true, 0, 0, TONE_LOUD_NOISE);
+        ToneRun tone = feedTone(detector, source, TONE_RUN_BLOCKS, true, TONE_FREQUENCY_HZ,
+                                2 * TONE_AMPLITUDE, TONE_LOUD_NOISE);
+        double ratio = quiet.meanFloor ? loud.meanFloor / quiet.meanFloor : 0.0;
+        double falseRate = (double)(quiet.onBlocks + loud.onBlocks) / (2 * TONE_RUN_BLOCKS);
+
+        json.beginObject("noise_floor");
+        json.field("quiet_floor", quiet.meanFloor);
+        json.field("loud_floor", loud.meanFloor);
+        json.field("floor_ratio", ratio);
+        json.field("step_blocks_keyed", (uint64_t)step.onBlocks);
+        json.field("false_rate", falseRate);
+        json.field("attack_ms", tone.until * blockMs);
+        json.endObject();
+        // Uniform noise of +-20 has (20 * 21) / (8 * 9) = 5.8x the power of +-8
+        check(ratio >= 4.0, "decode.tone_detector", "noise_floor", "floor_ratio");
+        check(falseRate <= TONE_FALSE_RATE_MAX, "decode.tone_detector", "noise_floor", "false_rate");
+        check(tone.until <= TONE_DETECT_MAX_BLOCKS, "decode.tone_detector", "noise_floor", "attack_ms");
+    }
+
+    // Stuck carrier: a tone that never stops fades into the floor
+    {
+        ToneDetector detector;
+        ToneSource source;
+        detector.configure(AUDIO_SAMPLE_RATE_HZ, TONE_FREQUENCY_HZ);
+        feedTone(detector, source, TONE_WARMUP_BLOCKS, true, 0, 0, TONE_QUIET_NOISE);
+        const unsigned int limit = (unsigned int)(2 * TONE_CARRIER_MUTE_MAX_MS / blockMs);
+        // Timed from the carrier's start, once it has keyed
+        ToneRun start = feedTone(detector, source, TONE_DETECT_MAX_BLOCKS, true, TONE_FREQUENCY_HZ,
+                                 TONE_AMPLITUDE, TONE_QUIET_NOISE);
+        ToneRun carrier = feedTone(detector, source, limit, false, TONE_FREQUENCY_HZ,
+                                   TONE_AMPLITUDE, TONE_QUIET_NOISE);
+        double muteMs = carrier.until > limit || start.until > TONE_DETECT_MAX_BLOCKS
+                            ? 0.0 : (TONE_DETECT_MAX_BLOCKS + carrier.until) * blockMs;
+
+        json.beginObject("carrier");
+        json.field("mute_ms", muteMs);
+        json.endObject();
+        check(muteMs >= TONE_CARRIER_MUTE_MIN_MS && muteMs <= TONE_CARRIER_MUTE_MAX_MS,
+              "decode.tone_detector", "carrier", "mute_ms");
+    }
+    json.endObject();
+}
+
+} // namespace
+
+void runDecodeBenchmark(JsonWriter& json) {
+    json.beginObject("decode");
+    for (size_t i = 0; i < sizeof(DECODE_WPM) / sizeof(DECODE_WPM[0]); ++i) {
+        benchDecodeRun(json, DECODE_WPM[i]);
+    }
+    benchToneDetector(json);
+    json.endObject();
+}
@@ -0,0 +1,166 @@
+// MorseDisplay bus traffic
+#include "Benchmarks.h"
+#include "BenchmarkSupport.h"
+#include "MorseDisplay.h"
+#include "MorseCodebook.h"
+#include <algorithm>
+
+using namespace Bench;
+
+namespace {
+
+// --- Display: a keyed message and its status swaps on the spy's LCD ---
+// The same calls go to MorseDisplay (shadow frame, flushed from loop()) and
+// to a model of the driver it replaced, which wrote every call straight to
+// the LCD. LCD bytes are commands and characters alike; the bus carries
+// LCD_I2C_BYTES_PER_LCD_BYTE per LCD byte.
+const char DISPLAY_TEXT[] = "SECTOR 2 COMPROMISED RETURNING TO BASE";
+const unsigned int DISPLAY_WPM = 20;
+const unsigned int DISPLAY_LOOP_US = 1000;
+// The shadow frame must at least halve the old driver's traffic
+const double DISPLAY_MAX_BYTES_VS_LEGACY = 0.5;
+
+// What the old MorseDisplay sent for each call: status lines were blanked
+// and rewritten, and once line 0 was full every character redrew it twice
+struct LegacyDisplay {
+    uint8_t cols;
+    size_t line0 = 0;
+    unsigned long lcdBytes = 0;
+
+    explicit LegacyDisplay(uint8_t lcdCols) : cols(lcdCols) {}
+    void setStatus(size_t length) { lcdBytes += 1 + cols + 1 + std::min<size_t>(length, cols); }
+    void appendDecodedCharacter() {
+        if (++line0 <= cols) lcdBytes += 2;
+        else lcdBytes += 2 * (1 + cols);
+    }
+    void clearAll() { lcdBytes++; line0 = 0; setStatus(5); }
+};
+
+// Every call redraws the whole screen (a cursor move and a row per row)
+unsigned long fullRedrawBytes(unsigned long calls) {
+    return calls * LCD_ROWS * (1 + LCD_COLS);
+}
+
+void benchDisplay(JsonWriter& json) {
+    SimNode node("lcd");
+    node.board.echo = verbose;
+    NativeHAL::select(node.board);
+
+    MorseDisplay display(LCD_ADDRESS, LCD_COLS, LCD_ROWS);
+    display.begin();
+    display.resetStats();
+    LegacyDisplay legacy(LCD_COLS);
+    unsigned long busBytes0 = display.getLcd().getBusBytes();
+    unsigned long calls = 0;
+    uint16_t flushMaxBytes = 0;
+
+    // loop(): flush() every pass, as the sketches do
+    auto run = [&](uint32_t ms) {
+        for (uint32_t us = 0; us < ms * 1000; us += DISPLAY_LOOP_US) {
+            NativeHAL::advanceMicros(DISPLAY_LOOP_US);
+            display.flush();
+            flushMaxBytes = std::max(flushMaxBytes, display.getLastFlushI2CBytes());
+        }
+    };
+    auto status = [&](const char* text) {
+        display.setStatus(text);
+        legacy.setStatus(strlen(text));
+        calls++;
+    };
+
+    // Each element shows up on line 1 as it is keyed; each character moves
+    // to line 0 once its gap has passed
+    const uint32_t unitMs = 1200 / DISPLAY_WPM;
+    std::string sequence;
+    for (const char* c = DISPLAY_TEXT; *c; ++c) {
+        if (*c == ' ') {
+            run(4 * unitMs); // Word gap: 7 units, 3 already passed
+            display.appendDecodedCharacter(' ');
+            legacy.appendDecodedCharacter();
+            calls++;
+            continue;
+        }
+        char pattern[MorseCodebook::MAX_ELEMENTS + 1];
+        MorseCodebook::toPattern(MorseCodebook::encode(*c), pattern);
+        sequence.clear();
+        for (const char* e = pattern; *e; ++e) {
+            run((*e == '-' ? 3 : 1) * unitMs);
+            sequence += *e;
+            display.updateInputSequence(sequence.c_str());
+            legacy.setStatus(strlen("Input: ") + sequence.size());
+            calls++;
+            run(unitMs);
+        }
+        run(2 * unitMs);
+        display.appendDecodedCharacter(*c);
+        legacy.appendDecodedCharacter();
+        display.updateInputSequence("");
+        legacy.setStatus(strlen("Input: "));
+        calls += 2;
+    }
+    run(1000);
+    std::string shownText = display.getLcd().rowText(0);
+    std::string message(DISPLAY_TEXT);
+    std::string expectedText = message.substr(message.size() - LCD_COLS);
+
+    // Send, and the status swaps that follow
+    const char* const statuses[] = {"Sending...", "Msg Queued", "Msg Sent OK", "Spy Unit Ready"};
+    for (size_t i = 0; i < sizeof(statuses) / sizeof(statuses[0]); ++i) {
+        status(statuses[i]);
+        run(500);
+    }
+    std::string shownStatus = normalize(display.getLcd().rowText(1));
+
+    // Every cell changes at once: the redraw goes out a budget at a time
+    for (uint8_t i = 0; i < LCD_COLS; ++i) {
+        display.appendDecodedCharacter('0' + i % 10);
+        legacy.appendDecodedCharacter();
+        calls++;
+    }
+    status("ABCDEFGHIJKLMNOP");
+    unsigned long redrawFlushes = display.getFlushCount();
+    run(500);
+    redrawFlushes = display.getFlushCount() - redrawFlushes;
+    display.clearAll();
+    legacy.clearAll();
+    calls++;
+    run(500);
+
+    unsigned long busBytes = display.getLcd().getBusBytes() - busBytes0;
+    unsigned long legacyBusBytes = legacy.lcdBytes * LCD_I2C_BYTES_PER_LCD_BYTE;
+    unsigned long fullBusBytes = fullRedrawBytes(calls) * LCD_I2C_BYTES_PER_LCD_BYTE;
+    double vsLegacy = legacyBusBytes ? (double)busBytes / legacyBusBytes : 0.0;
+
+    json.beginObject("display");
+    json.field("calls", (uint64_t)calls);
+    json.field("flushes", (uint64_t)display.getFlushCount());
+    json.field("i2c_bytes", (uint64_t)busBytes);
+    json.field("counted_i2c_bytes", (uint64_t)display.getI2CBytesTotal());
+    json.field("legacy_i2c_bytes", (uint64_t)legacyBusBytes);
+    json.field("full_redraw_i2c_bytes", (uint64_t)fullBusBytes);
+    json.field("ratio_vs_legacy", vsLegacy);
+    json.field("ratio_vs_full_redraw", fullBusBytes ? (double)busBytes / fullBusBytes : 0.0);
+    json.field("i2c_ms", busBytes * NativeHAL::I2C_BYTE_US / 1000.0);
+    json.field("legacy_i2c_ms", legacyBusBytes * NativeHAL::I2C_BYTE_US / 1000.0);
+    json.field("max_i2c_bytes_per_flush", (uint64_t)flushMaxBytes);
+    json.field("max_i2c_ms_per_flush", flushMaxBytes * NativeHAL::I2C_BYTE_US / 1000.0);
+    json.field("full_redraw_flushes", (uint64_t)redrawFlushes);
+    json.field("line0_ok", shownText == expectedText);
+    json.field("status_ok", shownStatus == "Spy Unit Ready");
+    json.endObject();
+
+    check(shownText == expectedText, "display", "run", "line0_ok");
+    check(shownStatus == "Spy Unit Ready", "display", "run", "status_ok");
+    // Its own counter has to agree with what reached the LCD
+    check(display.getI2CBytesTotal() == busBytes, "display", "run", "counted_i2c_bytes");
+    check(vsLegacy <= DISPLAY_MAX_BYTES_VS_LEGACY, "display", "run", "ratio_vs_legacy");
+    check(busBytes < fullBusBytes, "display", "run", "ratio_vs_full_redraw");
+    check(flushMaxBytes <= DISPLAY_FLUSH_BUDGET * LCD_I2C_BYTES_PER_LCD_BYTE, "display", "run",
+          "max_i2c_bytes_per_flush");
+}
+
+} // namespace
+
+void runDisplayBenchmark(JsonWriter& json) {
+    benchDisplay(json);
+}
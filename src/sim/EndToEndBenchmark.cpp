@@ -0,0 +1,253 @@
+// The real admin and spy sketches over the simulated ether
+#include "Benchmarks.h"
+#include "BenchmarkSupport.h"
+#include "SimNodes.h"
+#include "MorseDisplay.h"
+#include "MorseTransmitter.h"
+#include "OutboundQueue.h"
+#include "MessageLogger.h"
+#include <algorithm>
+#include <functional>
+
+using namespace Bench;
+
+namespace {
+
+// Longest loop() either sketch may take. The worst pass does every paced
+// job's share at once: LOG_WRITE_CHUNK bytes to the 9600-baud Bluetooth
+// SoftwareSerial (8.3 ms), DISPLAY_FLUSH_BUDGET LCD bytes (4.3 ms) and one
+// EEPROM write for the outbox (3.3 ms), about 16 ms in all.
+const uint32_t E2E_LOOP_MAX_US = 17000;
+// Time the units get to play out every reply before their idle status is checked
+const uint64_t E2E_SETTLE_US = 1200000000ULL;
+
+void writeLoopStats(JsonWriter& json, const char* name, const LoopStats& stats,
+                    unsigned long lcdBusBytes) {
+    json.beginObject(name);
+    json.field("loops", (uint64_t)stats.virtualUs.size());
+    json.field("virtual_us_mean", stats.meanVirtualUs());
+    json.field("virtual_us_p99", (uint64_t)stats.percentile(99));
+    json.field("virtual_us_max", (uint64_t)stats.percentile(100));
+    json.field("host_ns_mean", stats.meanHostNs());
+    json.field("host_ns_max", stats.hostNsMax);
+    json.field("lcd_i2c_bytes_per_loop",
+               stats.virtualUs.empty() ? 0.0 : (double)lcdBusBytes / stats.virtualUs.size());
+    json.endObject();
+
+    check(stats.percentile(100) <= E2E_LOOP_MAX_US, "loop", name, "virtual_us_max");
+}
+
+// --- End to end: the real admin and spy sketches over the simulated ether ---
+struct Transfer {
+    std::string direction;
+    std::string text;
+    uint64_t sentUs = 0;
+    uint64_t receivedUs = 0;
+    uint8_t lossPercent = 0;
+};
+
+void benchEndToEnd(JsonWriter& json) {
+    NativeHAL::ether().reset();
+    NativeHAL::ether().lossPercent = 0;
+
+    SimNode adminNode("admin");
+    SimNode spyNode("spy");
+    adminNode.board.echo = spyNode.board.echo = verbose;
+    SimNodes::bindAdmin(adminNode);
+    SimNodes::bindSpy(spyNode);
+
+    Simulator sim;
+    sim.add(adminNode);
+    sim.add(spyNode);
+    sim.setupAll();
+
+    // Idle baseline
+    uint64_t idleStart = std::max(adminNode.board.nowUs, spyNode.board.nowUs);
+    sim.runUntil(idleStart + 5000000);
+    unsigned long adminLcd0 = SimNodes::adminDisplay().getI2CBytesTotal();
+    unsigned long spyLcd0 = SimNodes::spyDisplay().getI2CBytesTotal();
+    LoopStats adminIdle = adminNode.stats, spyIdle = spyNode.stats;
+    adminNode.stats.reset();
+    spyNode.stats.reset();
+
+    // Traffic: spy keys two messages, admin types eight replies of growing
+    // length; the second half runs with 10% of radio attempts lost.
+    const uint64_t start = idleStart + 5000000;
+    const uint64_t lossyFromUs = start + 24000000;
+    MorseScript script(start, 12, 10, 7);
+    script.keyPasscode();
+    script.pause(2500);
+    script.keyText("HELLO");
+    script.holdEnter(1200);
+    uint64_t firstReleaseUs = script.endUs();
+    script.pause((uint32_t)((lossyFromUs + 8000000 - script.endUs()) / 1000));
+    script.keyText("HI");
+    script.holdEnter(1200);
+    uint64_t secondReleaseUs = script.endUs();
+
+    const size_t replyLengths[] = {4, RADIO_FRAGMENT_DATA, 2 * RADIO_FRAGMENT_DATA, RADIO_MAX_MESSAGE_LEN};
+    std::vector<std::pair<uint64_t, std::string> > replies;
+    for (uint8_t phase = 0; phase < 2; ++phase) {
+        uint64_t at = (phase == 0) ? firstReleaseUs + 2000000 : lossyFromUs;
+        for (size_t i = 0; i < 4; ++i) {
+            replies.push_back(std::make_pair(at, sampleText(replyLengths[i])));
+            at += 2000000;
+        }
+    }
+    // Sends and receipts, followed through the senders' outbox and the
+    // receivers' radio counters after every loop(). Each direction delivers
+    // in order, so the nth message read is the nth one queued.
+    struct Direction {
+        const char* name;
+        OutboundQueue& outbox;
+        RadioInterface& receiver;
+        std::vector<std::string> texts;  // What the sender queues, in order
+        std::vector<size_t> queued;      // Their transfers, as queued
+        uint16_t enqueued;
+        uint16_t read;
+    };
+    std::vector<std::string> replyTexts;
+    for (size_t i = 0; i < replies.size(); ++i) replyTexts.push_back(replies[i].second);
+    std::vector<std::string> spyTexts;
+    spyTexts.push_back("HELLO");
+    spyTexts.push_back("HI");
+    Direction toSpy = {"admin_to_spy", SimNodes::adminOutbox(), SimNodes::spyRadio(), replyTexts,
+                       std::vector<size_t>(), SimNodes::adminOutbox().getEnqueued(),
+                       SimNodes::spyRadio().getRxMessages()};
+    Direction toAdmin = {"spy_to_admin", SimNodes::spyOutbox(), SimNodes::adminRadio(), spyTexts,
+                         std::vector<size_t>(), SimNodes::spyOutbox().getEnqueued(),
+                         SimNodes::adminRadio().getRxMessages()};
+
+    std::vector<Transfer> transfers;
+    uint8_t lossNow = 0;
+    auto follow = [&](Direction& d, uint64_t nowUs) {
+        for (; d.enqueued != d.outbox.getEnqueued(); ++d.enqueued) {
+            Transfer t;
+            t.direction = d.name;
+            t.text = d.queued.size() < d.texts.size() ? d.texts[d.queued.size()] : "?";
+            t.sentUs = nowUs;
+            t.lossPercent = lossNow;
+            d.queued.push_back(transfers.size());
+            transfers.push_back(t);
+        }
+        for (; d.read != d.receiver.getRxMessages(); ++d.read) {
+            if (d.read < d.queued.size()) transfers[d.queued[d.read]].receivedUs = nowUs;
+        }
+    };
+    std::function<void()> adminLoop = adminNode.loop, spyLoop = spyNode.loop;
+    adminNode.loop = [&]() {
+        adminLoop();
+        follow(toSpy, adminNode.board.nowUs);
+        follow(toAdmin, adminNode.board.nowUs);
+    };
+    bool unlocked = false;
+    spyNode.loop = [&]() {
+        spyLoop();
+        follow(toAdmin, spyNode.board.nowUs);
+        follow(toSpy, spyNode.board.nowUs);
+        if (SimNodes::spyTransmitter().isUnlocked()) unlocked = true;
+    };
+    // The log's own records, as they reach the admin's Serial
+    size_t logLines = 0;
+    adminNode.board.onSerialLine = [&](const std::string& line, uint64_t) {
+        if (line.find("] > ") != std::string::npos) logLines++;
+    };
+
+    Keyer keyer(script, BUTTON_PIN, ENTER_BTN_PIN);
+    keyer.attach(spyNode.board);
+    size_t nextReply = 0;
+    adminNode.beforeLoop = [&](NativeHAL::Board& board) {
+        while (nextReply < replies.size() && replies[nextReply].first <= board.nowUs) {
+            std::string line = replies[nextReply++].second + "\n";
+            NativeHAL::typeOnSerial(board, line.c_str());
+        }
+    };
+
+    sim.runUntil(lossyFromUs);
+    lossNow = NativeHAL::ether().lossPercent = 10;
+    sim.runUntil(secondReleaseUs + 5000000);
+
+    json.beginObject("end_to_end");
+    json.beginObject("messages");
+    std::vector<double> latencies;
+    for (size_t i = 0; i < transfers.size(); ++i) {
+        const Transfer& t = transfers[i];
+        char name[48];
+        snprintf(name, sizeof(name), "%s_%zu_len%zu_loss%u", t.direction.c_str(), i,
+                 t.text.size(), t.lossPercent);
+        json.beginObject(name);
+        json.field("delivered", t.receivedUs != 0);
+        if (t.receivedUs) {
+            double ms = (t.receivedUs - t.sentUs) / 1000.0;
+            latencies.push_back(ms);
+            json.field("latency_ms", ms);
+        }
+        if (t.direction == "spy_to_admin" && t.receivedUs) {
+            uint64_t released = (t.text == "HELLO") ? firstReleaseUs : secondReleaseUs;
+            json.field("release_to_rx_ms", (t.receivedUs - released) / 1000.0);
+        }
+        json.endObject();
+    }
+    json.endObject();
+    Summary latency = summarize(latencies);
+    size_t delivered = latencies.size();
+    json.field("unlocked", unlocked);
+    json.field("delivered", (uint64_t)delivered);
+    json.field("sent", (uint64_t)transfers.size());
+    json.field("latency_ms_mean", latency.mean);
+    json.field("latency_ms_max", latency.max);
+    check(unlocked, "end_to_end", "spy", "unlocked");
+    // Every reply and both spy messages made it
+    check(transfers.size() == replyTexts.size() + spyTexts.size() && delivered == transfers.size(),
+          "end_to_end", "messages", "delivered");
+
+    NativeHAL::Ether& ether = NativeHAL::ether();
+    json.beginObject("radio");
+    json.field("attempts", (uint64_t)ether.attempts);
+    json.field("delivered_payloads", (uint64_t)ether.delivered);
+    json.field("lost_attempts", (uint64_t)ether.lost);
+    json.field("failed_payloads", (uint64_t)ether.failed);
+    json.field("airtime_us", (uint64_t)ether.airtimeUs);
+    json.endObject();
+    json.endObject();
+
+    json.beginObject("loop");
+    writeLoopStats(json, "admin_idle", adminIdle, adminLcd0);
+    writeLoopStats(json, "spy_idle", spyIdle, spyLcd0);
+    writeLoopStats(json, "admin_traffic", adminNode.stats,
+                   SimNodes::adminDisplay().getI2CBytesTotal() - adminLcd0);
+    writeLoopStats(json, "spy_traffic", spyNode.stats,
+                   SimNodes::spyDisplay().getI2CBytesTotal() - spyLcd0);
+    json.endObject();
+
+    // Once every reply has played, each unit shows its own idle status again
+    std::string adminStatus, spyStatus;
+    auto idle = [&]() {
+        adminStatus = normalize(SimNodes::adminDisplay().getLcd().rowText(1));
+        spyStatus = normalize(SimNodes::spyDisplay().getLcd().rowText(1));
+        return adminStatus == "Admin Ready" && spyStatus == "Spy Unit Ready";
+    };
+    sim.runUntil(secondReleaseUs + E2E_SETTLE_US, idle);
+    json.beginObject("end_to_end_idle_status");
+    json.field("admin", adminStatus);
+    json.field("spy", spyStatus);
+    json.endObject();
+    check(idle(), "end_to_end", "idle_status", "restored");
+
+    // By then the admin's log has reached Serial, a line per record kept.
+    // Trace output ('.', '-') written between update()s can land inside one.
+    MessageLogger& logger = SimNodes::adminLogger();
+    json.beginObject("end_to_end_log");
+    json.field("serial_lines", (uint64_t)logLines);
+    json.field("dropped", (uint64_t)logger.getDroppedRecords());
+    json.field("pending", (uint64_t)logger.getPendingRecords());
+    json.endObject();
+    check(logLines >= transfers.size() && logger.getPendingRecords() == 0,
+          "end_to_end", "log", "written");
+}
+
+} // namespace
+
+void runEndToEndBenchmark(JsonWriter& json) {
+    benchEndToEnd(json);
+}
@@ -0,0 +1,72 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+// Minimal pretty-printing JSON emitter (objects and scalars only)
+class JsonWriter {
+private:
+    std::string out;
+    std::vector<bool> hasFields;
+
+    void key(const char* name) {
+        if (!hasFields.empty()) {
+            if (hasFields.back()) out += ',';
+            hasFields.back() = true;
+            out += '\n';
+            out.append(hasFields.size() * 2, ' ');
+        }
+        if (name) { out += '"'; out += name; out += "\": "; }
+    }
+
+public:
+    void beginObject(const char* name = nullptr) {
+        key(name);
+        out += '{';
+        hasFields.push_back(false);
+    }
+
+    void endObject() {
+        bool any = hasFields.back();
+        hasFields.pop_back();
+        if (any) { out += '\n'; out.append(hasFields.size() * 2, ' '); }
+        out += '}';
+        if (hasFields.empty()) out += '\n';
+    }
+
+    void field(const char* name, double value) {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%.3f", value);
+        key(name);
+        out += buf;
+    }
+
+    void field(const char* name, uint64_t value) {
+        key(name);
+        out += std::to_string((unsigned long long)value);
+    }
+
+    void field(const char* name, bool value) {
+        key(name);
+        out += value ? "true" : "false";
+    }
+
+    void field(const char* name, const std::string& value) {
+        key(name);
+        out += '"';
+        for (size_t i = 0; i < value.size(); ++i) {
+            char c = value[i];
+            if (c == '"' || c == '\\') out += '\\';
+            if ((unsigned char)c < 0x20) continue;
+            out += c;
+        }
+        out += '"';
+    }
+
+    const std::string& str() const { return out; }
+};
+
+#endif // JSON_WRITER_H
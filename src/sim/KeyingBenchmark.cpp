@@ -0,0 +1,235 @@
+// MorseTransmitter: the key decoder (straight key and paddles) and playback
+#include "Benchmarks.h"
+#include "BenchmarkSupport.h"
+#include "MorseDisplay.h"
+#include "MorseTransmitter.h"
+#include <algorithm>
+#include <memory>
+
+using namespace Bench;
+
+namespace {
+
+const char KEYING_TEXT[] = "HELLO WORLD";
+const unsigned int KEYING_WPM[] = {5, 10, 15, 20};
+const uint8_t KEYING_JITTER[] = {0, 20};
+// A straight key on a busy loop (LCD, radio) with bouncing contacts
+const unsigned int KEYING_LOADED_WPM[] = {10, 15};
+const uint8_t KEYING_LOADED_JITTER = 20;
+const unsigned int KEYING_LOOP_LOAD_MS = 30;
+const uint32_t KEY_BOUNCE_US = 2000;
+// The passcode keyed as one unbroken run of 9 elements, no character gaps
+const unsigned int KEYING_PASSCODE_RUN_WPM[] = {10, 20};
+const uint8_t KEYING_PASSCODE_RUN_JITTER = 20;
+// Iambic paddles, keyed by an operator with the same bouncing contacts
+const unsigned int IAMBIC_WPM[] = {15, 25};
+
+// --- Pass/fail thresholds ---
+const double KEYING_MIN_ACCURACY = 0.95;
+// Longest the transmitter's own tick() + update() may take in one loop(),
+// keying or playing back: nothing in them may block (delay(), waiting on a
+// status message, writing the LCD). This is only the transmitter's share.
+// A whole loop() cannot stay under 1 ms on the units: one LCD byte is
+// 1.08 ms on the I2C bus, a Bluetooth byte 1.04 ms, an EEPROM write 3.3 ms.
+// Those jobs are paced instead (see E2E_LOOP_MAX_US).
+const uint32_t TRANSMITTER_MAX_US = 1000;
+// During playback, the whole loop() (LCD flush included) stays under 1 ms
+// on all but the passes that carry LCD bytes
+const uint32_t PLAYBACK_LOOP_P99_MAX_US = 1000;
+
+// --- Fixture: a transmitter and its LCD on a node of their own ---
+// loop() runs them the way the sketches do: tick(), flush the LCD,
+// update(), then stall for loadMs. Results are read back through the
+// transmitter's accessors after every pass.
+struct KeyingBench {
+    SimNode node;
+    MorseDisplay display;
+    MorseTransmitter transmitter;
+    std::unique_ptr<Keyer> keyer; // Drives the keys while the board runs
+    unsigned int loadMs = 0;
+
+    std::string sent;           // The last message update() returned
+    std::string elements;       // Every element keyed, '.' or '-'
+    bool unlocked = false;      // The passcode was accepted at some point
+    uint64_t transmitterUsMax = 0; // Longest tick() + update() in one pass
+    uint16_t keyedElements = 0;
+
+    explicit KeyingBench(const char* name)
+        : node(name), display(LCD_ADDRESS, LCD_COLS, LCD_ROWS),
+          transmitter(BUTTON_PIN, ENTER_BTN_PIN, LED_PIN, ADMIN_BUZZER_PIN) {
+        node.board.echo = verbose;
+        NativeHAL::select(node.board);
+        transmitter.begin(&display);
+        node.loop = [this]() { step(); };
+    }
+
+    void step() {
+        uint64_t start = node.board.nowUs;
+        transmitter.tick();
+        uint64_t transmitterUs = node.board.nowUs - start;
+        display.flush();
+        start = node.board.nowUs;
+        const char* message = transmitter.update();
+        transmitterUs += node.board.nowUs - start;
+        transmitterUsMax = std::max(transmitterUsMax, transmitterUs);
+        if (message) sent = message;
+        if (transmitter.isUnlocked()) unlocked = true;
+
+        // Elements since the last pass, oldest first (16 at most per pass)
+        uint16_t count = transmitter.getKeyedElements();
+        uint16_t dashes = transmitter.getRecentDashes();
+        for (uint16_t n = count - keyedElements; n > 0; --n) {
+            elements += ((dashes >> (n - 1)) & 1) ? '-' : '.';
+        }
+        keyedElements = count;
+
+        if (loadMs) delay(loadMs);
+    }
+
+    // Keys the script until a message is sent, or a second after its end
+    void key(const MorseScript& script, uint32_t bounceUs) {
+        keyer.reset(new Keyer(script, BUTTON_PIN, ENTER_BTN_PIN, bounceUs));
+        keyer->attach(node.board);
+        Simulator sim;
+        sim.add(node);
+        sim.runUntil(script.endUs() + 1000000, [this]() { return !sent.empty(); });
+    }
+
+    // The fields and checks every keyed run shares
+    void report(JsonWriter& json, const char* name, const std::string& expected,
+                const std::string& expectedElements) {
+        json.field("expected", expected);
+        json.field("sent", sent);
+        json.field("unlocked", unlocked);
+        json.field("exact_match", sent == expected);
+        json.field("char_accuracy", accuracy(normalize(sent), expected));
+        json.field("element_accuracy", accuracy(elements, expectedElements));
+        json.field("key_glitches", (uint64_t)transmitter.getKeyGlitches());
+        json.field("transmitter_us_max", transmitterUsMax);
+        json.field("host_ns_per_loop", node.stats.meanHostNs());
+
+        check(unlocked, "keying", name, "unlocked");
+        check(transmitterUsMax <= TRANSMITTER_MAX_US, "keying", name, "transmitter_us_max");
+        check(accuracy(normalize(sent), expected) >= KEYING_MIN_ACCURACY, "keying", name, "char_accuracy");
+    }
+};
+
+// --- Keying: MorseTransmitter::update on a scripted key with jitter ---
+// loadMs stalls every loop() pass; the key's edges are still stamped on time.
+// passcodeRun keys the passcode without character gaps.
+void benchKeyingRun(JsonWriter& json, unsigned int wpm, uint8_t jitter,
+                    unsigned int loadMs = 0, uint32_t bounceUs = 0, bool passcodeRun = false) {
+    KeyingBench bench("key");
+    bench.loadMs = loadMs;
+
+    MorseScript script(bench.node.board.nowUs + 500000, wpm, jitter, wpm * 100 + jitter);
+    script.keyPasscode(passcodeRun);
+    script.pause(2500); // Unlock decodes, then "ACCESS GRANTED" blocks for 1 s
+    script.keyText(KEYING_TEXT);
+    script.holdEnter(1200);
+    script.pause(500);
+
+    bench.display.resetStats();
+    bench.key(script, bounceUs);
+
+    std::string expected = normalize(script.text);
+    char name[48];
+    int length = snprintf(name, sizeof(name), "wpm_%u_jitter_%u", wpm, jitter);
+    if (loadMs) length += snprintf(name + length, sizeof(name) - length, "_load_%ums", loadMs);
+    if (bounceUs) length += snprintf(name + length, sizeof(name) - length, "_bounce");
+    if (passcodeRun) snprintf(name + length, sizeof(name) - length, "_sos_run");
+    json.beginObject(name);
+    bench.report(json, name, expected, elementsOf("SOS") + elementsOf(script.text));
+    json.field("final_unit_ms", (uint64_t)bench.transmitter.getUnitEstimateMs());
+    json.endObject();
+
+    // A straight key is timed by the speed tracker, which must lock on to a
+    // sender faster or slower than its starting unit by the passcode's end
+    check(bench.sent == expected, "keying", name, "exact_match");
+}
+
+// --- Keying: iambic paddles (mode A or B), message sent with AR ---
+void benchIambicRun(JsonWriter& json, KeyerMode mode, unsigned int wpm) {
+    KeyingBench bench("paddle");
+    bench.transmitter.setKeyerMode(mode, wpm);
+
+    MorseScript script(bench.node.board.nowUs + 500000, wpm);
+    script.usePaddles();
+    script.keyPasscode();
+    script.pause(2500);
+    script.keyText(KEYING_TEXT);
+    script.keyProsign(".-.-.");
+    script.pause(500);
+
+    bench.key(script, KEY_BOUNCE_US);
+
+    char name[24];
+    snprintf(name, sizeof(name), "iambic_%c_wpm_%u", mode == KEYER_IAMBIC_A ? 'a' : 'b', wpm);
+    json.beginObject(name);
+    bench.report(json, name, normalize(script.text),
+                 elementsOf("SOS") + elementsOf(script.text) + ".-.-.");
+    json.endObject();
+}
+
+// --- Playback: a received message keyed out on the LED while loop() runs ---
+void benchPlaybackRun(JsonWriter& json) {
+    KeyingBench bench("play");
+
+    // The longest message the radio can deliver
+    std::string text = sampleText(RADIO_MAX_MESSAGE_LEN);
+    unsigned long marks = 0;
+    bench.node.board.outputListener = [&](uint8_t pin, uint8_t level, uint64_t) {
+        if (pin == LED_PIN && level == HIGH) marks++;
+    };
+
+    uint64_t startUs = bench.node.board.nowUs;
+    bool queued = bench.transmitter.processText(text.c_str());
+    Simulator sim;
+    sim.add(bench.node);
+    sim.runUntil(startUs + 600000000ULL, [&]() { return !bench.transmitter.isPlaying(); });
+
+    unsigned long expectedMarks = elementsOf(text).size();
+    json.beginObject("playback");
+    json.field("chars", (uint64_t)text.size());
+    json.field("queued_whole", queued);
+    json.field("marks", (uint64_t)marks);
+    json.field("duration_ms", (bench.node.board.nowUs - startUs) / 1000.0);
+    json.field("transmitter_us_max", bench.transmitterUsMax);
+    // The whole loop(), as the node ran it
+    const LoopStats& loops = bench.node.stats;
+    unsigned long slowLoops = 0;
+    for (size_t i = 0; i < loops.virtualUs.size(); ++i) slowLoops += loops.virtualUs[i] > 1000;
+    json.field("loop_us_p99", (uint64_t)loops.percentile(99));
+    json.field("loop_us_max", (uint64_t)loops.percentile(100));
+    json.field("loops_over_1ms", (uint64_t)slowLoops);
+    json.field("host_ns_per_loop", bench.node.stats.meanHostNs());
+    json.endObject();
+
+    check(queued, "keying", "playback", "queued_whole");
+    check(marks == expectedMarks, "keying", "playback", "marks");
+    check(bench.transmitterUsMax <= TRANSMITTER_MAX_US, "keying", "playback", "transmitter_us_max");
+    check(loops.percentile(99) <= PLAYBACK_LOOP_P99_MAX_US, "keying", "playback", "loop_us_p99");
+}
+
+} // namespace
+
+void runKeyingBenchmark(JsonWriter& json) {
+    json.beginObject("keying");
+    for (size_t i = 0; i < sizeof(KEYING_WPM) / sizeof(KEYING_WPM[0]); ++i) {
+        for (size_t j = 0; j < sizeof(KEYING_JITTER); ++j) {
+            benchKeyingRun(json, KEYING_WPM[i], KEYING_JITTER[j]);
+        }
+    }
+    for (size_t i = 0; i < sizeof(KEYING_LOADED_WPM) / sizeof(KEYING_LOADED_WPM[0]); ++i) {
+        benchKeyingRun(json, KEYING_LOADED_WPM[i], KEYING_LOADED_JITTER, KEYING_LOOP_LOAD_MS, KEY_BOUNCE_US);
+    }
+    for (size_t i = 0; i < sizeof(KEYING_PASSCODE_RUN_WPM) / sizeof(KEYING_PASSCODE_RUN_WPM[0]); ++i) {
+        benchKeyingRun(json, KEYING_PASSCODE_RUN_WPM[i], KEYING_PASSCODE_RUN_JITTER, 0, 0, true);
+    }
+    benchPlaybackRun(json);
+    for (size_t i = 0; i < sizeof(IAMBIC_WPM) / sizeof(IAMBIC_WPM[0]); ++i) {
+        benchIambicRun(json, KEYER_IAMBIC_A, IAMBIC_WPM[i]);
+        benchIambicRun(json, KEYER_IAMBIC_B, IAMBIC_WPM[i]);
+    }
+    json.endObject();
+}
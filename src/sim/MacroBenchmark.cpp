@@ -0,0 +1,114 @@
+// MacroCatalogue lookups
+#include "Benchmarks.h"
+#include "BenchmarkSupport.h"
+#include "MacroCatalogue.h"
+#include "MacroCatalogueData.h"
+#include "MorseTransmitter.h"
+#include <algorithm>
+
+using namespace Bench;
+
+namespace {
+
+// --- Macros: brevity-code lookup, perfect hash against a linear scan ---
+const unsigned int MACRO_REPEATS = 50;
+// The codes the keyer had before the catalogue; they must still expand
+const char* const LEGACY_MACROS[][2] = {
+    {"S1", "SECTOR 1 SECURE"}, {"S2", "SECTOR 2 COMPROMISED"}, {"RTB", "RETURNING TO BASE"},
+    {"B9", "BATTERY CRITICAL"}, {"73", "BEST REGARDS"},
+};
+
+// What a compare chain over the same table does: strcmp_P every entry in turn
+PGM_P linearFind(const char* key, unsigned long& compares) {
+    for (uint16_t slot = 0; slot < MacroCatalogue::slots(); ++slot) {
+        PGM_P entry = MacroCatalogue::keyAt(slot);
+        if (!entry) continue;
+        compares++;
+        if (strcmp_P(key, entry) == 0) return entry + strlen_P(entry) + 1;
+    }
+    return nullptr;
+}
+
+// Every 1-3 character string of the key alphabet that isn't a key
+std::vector<std::string> macroMisses(const std::vector<std::string>& keys) {
+    const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+    std::vector<std::string> misses;
+    std::vector<std::string> frontier(1, "");
+    for (int length = 1; length <= 3; ++length) {
+        std::vector<std::string> next;
+        for (size_t i = 0; i < frontier.size(); ++i) {
+            for (const char* c = alphabet; *c; ++c) next.push_back(frontier[i] + *c);
+        }
+        for (size_t i = 0; i < next.size(); ++i) {
+            if (std::find(keys.begin(), keys.end(), next[i]) == keys.end()) misses.push_back(next[i]);
+        }
+        frontier.swap(next);
+    }
+    return misses;
+}
+
+void benchMacros(JsonWriter& json) {
+    std::vector<std::string> keys;
+    unsigned long wrong = 0;
+    for (uint16_t slot = 0; slot < MacroCatalogue::slots(); ++slot) {
+        PGM_P key = MacroCatalogue::keyAt(slot);
+        if (!key) continue;
+        keys.push_back(key);
+        if (MacroCatalogue::find(key) != key + strlen(key) + 1) wrong++;
+    }
+    for (size_t i = 0; i < sizeof(LEGACY_MACROS) / sizeof(LEGACY_MACROS[0]); ++i) {
+        FixedString<MESSAGE_BUFFER_LEN> out;
+        if (!MacroCatalogue::expand(LEGACY_MACROS[i][0], out) || !out.equals(LEGACY_MACROS[i][1])) wrong++;
+    }
+    std::vector<std::string> misses = macroMisses(keys);
+    unsigned long falseHits = 0;
+    for (size_t i = 0; i < misses.size(); ++i) {
+        if (MacroCatalogue::find(misses[i].c_str())) falseHits++;
+    }
+
+    // Host timing, hashed against linear, over the same lookups
+    unsigned long hitCompares = 0, missCompares = 0;
+    uintptr_t sink = 0;
+    uint64_t start = hostNow();
+    for (unsigned int r = 0; r < MACRO_REPEATS; ++r) {
+        for (size_t i = 0; i < keys.size(); ++i) sink += (uintptr_t)MacroCatalogue::find(keys[i].c_str());
+    }
+    double hashHitNs = (double)(hostNow() - start) / (MACRO_REPEATS * keys.size());
+    start = hostNow();
+    for (unsigned int r = 0; r < MACRO_REPEATS; ++r) {
+        for (size_t i = 0; i < keys.size(); ++i) sink += (uintptr_t)linearFind(keys[i].c_str(), hitCompares);
+    }
+    double linearHitNs = (double)(hostNow() - start) / (MACRO_REPEATS * keys.size());
+    start = hostNow();
+    for (size_t i = 0; i < misses.size(); ++i) sink += (uintptr_t)MacroCatalogue::find(misses[i].c_str());
+    double hashMissNs = (double)(hostNow() - start) / misses.size();
+    start = hostNow();
+    for (size_t i = 0; i < misses.size(); ++i) sink += (uintptr_t)linearFind(misses[i].c_str(), missCompares);
+    double linearMissNs = (double)(hostNow() - start) / misses.size();
+    if (sink == 1) fprintf(stderr, " "); // Keeps the lookups from being optimized out
+
+    unsigned long flashBytes = sizeof(MACRO_POOL) + sizeof(MACRO_SLOT_OFFSETS) + sizeof(MACRO_SEEDS);
+    json.beginObject("macros");
+    json.field("entries", (uint64_t)MacroCatalogue::size());
+    json.field("slots", (uint64_t)MacroCatalogue::slots());
+    json.field("lookup_failed", (uint64_t)wrong);
+    json.field("misses_checked", (uint64_t)misses.size());
+    json.field("false_hits_failed", (uint64_t)falseHits);
+    json.field("flash_bytes", (uint64_t)flashBytes);
+    json.field("flash_bytes_per_entry", (double)flashBytes / MacroCatalogue::size());
+    json.field("sram_bytes", (uint64_t)0);
+    // A hashed lookup is always one strcmp_P (none if the slot is empty)
+    json.field("linear_compares_per_hit", (double)hitCompares / (MACRO_REPEATS * keys.size()));
+    json.field("linear_compares_per_miss", (double)missCompares / misses.size());
+    json.field("host_hash_hit_ns", hashHitNs);
+    json.field("host_linear_hit_ns", linearHitNs);
+    json.field("host_hash_miss_ns", hashMissNs);
+    json.field("host_linear_miss_ns", linearMissNs);
+    json.endObject();
+}
+
+} // namespace
+
+void runMacroBenchmark(JsonWriter& json) {
+    benchMacros(json);
+}
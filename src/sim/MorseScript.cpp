@@ -0,0 +1,90 @@
+#include "MorseScript.h"
+#include "MorseCodebook.h"
+
+MorseScript::MorseScript(uint64_t startUs, unsigned int wpm, uint8_t jitter, uint32_t seedValue)
+    : cursorUs(startUs), unitUs(1200000UL / wpm), jitterPercent(jitter), seed(seedValue) {}
+
+// Stretches or shrinks a duration by up to jitterPercent, uniformly
+uint64_t MorseScript::jittered(uint64_t us) {
+    if (jitterPercent == 0) return us;
+    seed = seed * 1103515245UL + 12345UL;
+    int32_t spread = (int32_t)((seed >> 16) % (2 * jitterPercent + 1)) - jitterPercent;
+    return us * (100 + spread) / 100;
+}
+
+// Packed like MorseCodebook codes, but may be longer than a character
+uint64_t MorseScript::keyElements(unsigned int code) {
+    int8_t length = 0;
+    for (unsigned int rest = code; rest > 1; rest >>= 1) length++;
+    uint64_t markEndUs = cursorUs;
+    for (int8_t i = length - 1; i >= 0; --i) {
+        bool dash = code & (1 << i);
+        uint64_t markUs = (dash ? 3ULL : 1ULL) * unitUs;
+        if (paddles) {
+            // The keyer times the element; from idle the press itself starts it
+            Interval press;
+            press.startUs = (i == length - 1) ? cursorUs : cursorUs - unitUs / 2;
+            press.endUs = cursorUs + unitUs / 2;
+            (dash ? enterMarks : keyMarks).push_back(press);
+            markEndUs = cursorUs + markUs;
+            cursorUs = markEndUs + (i > 0 ? unitUs : 3ULL * unitUs);
+            continue;
+        }
+        Interval mark;
+        mark.startUs = cursorUs;
+        mark.endUs = cursorUs + jittered(markUs);
+        keyMarks.push_back(mark);
+        markEndUs = mark.endUs;
+        cursorUs = mark.endUs + jittered(i > 0 ? unitUs : 3ULL * unitUs);
+    }
+    return markEndUs;
+}
+
+void MorseScript::keyText(const char* message) {
+    for (const char* p = message; *p; ++p) {
+        char c = (char)toupper((unsigned char)*p);
+        uint8_t code = MorseCodebook::encode(c);
+        if (code == MorseCodebook::NONE) continue;
+
+        if (MorseCodebook::length(code) == 0) {
+            // Word gap: 7 units, 3 of which the previous char gap already gave
+            cursorUs += jittered(4ULL * unitUs);
+            text += ' ';
+            continue;
+        }
+        charEnds.push_back(keyElements(code));
+        text += c;
+    }
+}
+
+void MorseScript::keyProsign(const char* pattern) {
+    keyElements(MorseCodebook::pack(pattern));
+}
+
+void MorseScript::pause(uint32_t ms) {
+    cursorUs += ms * 1000ULL;
+}
+
+void MorseScript::holdEnter(uint32_t ms) {
+    Interval hold;
+    hold.startUs = cursorUs;
+    hold.endUs = cursorUs + ms * 1000ULL;
+    enterMarks.push_back(hold);
+    cursorUs = hold.endUs;
+}
+
+void MorseScript::keyPasscode(bool oneRun) {
+    if (oneRun) {
+        keyProsign("...---...");
+        return;
+    }
+    std::string typed = text;
+    keyText("SOS");
+    text = typed; // The passcode is not part of the message
+    charEnds.resize(charEnds.size() - 3);
+}
+
+bool MorseScript::isDown(const std::vector<Interval>& marks, size_t& cursor, uint64_t nowUs) {
+    while (cursor < marks.size() && marks[cursor].endUs <= nowUs) cursor++;
+    return cursor < marks.size() && marks[cursor].startUs <= nowUs;
+}
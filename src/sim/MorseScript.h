@@ -0,0 +1,59 @@
+#ifndef MORSE_SCRIPT_H
+#define MORSE_SCRIPT_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/**
+ * @brief A scripted operator: the exact key-down intervals for some text
+ * at a given speed, with optional timing jitter (deterministic per seed).
+ *
+ * The same script can drive a key pin (Keyer) or a tone into the ADC
+ * (ToneSource), and remembers when each character's last mark ended so
+ * decode latency can be measured against it.
+ *
+ * With paddles on, the script plays an iambic keyer's operator instead:
+ * keyMarks hold the dit paddle, enterMarks the dah paddle, each pressed
+ * across the moment the keyer (at the script's speed) starts the element.
+ */
+class MorseScript {
+public:
+    struct Interval {
+        uint64_t startUs;
+        uint64_t endUs;
+    };
+
+private:
+    uint64_t cursorUs;
+    uint32_t unitUs;
+    uint8_t jitterPercent;
+    uint32_t seed;
+    bool paddles = false;
+
+    uint64_t jittered(uint64_t us);
+    uint64_t keyElements(unsigned int code); // Returns the end of the last mark
+
+public:
+    std::vector<Interval> keyMarks;    // Morse key (or tone) down
+    std::vector<Interval> enterMarks;  // Enter/space button down
+    std::vector<uint64_t> charEnds;    // End of the last mark of each character
+    std::string text;                  // Characters keyed, in order
+
+    MorseScript(uint64_t startUs, unsigned int wpm, uint8_t jitterPercent = 0, uint32_t seed = 1);
+
+    void keyText(const char* text);   // Letters, digits and spaces (word gaps)
+    void pause(uint32_t ms);
+    void holdEnter(uint32_t ms);      // >= 1 s sends the message
+    void keyPasscode(bool oneRun = false); // SOS, the unlock sequence (or "...---..." unbroken)
+    void keyProsign(const char* pattern); // Elements run together, e.g. AR ".-.-."
+    void usePaddles() { paddles = true; }
+
+    uint64_t endUs() const { return cursorUs; }
+    uint32_t getUnitUs() const { return unitUs; }
+
+    // Monotonic lookups: query times must not go backwards per cursor
+    static bool isDown(const std::vector<Interval>& marks, size_t& cursor, uint64_t nowUs);
+};
+
+#endif // MORSE_SCRIPT_H
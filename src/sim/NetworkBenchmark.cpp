@@ -0,0 +1,335 @@
+// Star network, message size and hub head-of-line runs (RadioInterface,
+// OutboundQueue on the hub)
+#include "Benchmarks.h"
+#include "BenchmarkSupport.h"
+#include "OutboundQueue.h"
+#include "TextCodec.h"
+#include <map>
+#include <memory>
+
+using namespace Bench;
+
+namespace {
+
+// --- Star network: 1-6 spies sharing one hub, link layer only ---
+const uint8_t NETWORK_SIZES[] = {1, 2, 4, 6};
+const uint32_t NETWORK_RUN_MS = 30000;
+const size_t NETWORK_MESSAGE_LEN = 40;        // Two fragments
+
+void benchNetworkRun(JsonWriter& json, uint8_t spies) {
+    NativeHAL::ether().reset();
+    NativeHAL::ether().lossPercent = 0;
+
+    std::unique_ptr<NetworkUnit> hub(new NetworkUnit("hub", RADIO_HUB_NODE));
+    std::vector<std::unique_ptr<NetworkUnit> > units;
+    for (uint8_t id = 1; id <= spies; ++id) {
+        char name[8];
+        snprintf(name, sizeof(name), "spy%u", id);
+        units.push_back(std::unique_ptr<NetworkUnit>(new NetworkUnit(name, id)));
+    }
+
+    std::map<std::string, uint64_t> uplinkPending, downlinkPending;
+    std::vector<double> uplinkMs, downlinkMs;
+    unsigned long uplinkSent = 0, uplinkFailed = 0, uplinkBytes = 0, repliesBusy = 0;
+    unsigned long repliesQueued = 0;
+    std::string hubReply; // The hub sends straight from here until it is collected
+
+    Simulator sim;
+    NetworkUnit& h = *hub;
+    h.node.board.echo = verbose;
+    h.node.setup = [&h]() { h.link.begin(); h.radio.setChannel(NETWORK_CHANNEL); };
+    // Hub: take each message and answer its sender with a short reply
+    h.node.loop = [&]() {
+        if (!h.link.isMessageAvailable()) return;
+        uint8_t from = RADIO_HUB_NODE;
+        std::string text = h.link.getMessage(&from);
+        uint64_t now = NativeHAL::current().nowUs;
+        std::map<std::string, uint64_t>::iterator it = uplinkPending.find(text);
+        if (it != uplinkPending.end() && text[1] - '0' == from) {
+            uplinkMs.push_back((now - it->second) / 1000.0);
+            uplinkBytes += text.size();
+            uplinkPending.erase(it);
+        }
+        if (h.link.isSendPending()) { repliesBusy++; return; }
+        hubReply = "R" + text.substr(0, 7);
+        if (h.link.sendMessage(hubReply.c_str(), from)) {
+            repliesQueued++;
+            downlinkPending[hubReply] = now;
+        } else {
+            repliesBusy++;
+        }
+    };
+    sim.add(h.node);
+
+    for (size_t i = 0; i < units.size(); ++i) {
+        NetworkUnit& u = *units[i];
+        u.node.board.echo = verbose;
+        u.node.setup = [&u]() {
+            u.link.begin();
+            u.radio.setChannel(NETWORK_CHANNEL);
+            u.nextSendUs = u.nextGapUs();
+        };
+        u.node.loop = [&]() {
+            uint64_t now = NativeHAL::current().nowUs;
+            if (u.link.isMessageAvailable()) {
+                std::string reply = u.link.getMessage();
+                std::map<std::string, uint64_t>::iterator it = downlinkPending.find(reply);
+                if (it != downlinkPending.end()) {
+                    downlinkMs.push_back((now - it->second) / 1000.0);
+                    downlinkPending.erase(it);
+                }
+            }
+            if (now < u.nextSendUs || now >= NETWORK_RUN_MS * 1000ULL) return;
+
+            char head[16];
+            snprintf(head, sizeof(head), "N%u %04u ", u.link.getNodeId(), u.sequence++);
+            std::string text = head + sampleText(NETWORK_MESSAGE_LEN - strlen(head));
+            uplinkPending[text] = now;
+            uplinkSent++;
+            if (!u.link.sendMessage(text.c_str())) uplinkFailed++;
+            u.nextSendUs = NativeHAL::current().nowUs + u.nextGapUs();
+        };
+        sim.add(u.node);
+    }
+
+    sim.setupAll();
+    // Sending stops at NETWORK_RUN_MS; the extra time lets replies drain
+    sim.runUntil((NETWORK_RUN_MS + 2000) * 1000ULL);
+
+    const NativeHAL::Ether& ether = NativeHAL::ether();
+    double seconds = NETWORK_RUN_MS / 1000.0;
+    char name[16];
+    snprintf(name, sizeof(name), "nodes_%u", spies);
+    json.beginObject(name);
+    json.field("offered_msgs_per_s", spies * 1000.0 / NETWORK_SEND_PERIOD_MS);
+
+    Summary up = summarize(uplinkMs);
+    json.beginObject("uplink");
+    json.field("sent", (uint64_t)uplinkSent);
+    json.field("delivered", (uint64_t)uplinkMs.size());
+    json.field("failed", (uint64_t)uplinkFailed);
+    json.field("delivered_msgs_per_s", uplinkMs.size() / seconds);
+    json.field("goodput_bytes_per_s", uplinkBytes / seconds);
+    json.field("latency_ms_mean", up.mean);
+    json.field("latency_ms_p50", up.p50);
+    json.field("latency_ms_max", up.max);
+    json.endObject();
+
+    Summary down = summarize(downlinkMs);
+    json.beginObject("downlink");
+    json.field("queued", (uint64_t)repliesQueued);
+    json.field("hub_busy", (uint64_t)repliesBusy);
+    json.field("delivered", (uint64_t)downlinkMs.size());
+    json.field("latency_ms_mean", down.mean);
+    json.field("latency_ms_max", down.max);
+    json.endObject();
+
+    unsigned long polls = 0, failedPolls = 0;
+    for (size_t i = 0; i < units.size(); ++i) {
+        polls += units[i]->link.getPolls();
+        failedPolls += units[i]->link.getFailedPolls();
+    }
+    json.beginObject("radio");
+    json.field("attempts", (uint64_t)ether.attempts);
+    json.field("delivered_payloads", (uint64_t)ether.delivered);
+    json.field("collisions", (uint64_t)ether.collisions);
+    json.field("failed_payloads", (uint64_t)ether.failed);
+    json.field("polls", (uint64_t)polls);
+    json.field("failed_polls", (uint64_t)failedPolls);
+    json.field("attempts_per_payload",
+               ether.delivered ? (double)ether.attempts / ether.delivered : 0.0);
+    json.field("collision_rate", ether.attempts ? (double)ether.collisions / ether.attempts : 0.0);
+    json.field("channel_busy", ether.airtimeUs / (seconds * 1e6));
+    json.endObject();
+    json.endObject();
+}
+
+// --- Message size: one spy -> hub link, short messages up to the longest ---
+// RAW text, so a message of n characters is n + 1 bytes on the air: 28 and
+// 57 fill one and two fragments exactly, 29 spills one byte into a second,
+// and 64 (RADIO_MAX_MESSAGE_LEN) takes three
+const size_t MESSAGE_SIZES[] = {8, 28, 29, 57, RADIO_MAX_MESSAGE_LEN};
+const unsigned int MESSAGE_SIZE_REPEATS = 10;
+const uint32_t MESSAGE_SIZE_PERIOD_MS = 200;
+
+// Returns the mean goodput
+double benchMessageSizeRun(JsonWriter& json, size_t length) {
+    NativeHAL::ether().reset();
+    NativeHAL::ether().lossPercent = 0;
+    std::unique_ptr<NetworkUnit> hub(new NetworkUnit("hub", RADIO_HUB_NODE));
+    std::unique_ptr<NetworkUnit> spy(new NetworkUnit("spy1", 1));
+    hub->link.setTextEncodings(1 << TEXT_ENCODING_RAW);
+    spy->link.setTextEncodings(1 << TEXT_ENCODING_RAW);
+
+    const std::string text = sampleText(length);
+    unsigned int sent = 0, delivered = 0, mismatched = 0, failed = 0;
+    unsigned long fragments = 0;
+    std::vector<double> sendUs, linkBps;
+    std::vector<double> latencyMs;
+    uint64_t sentAtUs = 0;
+
+    Simulator sim;
+    NetworkUnit& h = *hub;
+    NetworkUnit& s = *spy;
+    h.node.board.echo = s.node.board.echo = verbose;
+    h.node.setup = [&h]() { h.link.begin(); h.radio.setChannel(NETWORK_CHANNEL); };
+    h.node.loop = [&]() {
+        if (!h.link.isMessageAvailable()) return;
+        if (text != h.link.getMessage()) { mismatched++; return; }
+        delivered++;
+        latencyMs.push_back((NativeHAL::current().nowUs - sentAtUs) / 1000.0);
+    };
+    s.node.setup = [&s]() { s.link.begin(); s.radio.setChannel(NETWORK_CHANNEL); };
+    // One message per period, after a second for the encodings exchange
+    s.node.loop = [&]() {
+        s.link.isMessageAvailable();
+        uint64_t now = NativeHAL::current().nowUs;
+        if (sent >= MESSAGE_SIZE_REPEATS || now < (1000 + sent * MESSAGE_SIZE_PERIOD_MS) * 1000ULL) return;
+
+        sent++;
+        sentAtUs = now;
+        unsigned long fragmentsBefore = s.link.getTxFragments();
+        if (!s.link.sendMessage(text.c_str())) { failed++; return; }
+        sendUs.push_back((double)(NativeHAL::current().nowUs - now));
+        linkBps.push_back((double)s.link.getLastThroughputBps());
+        fragments += s.link.getTxFragments() - fragmentsBefore;
+    };
+    sim.add(h.node);
+    sim.add(s.node);
+    sim.setupAll();
+    sim.runUntil((2000 + MESSAGE_SIZE_REPEATS * MESSAGE_SIZE_PERIOD_MS) * 1000ULL);
+
+    Summary send = summarize(sendUs);
+    Summary link = summarize(linkBps);
+    char name[16];
+    snprintf(name, sizeof(name), "len_%u", (unsigned)length);
+    json.beginObject(name);
+    json.field("sent", (uint64_t)sent);
+    json.field("delivered", (uint64_t)delivered);
+    json.field("failed", (uint64_t)(failed + mismatched));
+    json.field("fragments_per_message", sent ? (double)fragments / sent : 0.0);
+    json.field("send_us_mean", send.mean);
+    json.field("send_us_max", send.max);
+    json.field("latency_ms_mean", summarize(latencyMs).mean);
+    // getLastThroughputBps(): message bytes over the send, first FIFO write
+    // to last acknowledgement
+    json.field("goodput_bytes_per_s_mean", link.mean);
+    json.endObject();
+    check(delivered == MESSAGE_SIZE_REPEATS && !mismatched, "network.message_size", name, "delivered");
+    return link.mean;
+}
+
+// --- Outbox on the hub: one spy goes off the air ---
+// Replies to both spies are queued, the silent one's first. The other spy's
+// must not wait behind it: at first the silent spy may still count as heard
+// (its reply goes out and is dropped once it has been quiet for
+// RADIO_NODE_SILENT_MS), later its replies never reach the radio at all.
+const uint8_t HOL_CHANNEL = 82;
+const uint8_t HOL_OFF_CHANNEL = 83;
+const uint32_t HOL_SILENT_AT_MS = 5000;     // Spy 1 leaves the channel
+const uint32_t HOL_FRESH_MS = 6000;         // Replies queued 1 s into its silence
+const uint32_t HOL_STALE_MS = 12000;        // ...and 7 s into it
+const uint32_t HOL_RUN_MS = 20000;
+const double HOL_STALE_MAX_MS = 1000;       // Spy 2's reply, spy 1 long gone
+
+void benchHeadOfLine(JsonWriter& json) {
+    NativeHAL::ether().reset();
+    NativeHAL::ether().lossPercent = 0;
+
+    NetworkUnit hub("hub", RADIO_HUB_NODE);
+    NetworkUnit gone("spy1", 1);
+    NetworkUnit live("spy2", 2);
+    OutboundQueue outbox(hub.link);
+    std::map<std::string, uint64_t> queuedAt;
+    std::map<std::string, double> latencyMs;
+    bool freshQueued = false, staleQueued = false;
+
+    auto queue = [&](const char* text, uint8_t node) {
+        queuedAt[text] = NativeHAL::current().nowUs;
+        outbox.enqueue(text, node);
+    };
+
+    Simulator sim;
+    hub.node.board.echo = verbose;
+    hub.node.setup = [&]() {
+        hub.link.begin();
+        hub.radio.setChannel(HOL_CHANNEL);
+        outbox.begin();
+    };
+    hub.node.loop = [&]() {
+        uint64_t now = NativeHAL::current().nowUs;
+        if (!freshQueued && now >= HOL_FRESH_MS * 1000ULL) {
+            freshQueued = true;
+            queue("R1 FRESH", 1);
+            queue("R2 FRESH", 2);
+        }
+        if (!staleQueued && now >= HOL_STALE_MS * 1000ULL) {
+            staleQueued = true;
+            queue("R1 STALE", 1);
+            queue("R2 STALE", 2);
+        }
+        hub.link.isMessageAvailable();
+        outbox.update();
+    };
+    sim.add(hub.node);
+
+    NetworkUnit* spies[] = {&gone, &live};
+    for (NetworkUnit* unit : spies) {
+        NetworkUnit& u = *unit;
+        u.node.board.echo = verbose;
+        u.node.setup = [&u]() { u.link.begin(); u.radio.setChannel(HOL_CHANNEL); };
+        u.node.loop = [&]() {
+            uint64_t now = NativeHAL::current().nowUs;
+            if (&u == &gone && now >= HOL_SILENT_AT_MS * 1000ULL) u.radio.setChannel(HOL_OFF_CHANNEL);
+            if (!u.link.isMessageAvailable()) return;
+            std::string text = u.link.getMessage();
+            if (queuedAt.count(text) && !latencyMs.count(text)) latencyMs[text] = (now - queuedAt[text]) / 1000.0;
+        };
+        sim.add(u.node);
+    }
+
+    sim.setupAll();
+    sim.runUntil(HOL_RUN_MS * 1000ULL);
+
+    bool freshDelivered = latencyMs.count("R2 FRESH") > 0;
+    bool staleDelivered = latencyMs.count("R2 STALE") > 0;
+    double freshMs = freshDelivered ? latencyMs["R2 FRESH"] : 0;
+    double staleMs = staleDelivered ? latencyMs["R2 STALE"] : 0;
+    json.beginObject("head_of_line");
+    json.field("live_fresh_delivered", freshDelivered);
+    json.field("live_fresh_latency_ms", freshMs);
+    json.field("live_stale_delivered", staleDelivered);
+    json.field("live_stale_latency_ms", staleMs);
+    json.field("silent_delivered", (uint64_t)(latencyMs.count("R1 FRESH") + latencyMs.count("R1 STALE")));
+    json.field("hub_tx_failures", (uint64_t)hub.link.getTxFailures());
+    json.endObject();
+    // At worst the silent spy's reply is dropped once it has been quiet long
+    // enough (RADIO_NODE_SILENT_MS); once that's known, nothing waits for it
+    check(freshDelivered && freshMs <= RADIO_NODE_SILENT_MS, "network", "head_of_line", "live_fresh_latency_ms");
+    check(staleDelivered && staleMs <= HOL_STALE_MAX_MS, "network", "head_of_line", "live_stale_latency_ms");
+}
+
+} // namespace
+
+void runNetworkBenchmark(JsonWriter& json) {
+    json.beginObject("network");
+    for (size_t i = 0; i < sizeof(NETWORK_SIZES); ++i) benchNetworkRun(json, NETWORK_SIZES[i]);
+
+    json.beginObject("message_size");
+    const size_t sizes = sizeof(MESSAGE_SIZES) / sizeof(MESSAGE_SIZES[0]);
+    double goodput[sizes];
+    for (size_t i = 0; i < sizes; ++i) goodput[i] = benchMessageSizeRun(json, MESSAGE_SIZES[i]);
+    json.endObject();
+    // A message that fills whole fragments moves its bytes at least as fast
+    // as one that fills a single payload: splitting costs nothing per byte
+    double singleFragment = 0;
+    for (size_t i = 0; i < sizes; ++i) {
+        if ((MESSAGE_SIZES[i] + TEXT_FRAME_HEADER) % RADIO_FRAGMENT_DATA != 0) continue;
+        if (!singleFragment) { singleFragment = goodput[i]; continue; }
+        char name[16];
+        snprintf(name, sizeof(name), "len_%u", (unsigned)MESSAGE_SIZES[i]);
+        check(goodput[i] >= singleFragment, "network.message_size", name, "goodput_bytes_per_s_mean");
+    }
+    benchHeadOfLine(json);
+    json.endObject();
+}
@@ -0,0 +1,169 @@
+// OutboundQueue store-and-forward on a spy
+#include "Benchmarks.h"
+#include "BenchmarkSupport.h"
+#include "OutboundQueue.h"
+#include <map>
+#include <memory>
+
+using namespace Bench;
+
+namespace {
+
+// --- Outbox: store-and-forward through a hub outage and two resets ---
+// The spy queues messages while the hub is off the air, resets, and carries
+// on once the hub is back. One more reset lands right after a delivery,
+// before the delivered mark reached EEPROM: the hub must drop the resend.
+// The urgent message is queued in the same loop() as the one before it, so
+// it is staged while that one is still being written.
+const uint8_t OUTBOX_CHANNEL = 80;
+const uint8_t OUTBOX_OFF_CHANNEL = 81;      // Where the hub sits during the outage
+const uint32_t OUTBOX_RESET_MS = 10000;
+const uint32_t OUTBOX_HUB_BACK_MS = 20000;
+const uint32_t OUTBOX_RESEND_MS = 45000;
+const uint32_t OUTBOX_RUN_MS = 70000;
+// enqueue() only stages the record: the caller never waits out an EEPROM
+// write cycle (3.3 ms)
+const double OUTBOX_ENQUEUE_MAX_MS = 3.0;
+
+struct OutboxMessage {
+    uint32_t atMs;
+    const char* text;
+    MessagePriority priority;
+};
+const OutboxMessage OUTBOX_MESSAGES[] = {
+    {1000, "N1 SECTOR 1 SECURE", PRIORITY_NORMAL},
+    {2000, "N2 NO CONTACT", PRIORITY_NORMAL},
+    {3000, "N3 MOVING TO POINT B", PRIORITY_NORMAL},
+    {3000, "U4 HELP I AM COMPROMISED", PRIORITY_URGENT},
+    {12000, "N5 WAITING", PRIORITY_NORMAL},
+    {OUTBOX_RESEND_MS, "N6 RESENT AFTER RESET", PRIORITY_NORMAL},
+};
+const size_t OUTBOX_MESSAGE_COUNT = sizeof(OUTBOX_MESSAGES) / sizeof(OUTBOX_MESSAGES[0]);
+
+void benchOutbox(JsonWriter& json) {
+    NativeHAL::ether().reset();
+    NativeHAL::ether().lossPercent = 0;
+
+    NetworkUnit hub("hub", RADIO_HUB_NODE);
+    NetworkUnit spy("spy1", 1);
+    std::unique_ptr<OutboundQueue> outbox(new OutboundQueue(spy.link));
+    // Stats survive the resets here (a real unit would lose them)
+    unsigned long attempts = 0, retries = 0, gaveUp = 0;
+    std::vector<double> enqueueMs;
+    unsigned int refused = 0;
+
+    std::map<std::string, uint64_t> queuedAt;
+    std::map<std::string, unsigned int> received;
+    std::vector<std::string> order;
+    std::vector<double> latencyMs;
+    size_t nextMessage = 0;
+    bool resetDone = false, resendArmed = false, snapshotTaken = false, resendDone = false;
+    uint8_t snapshot[NativeHAL::EEPROM_SIZE];
+
+    // Powers the spy's queue down and up again (the EEPROM stays)
+    auto resetSpy = [&]() {
+        attempts += outbox->getAttempts();
+        retries += outbox->getRetries();
+        gaveUp += outbox->getGaveUp();
+        outbox.reset(new OutboundQueue(spy.link));
+        outbox->begin();
+    };
+
+    Simulator sim;
+    hub.node.board.echo = verbose;
+    hub.node.setup = [&]() { hub.link.begin(); hub.radio.setChannel(OUTBOX_OFF_CHANNEL); };
+    hub.node.loop = [&]() {
+        uint64_t now = NativeHAL::current().nowUs;
+        if (now >= OUTBOX_HUB_BACK_MS * 1000ULL) hub.radio.setChannel(OUTBOX_CHANNEL);
+        if (!hub.link.isMessageAvailable()) return;
+        std::string text = hub.link.getMessage();
+        if (received[text]++ == 0) {
+            order.push_back(text);
+            latencyMs.push_back((now - queuedAt[text]) / 1000.0);
+        }
+    };
+    sim.add(hub.node);
+
+    spy.node.board.echo = verbose;
+    spy.node.setup = [&]() {
+        spy.link.begin();
+        spy.radio.setChannel(OUTBOX_CHANNEL);
+        outbox->begin();
+    };
+    spy.node.loop = [&]() {
+        uint64_t now = NativeHAL::current().nowUs;
+        if (!resetDone && now >= OUTBOX_RESET_MS * 1000ULL) {
+            resetDone = true;
+            resetSpy();
+        }
+        while (nextMessage < OUTBOX_MESSAGE_COUNT && now >= OUTBOX_MESSAGES[nextMessage].atMs * 1000ULL) {
+            const OutboxMessage& message = OUTBOX_MESSAGES[nextMessage++];
+            uint64_t startUs = NativeHAL::current().nowUs;
+            queuedAt[message.text] = startUs;
+            if (!outbox->enqueue(message.text, RADIO_HUB_NODE, message.priority)) refused++;
+            enqueueMs.push_back((NativeHAL::current().nowUs - startUs) / 1000.0);
+            if (message.atMs == OUTBOX_RESEND_MS) resendArmed = true;
+        }
+        // The EEPROM once the record is stored, before this update() can
+        // mark it delivered
+        if (resendArmed && !resendDone && !outbox->isStoring()) {
+            memcpy(snapshot, NativeHAL::current().eeprom, sizeof(snapshot));
+            snapshotTaken = true;
+        }
+        OutboxEvent event = outbox->update();
+        if (event == OUTBOX_DELIVERED && snapshotTaken && !resendDone) {
+            // Power lost before the delivered mark: the record is still queued
+            resendDone = true;
+            memcpy(NativeHAL::current().eeprom, snapshot, sizeof(snapshot));
+            resetSpy();
+        }
+    };
+    sim.add(spy.node);
+
+    sim.setupAll();
+    sim.runUntil(OUTBOX_RUN_MS * 1000ULL);
+    attempts += outbox->getAttempts();
+    retries += outbox->getRetries();
+    gaveUp += outbox->getGaveUp();
+
+    unsigned int appDuplicates = 0;
+    for (std::map<std::string, unsigned int>::iterator it = received.begin(); it != received.end(); ++it) {
+        appDuplicates += it->second - 1;
+    }
+    uint32_t maxCellWrites = 0, totalWrites = 0;
+    for (uint16_t i = 0; i < NativeHAL::EEPROM_SIZE; ++i) {
+        maxCellWrites = std::max(maxCellWrites, spy.node.board.eepromWrites[i]);
+        totalWrites += spy.node.board.eepromWrites[i];
+    }
+
+    json.beginObject("outbox");
+    json.field("queued", (uint64_t)OUTBOX_MESSAGE_COUNT);
+    json.field("delivered", (uint64_t)order.size());
+    json.field("urgent_first_after_outage", !order.empty() && order[0][0] == 'U');
+    json.field("duplicates_to_app", (uint64_t)appDuplicates);
+    json.field("duplicates_filtered", (uint64_t)hub.link.getDuplicateMessages());
+    json.field("attempts", (uint64_t)attempts);
+    json.field("retries", (uint64_t)retries);
+    json.field("gave_up", (uint64_t)gaveUp);
+    Summary latency = summarize(latencyMs);
+    json.field("latency_ms_mean", latency.mean);
+    json.field("latency_ms_max", latency.max);
+    Summary enqueue = summarize(enqueueMs);
+    json.field("enqueue_ms_mean", enqueue.mean);
+    json.field("enqueue_ms_max", enqueue.max);
+    json.field("refused", (uint64_t)refused);
+    json.field("eeprom_writes", (uint64_t)totalWrites);
+    json.field("eeprom_max_cell_writes", (uint64_t)maxCellWrites);
+    json.endObject();
+    check(order.size() == OUTBOX_MESSAGE_COUNT, "outbox", "run", "delivered");
+    check(appDuplicates == 0, "outbox", "run", "duplicates_to_app");
+    check(hub.link.getDuplicateMessages() > 0, "outbox", "run", "resent_after_reset");
+    check(enqueue.max <= OUTBOX_ENQUEUE_MAX_MS, "outbox", "run", "enqueue_ms_max");
+    check(refused == 0, "outbox", "run", "refused");
+}
+
+} // namespace
+
+void runOutboxBenchmark(JsonWriter& json) {
+    benchOutbox(json);
+}
@@ -0,0 +1,55 @@
+// Compiles the unmodified admin and spy sketches into this program, each in
+// its own namespace so their globals (display, radio, ...) don't collide.
+// Every header they use is included here first, at global scope, so the
+// #includes inside the namespaces are no-ops.
+// Library-level statics are shared, though: /STATS on either node lists the
+// latency histograms of both sketches.
+#include <Arduino.h>
+#include <Wire.h>
+#include <SPI.h>
+#include <RF24.h>
+#include <RTClib.h>
+#include <SoftwareSerial.h>
+#include "Config.h"
+#include "MorseDisplay.h"
+#include "MorseTransmitter.h"
+#include "BluetoothInterface.h"
+#include "SerialBackend.h"
+#include "RadioInterface.h"
+#include "OutboundQueue.h"
+#include "MessageLogger.h"
+#include "FixedString.h"
+#include "DebugLog.h"
+#include "LatencyProfiler.h"
+#include "SimNodes.h"
+
+namespace admin {
+#include "../admin/admin_main.cpp"
+}
+
+namespace spy {
+#include "../spy/spy_main.c++"
+}
+
+namespace SimNodes {
+
+void bindAdmin(SimNode& node) {
+    node.setup = admin::setup;
+    node.loop = admin::loop;
+}
+MorseDisplay& adminDisplay() { return admin::display; }
+RadioInterface& adminRadio() { return admin::nrf; }
+OutboundQueue& adminOutbox() { return admin::outbox; }
+MessageLogger& adminLogger() { return admin::logger; }
+SoftwareSerial& adminBluetooth() { return admin::btSerial; }
+
+void bindSpy(SimNode& node) {
+    node.setup = spy::setup;
+    node.loop = spy::loop;
+}
+MorseDisplay& spyDisplay() { return spy::display; }
+RadioInterface& spyRadio() { return spy::nrf; }
+OutboundQueue& spyOutbox() { return spy::outbox; }
+MorseTransmitterCore& spyTransmitter() { return spy::transmitter; }
+
+} // namespace SimNodes
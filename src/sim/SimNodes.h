@@ -0,0 +1,31 @@
+#ifndef SIM_NODES_H
+#define SIM_NODES_H
+
+#include "Simulator.h"
+
+class MorseDisplay;
+class RadioInterface;
+class OutboundQueue;
+class MorseTransmitterCore;
+class MessageLogger;
+class SoftwareSerial;
+
+// The real admin and spy sketches, built into this program (see SimNodes.cpp)
+namespace SimNodes {
+
+void bindAdmin(SimNode& node);
+MorseDisplay& adminDisplay();
+RadioInterface& adminRadio();
+OutboundQueue& adminOutbox();
+MessageLogger& adminLogger();
+SoftwareSerial& adminBluetooth();
+
+void bindSpy(SimNode& node);
+MorseDisplay& spyDisplay();
+RadioInterface& spyRadio();
+OutboundQueue& spyOutbox();
+MorseTransmitterCore& spyTransmitter();
+
+} // namespace SimNodes
+
+#endif // SIM_NODES_H
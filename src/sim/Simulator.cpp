@@ -0,0 +1,118 @@
+#include "Simulator.h"
+#include <algorithm>
+#include <chrono>
+
+// --- LoopStats ---
+void LoopStats::record(uint32_t us, uint64_t ns) {
+    virtualUs.push_back(us);
+    hostNsTotal += ns;
+    hostNsMax = std::max(hostNsMax, ns);
+}
+
+uint32_t LoopStats::percentile(uint8_t pct) const {
+    if (virtualUs.empty()) return 0;
+    std::vector<uint32_t> sorted(virtualUs);
+    size_t index = (sorted.size() - 1) * pct / 100;
+    std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+    return sorted[index];
+}
+
+double LoopStats::meanVirtualUs() const {
+    if (virtualUs.empty()) return 0;
+    uint64_t total = 0;
+    for (size_t i = 0; i < virtualUs.size(); ++i) total += virtualUs[i];
+    return (double)total / virtualUs.size();
+}
+
+double LoopStats::meanHostNs() const {
+    return virtualUs.empty() ? 0 : (double)hostNsTotal / virtualUs.size();
+}
+
+// --- Simulator ---
+Simulator::Simulator() {
+    NativeHAL::setSyncHook([this](uint64_t untilUs) { catchUp(untilUs); });
+}
+
+Simulator::~Simulator() {
+    NativeHAL::setSyncHook(nullptr);
+}
+
+// Runs every idle board up to untilUs while another one is blocked
+void Simulator::catchUp(uint64_t untilUs) {
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        SimNode& node = *nodes[i];
+        while (!node.running && node.board.nowUs < untilUs) step(node);
+    }
+}
+
+void Simulator::setupAll() {
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        NativeHAL::select(nodes[i]->board);
+        if (nodes[i]->setup) nodes[i]->setup();
+    }
+}
+
+void Simulator::step(SimNode& node) {
+    NativeHAL::select(node.board);
+    if (node.beforeLoop) node.beforeLoop(node.board);
+
+    uint64_t startUs = node.board.nowUs;
+    std::chrono::steady_clock::time_point hostStart = std::chrono::steady_clock::now();
+    node.running = true;
+    node.loop();
+    node.running = false;
+    uint64_t hostNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - hostStart).count();
+    NativeHAL::select(node.board); // A sync may have switched boards
+    NativeHAL::advanceMicros(SIM_BASE_LOOP_US);
+
+    node.stats.record((uint32_t)(node.board.nowUs - startUs), hostNs);
+}
+
+void Simulator::runUntil(uint64_t untilUs, const std::function<bool()>& done) {
+    while (!nodes.empty()) {
+        SimNode* next = nodes[0];
+        for (size_t i = 1; i < nodes.size(); ++i) {
+            if (nodes[i]->board.nowUs < next->board.nowUs) next = nodes[i];
+        }
+        if (next->board.nowUs >= untilUs) return;
+        if (done && done()) return;
+        step(*next);
+    }
+}
+
+// --- Keyer ---
+Keyer::Keyer(const MorseScript& script, uint8_t key, uint8_t enter, uint32_t bounceUs) {
+    lines[0].pin = key;
+    lines[1].pin = enter;
+    addEdges(lines[0], script.keyMarks, bounceUs);
+    addEdges(lines[1], script.enterMarks, bounceUs);
+}
+
+void Keyer::addEdges(Line& line, const std::vector<MorseScript::Interval>& marks, uint32_t bounceUs) {
+    for (const MorseScript::Interval& mark : marks) {
+        for (int i = 0; i < 2; ++i) {
+            uint64_t us = i == 0 ? mark.startUs : mark.endUs;
+            uint8_t level = i == 0 ? LOW : HIGH;
+            if (bounceUs > 0) {
+                line.edges.push_back({us, level});
+                line.edges.push_back({us + bounceUs / 2, (uint8_t)(level == LOW ? HIGH : LOW)});
+                us += bounceUs;
+            }
+            line.edges.push_back({us, level});
+        }
+    }
+}
+
+void Keyer::attach(NativeHAL::Board& board) {
+    board.onClock = [this](NativeHAL::Board& clocked) { apply(clocked); };
+}
+
+void Keyer::apply(NativeHAL::Board& board) {
+    for (Line& line : lines) {
+        while (line.cursor < line.edges.size() && line.edges[line.cursor].us <= board.nowUs) {
+            const Edge& edge = line.edges[line.cursor++];
+            NativeHAL::setInputAt(board, line.pin, edge.level, edge.us);
+        }
+    }
+}
@@ -0,0 +1,85 @@
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+#include "NativeHAL.h"
+#include "MorseScript.h"
+#include <functional>
+#include <vector>
+
+// Virtual CPU time charged per loop() on top of the modelled I/O
+const uint32_t SIM_BASE_LOOP_US = 100;
+
+// Per-node loop() timing: virtual (modelled AVR time) and host wall time
+struct LoopStats {
+    std::vector<uint32_t> virtualUs;
+    uint64_t hostNsTotal = 0;
+    uint64_t hostNsMax = 0;
+
+    void record(uint32_t us, uint64_t ns);
+    uint32_t percentile(uint8_t pct) const;
+    double meanVirtualUs() const;
+    double meanHostNs() const;
+    void reset() { virtualUs.clear(); hostNsTotal = hostNsMax = 0; }
+};
+
+struct SimNode {
+    NativeHAL::Board board;
+    std::function<void()> setup;
+    std::function<void()> loop;
+    std::function<void(NativeHAL::Board&)> beforeLoop; // Stimuli (keys, serial...)
+    LoopStats stats;
+    bool running = false; // Inside loop(); not re-entered by syncs
+
+    explicit SimNode(const char* name) : board(name) {}
+};
+
+/**
+ * @brief Runs several boards against each other. Always steps the board
+ * whose clock is furthest behind, so clocks stay within one loop() of each
+ * other and a run is identical every time.
+ */
+class Simulator {
+private:
+    std::vector<SimNode*> nodes;
+
+    void step(SimNode& node);
+    void catchUp(uint64_t untilUs);
+
+public:
+    Simulator();
+    ~Simulator();
+
+    void add(SimNode& node) { nodes.push_back(&node); }
+    void setupAll();
+    // Runs until every clock reaches untilUs or done() returns true
+    void runUntil(uint64_t untilUs, const std::function<bool()>& done = nullptr);
+};
+
+// Drives a board's key (and enter) buttons from a script; active low.
+// attach() applies the script whenever the board's clock moves, and every
+// edge lands at its scripted time, the way a pin interrupt would see it.
+// With bounceUs set, each edge chatters (new, old, new level) over that
+// long before it settles.
+class Keyer {
+private:
+    struct Edge {
+        uint64_t us;
+        uint8_t level;
+    };
+    struct Line {
+        uint8_t pin;
+        std::vector<Edge> edges;
+        size_t cursor = 0;
+    };
+    Line lines[2];
+
+    static void addEdges(Line& line, const std::vector<MorseScript::Interval>& marks, uint32_t bounceUs);
+
+public:
+    Keyer(const MorseScript& script, uint8_t key, uint8_t enter, uint32_t bounceUs = 0);
+
+    void attach(NativeHAL::Board& board);
+    void apply(NativeHAL::Board& board);
+};
+
+#endif // SIMULATOR_H
@@ -0,0 +1,39 @@
+// Host simulator and benchmark suite (pio run -e native, then run the
+// program). Prints one JSON document on stdout; compare two runs with
+// scripts/bench_compare.py. Exits 1 if any run missed its pass/fail
+// threshold (each miss is named on stderr).
+//
+//   program [--only decode|keying|e2e|network|outbox|compression|macros|codebook|display] [--verbose]
+#include <Arduino.h>
+#include "Benchmarks.h"
+
+int main(int argc, char** argv) {
+    const char* only = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--verbose") == 0) setBenchmarkVerbose(true);
+        else if (strcmp(argv[i], "--only") == 0 && i + 1 < argc) only = argv[++i];
+        else {
+            fprintf(stderr, "usage: %s [--only decode|keying|e2e|network|outbox|compression|macros|codebook|display] [--verbose]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    JsonWriter json;
+    json.beginObject();
+    json.field("schema", (uint64_t)1);
+    if (!only || strcmp(only, "decode") == 0) runDecodeBenchmark(json);
+    if (!only || strcmp(only, "keying") == 0) runKeyingBenchmark(json);
+    if (!only || strcmp(only, "e2e") == 0) runEndToEndBenchmark(json);
+    if (!only || strcmp(only, "network") == 0) runNetworkBenchmark(json);
+    if (!only || strcmp(only, "outbox") == 0) runOutboxBenchmark(json);
+    if (!only || strcmp(only, "compression") == 0) runCompressionBenchmark(json);
+    if (!only || strcmp(only, "macros") == 0) runMacroBenchmark(json);
+    if (!only || strcmp(only, "codebook") == 0) runCodebookBenchmark(json);
+    if (!only || strcmp(only, "display") == 0) runDisplayBenchmark(json);
+    json.endObject();
+
+    fputs(json.str().c_str(), stdout);
+    unsigned int failures = getBenchmarkFailures();
+    if (failures) fprintf(stderr, "%u check(s) failed\n", failures);
+    return failures ? 1 : 0;
+}
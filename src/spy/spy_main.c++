@@ -4,6 +4,10 @@
 #include "MorseDisplay.h"
 #include "MorseTransmitter.h"
 #include "RadioInterface.h"
+#include "OutboundQueue.h"
+#include "FixedString.h"
+#include "DebugLog.h"
+#include "LatencyProfiler.h"
 #include <RF24.h>
 
 // --- Global Instances (Spy) ---
@@ -12,11 +16,85 @@ MorseDisplay display(LCD_ADDRESS, LCD_COLS, LCD_ROWS);
 // The transmitter class is used for BOTH:
 // 1. Sending Morse (LED only, no buzzer)
 // 2. Decoding manual button input
-// Add ENTER_BTN_PIN in the second position
-MorseTransmitter transmitter(BUTTON_PIN, ENTER_BTN_PIN, LED_PIN, SPY_BUZZER_PIN);
+// Pins are template arguments, so the missing buzzer (-1) compiles out
+MorseTransmitterT<BUTTON_PIN, ENTER_BTN_PIN, LED_PIN, SPY_BUZZER_PIN> transmitter;
+static_assert(TX_QUEUE_SIZE >= RADIO_MAX_MESSAGE_LEN, "a received message must fit the playback queue");
 // Change this line in your Spy Global Instances:
 RF24 radio(NRF_CE_PIN, NRF_CSN_PIN);
-RadioInterface nrf(radio, radioPipeAddress);
+RadioInterface nrf(radio, radioPipeAddress, SPY_NODE_ID);
+// Messages wait here (in EEPROM) until the admin has them
+OutboundQueue outbox(nrf);
+
+// A send result stays on the LCD this long, then the idle status returns
+const unsigned long STATUS_HOLD_MS = 1000;
+// Status line when nothing else is going on (the transmitter restores it too)
+const char IDLE_STATUS[] PROGMEM = "Spy Unit Ready";
+const __FlashStringHelper* idleStatus() { return reinterpret_cast<const __FlashStringHelper*>(IDLE_STATUS); }
+unsigned long statusHoldUntil = 0; // 0: nothing to restore
+
+// Console commands typed on the USB serial port (see handleCommand())
+FixedString<16> serialInputBuffer;
+
+// --- Latency profiling (dumped by /STATS) ---
+PROFILE_DEFINE(loopTime, "loop");
+PROFILE_DEFINE(radioPollTime, "nrf.poll");
+PROFILE_DEFINE(radioReadTime, "nrf.read");
+PROFILE_DEFINE(radioSendTime, "nrf.send");
+PROFILE_DEFINE(keyerTime, "tx.update");
+PROFILE_DEFINE(playbackQueueTime, "tx.text");
+PROFILE_DEFINE(lcdFlushTime, "lcd.flush");
+
+void printStats(Print& out) {
+#if PROFILING
+    out.println(F("[STATS] name n min max p50 p99 (us) h=<32us,<64us,...,>=32ms"));
+    LatencyHistogram::printAll(out);
+#endif
+    out.print(F("[STATS] nrf tx=")); out.print(nrf.getTxMessages());
+    out.print(F(" fail=")); out.print(nrf.getTxFailures());
+    out.print(F(" frag=")); out.print(nrf.getTxFragments());
+    out.print(F(" retries>=")); out.print(nrf.getTxRetries());
+    out.print(F(" stalls=")); out.print(nrf.getTxRetryStalls());
+    out.print(F(" polls=")); out.print(nrf.getPolls());
+    out.print(F(" poll_fail=")); out.print(nrf.getFailedPolls());
+    out.print(F(" evicted=")); out.print(nrf.getEvictedMessages());
+    out.print(F(" malformed=")); out.print(nrf.getMalformedFragments());
+    out.print(F(" dup=")); out.println(nrf.getDuplicateMessages());
+    out.print(F("[STATS] nrf text=")); out.print(nrf.getTxTextBytes());
+    out.print(F(" wire=")); out.print(nrf.getTxFrameBytes());
+    out.print(F(" enc=0x")); out.println(nrf.getTextEncodings(), HEX);
+    out.print(F("[STATS] outbox depth=")); out.print(outbox.getDepth());
+    out.print(F(" queued=")); out.print(outbox.getEnqueued());
+    out.print(F(" delivered=")); out.print(outbox.getDelivered());
+    out.print(F(" attempts=")); out.print(outbox.getAttempts());
+    out.print(F(" retries=")); out.print(outbox.getRetries());
+    out.print(F(" gave_up=")); out.print(outbox.getGaveUp());
+    out.print(F(" dropped=")); out.print(outbox.getDropped());
+    out.print(F(" lat_mean_ms=")); out.print(outbox.getMeanLatencyMs());
+    out.print(F(" lat_max_ms=")); out.println(outbox.getMaxLatencyMs());
+    out.print(F("[STATS] lcd flushes=")); out.print(display.getFlushCount());
+    out.print(F(" i2c_bytes=")); out.println(display.getI2CBytesTotal());
+    out.print(F("[STATS] key glitches=")); out.print(transmitter.getKeyGlitches());
+    out.print(F(" overruns=")); out.println(transmitter.getKeyOverruns());
+}
+
+//   /STATS        latency histograms and link counters
+//   /STATS RESET  zero everything /STATS prints (except the outbox depth)
+void handleCommand(const char* line) {
+    if (strncmp_P(line, PSTR("/STATS"), 6) != 0) {
+        DEBUG_WARN(F("Unknown command: ")); DEBUG_WARNLN(line);
+        return;
+    }
+    if (strcmp_P(line + 6, PSTR(" RESET")) == 0) {
+        LatencyHistogram::resetAll();
+        nrf.resetStats();
+        outbox.resetStats();
+        display.resetStats();
+        transmitter.resetKeyStats();
+        Serial.println(F("[STATS] reset"));
+    } else {
+        printStats(Serial);
+    }
+}
 
 void setup() {
     Serial.begin(9600); // For debugging
@@ -24,53 +102,120 @@ void setup() {
 
     display.begin();
     transmitter.begin(&display);
+    transmitter.setKeyerMode(KEYER_MODE, KEYER_WPM);
+    transmitter.setIdleStatus(idleStatus()); // Also after playback
     
     if (!nrf.begin()) {
-        Serial.println("FATAL: Radio failed!");
+        DEBUG_ERRORLN(F("FATAL: Radio failed!"));
         display.setStatus(F("NRF FAIL"));
+        display.flush(true);
         while (1); // Halt
     }
+    outbox.begin(); // Anything still undelivered from before a reset
 
-    display.setStatus(F("Spy Unit Ready"));
-    Serial.println("--- SPY SYSTEM ONLINE ---");
+    display.setStatus(idleStatus());
+    DEBUG_INFO(F("--- SPY SYSTEM ONLINE (node ")); DEBUG_INFO(SPY_NODE_ID); DEBUG_INFOLN(F(") ---"));
 }
 
 void loop() {
+    PROFILE_SCOPE(loopTime);
+
+    // Advance any Morse playback in progress (never blocks)
+    transmitter.tick();
+    // Push any LCD changes out (rate-limited, only changed cells)
+    {
+        PROFILE_SCOPE(lcdFlushTime);
+        display.flush();
+    }
+
     // --- Mode 1: Check for incoming Admin replies via NRF ---
-    if (nrf.isMessageAvailable()) {
-        String msg = nrf.getMessage();
-        Serial.println("ADMIN MSG RX: " + msg);
+    bool adminMessageWaiting;
+    {
+        PROFILE_SCOPE(radioPollTime);
+        adminMessageWaiting = nrf.isMessageAvailable();
+    }
+    if (adminMessageWaiting) {
+        const char* msg;
+        {
+            PROFILE_SCOPE(radioReadTime);
+            msg = nrf.getMessage();
+        }
+        DEBUG_INFO(F("ADMIN MSG RX: ")); DEBUG_INFOLN(msg);
         
         display.setStatus(F("Admin Msg RX..."));
         
-        // Play the message in Morse (LED only, as buzzer pin is -1)
-        transmitter.processText(msg);
+        // Queue the message for Morse playback (LED only, as buzzer pin is -1)
+        bool queued;
+        {
+            PROFILE_SCOPE(playbackQueueTime);
+            queued = transmitter.processText(msg);
+        }
+        // (the LCD shows "Playback CUT" once the rest has played)
+        if (!queued) DEBUG_WARNLN(F("Admin msg cut short: playback queue full"));
         
         // (Optional) Send an Acknowledgment
         // nrf.sendMessage("ACK"); 
-        
-        display.setStatus(F("Spy Unit Ready"));
     }
 
     // --- Mode 2: Check for manual button input ---
     // transmitter.update() handles button presses and returns a
     // complete message string when the user pauses.
-    String messageToSend = transmitter.update();
+    const char* messageToSend;
+    {
+        PROFILE_SCOPE(keyerTime);
+        messageToSend = transmitter.update();
+    }
     
-    if (messageToSend.length() > 0) {
-        // We have a message to send!
-        Serial.println("Sending to Admin: " + messageToSend);
-        
-        if (nrf.sendMessage(messageToSend)) {
-            display.setStatus(F("Msg Sent OK"));
-            // The transmitter.update() function already handles
-            // clearing the display after a successful send.
+    if (messageToSend) {
+        // We have a message to send! It goes out from the queue below; the
+        // duress alert jumps ahead of anything still waiting.
+        DEBUG_INFO(F("Sending to Admin: ")); DEBUG_INFOLN(messageToSend);
+        bool duress = transmitter.wasDuress();
+        bool queued = outbox.enqueue(messageToSend, RADIO_HUB_NODE,
+                                     duress ? PRIORITY_URGENT : PRIORITY_NORMAL);
+        if (duress) {
+            // The LCD already claims "Msg Sent OK": leave it at that
+            statusHoldUntil = millis() + STATUS_HOLD_MS;
+        } else if (queued) {
+            display.setStatus(F("Msg Queued"));
+            statusHoldUntil = 0;
         } else {
+            display.setStatus(F("Queue FULL"));
+            statusHoldUntil = millis() + STATUS_HOLD_MS;
+        }
+    }
+
+    // --- Mode 2b: Send whatever is due (one attempt, retries back off) ---
+    OutboxEvent sendEvent;
+    {
+        PROFILE_SCOPE(radioSendTime);
+        sendEvent = outbox.update();
+    }
+    if (outbox.getLastPriority() == PRIORITY_NORMAL) {
+        if (sendEvent == OUTBOX_DELIVERED) {
+            display.setStatus(F("Msg Sent OK"));
+            statusHoldUntil = millis() + STATUS_HOLD_MS;
+        } else if (sendEvent == OUTBOX_GAVE_UP) {
             display.setStatus(F("Msg Send FAIL"));
+            statusHoldUntil = millis() + STATUS_HOLD_MS;
+        }
+    }
+    // Show a result for a moment, without holding up the loop
+    if (statusHoldUntil && (long)(millis() - statusHoldUntil) >= 0) {
+        statusHoldUntil = 0;
+        display.setStatus(idleStatus());
+    }
+
+    // --- Mode 3: Diagnostics commands on the USB serial port ---
+    while (Serial.available() > 0) {
+        char c = Serial.read();
+        if (c == '\n' || c == '\r') {
+            if (serialInputBuffer.length() > 0) {
+                handleCommand(serialInputBuffer.c_str());
+                serialInputBuffer.clear();
+            }
+        } else {
+            serialInputBuffer.append(c); // Extra characters are dropped
         }
-        
-        // Short delay to show status
-        delay(1000);
-        display.setStatus(F("Spy Unit Ready"));
     }
 }
\ No newline at end of file